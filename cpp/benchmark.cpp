@@ -0,0 +1,1139 @@
+/**
+ * Benchmarks SchrottID encoding and decoding
+ *
+ * Compares round schedules and algorithms by speed and diffusion. Diffusion is measured as the share of ID
+ * characters that change when a single bit of the value flips, ideally (N - 1) / N for
+ * an alphabet of N characters, on average and for the worst pair of bit and character.
+ *
+ * On Linux every operation also runs under perf_event_open hardware counters: cycles, instructions,
+ * branch misses and L1D read misses, reported per ID. Counters that cannot be opened, for example in
+ * containers or under a restrictive perf_event_paranoid, are reported as null.
+ *
+ * Results can be saved as a baseline and later runs compared against it. Every operation runs several times,
+ * taking turns with the other operations and repeated for at least 2 ms per run. Fastest runs are compared with
+ * the baseline, and an operation counts as regressed only if it got slower than the threshold plus a margin: the
+ * 95% confidence interval of the difference of the mean times, or at least 5%, so noisy machines do not fail runs.
+ * Baselines are only meaningful on the machine that saved them. With --json the comparison is printed to stderr.
+ *
+ * Usage: schrott_id_benchmark [options]
+ *   --lengths <n,...>      ID lengths, 8 by default
+ *   --alphabets <name,...> base64, base58, base36 or base32, base64 by default
+ *   --ids <n>              IDs per operation, 2^18 by default
+ *   --runs <n>             Runs per operation, 5 by default
+ *   --json                 Print JSON with all counters instead of a table
+ *   --save <file>          Write the JSON to a file, to compare later runs with
+ *   --compare <file>       Compare with a saved run, exits with 1 if an operation regressed
+ *   --threshold <percent>  Slowdown that counts as a regression, 5 by default
+ *
+ * https://github.com/lorisleitner/schrott-id
+ */
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string_view>
+#include <utility>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "benchmark_compare.hpp"
+#include "schrott_id.hpp"
+#include "schrott_id_ff1.hpp"
+
+using namespace schrott_id;
+
+namespace
+{
+    const char* const kPermutation =
+            "HwEMFAcAMAYEPxc4Dy4RAxAkEgstJggbGSMiKB0yHgk7OSsNMxoYKRMWNg49LzEFFTQKPDUhHAIsICclOio+Nw==";
+
+    volatile std::uint64_t sink;
+
+    struct options
+    {
+        std::vector<std::size_t> lengths = {8};
+        std::vector<std::string> alphabets = {"base64"};
+        std::size_t ids = 1 << 18;
+        std::size_t runs = 5;
+        bool json = false;
+        std::string save;
+        std::string compare;
+        double threshold = 0.05;
+    };
+
+    // Version of the JSON layout, baselines of another version cannot be compared
+    const int kReportFormat = 1;
+
+    enum counter
+    {
+        cycles = 0,
+        instructions,
+        branch_misses,
+        l1d_misses,
+        kCounters
+    };
+
+    const char* const kCounterNames[kCounters] = {"cycles", "instructions", "branch_misses", "l1d_misses"};
+
+    /**
+     * Hardware counters of the calling thread. Each counter is opened on its own,
+     * so the ones the kernel refuses do not take the others down.
+     */
+    class perf_counters
+    {
+    private:
+        int fds_[kCounters];
+        std::string error_;
+
+    public:
+        perf_counters()
+        {
+            std::fill(std::begin(fds_), std::end(fds_), -1);
+
+#ifdef __linux__
+            const std::uint32_t types[kCounters] = {
+                    PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE};
+            const std::uint64_t configs[kCounters] = {
+                    PERF_COUNT_HW_CPU_CYCLES,
+                    PERF_COUNT_HW_INSTRUCTIONS,
+                    PERF_COUNT_HW_BRANCH_MISSES,
+                    PERF_COUNT_HW_CACHE_L1D
+                    | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+                    | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)};
+
+            for (auto c = 0; c < kCounters; ++c)
+            {
+                perf_event_attr attr = {};
+                attr.size = sizeof(attr);
+                attr.type = types[c];
+                attr.config = configs[c];
+                attr.disabled = 1;
+                attr.exclude_kernel = 1;
+                attr.exclude_hv = 1;
+                attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+                fds_[c] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+
+                if (fds_[c] < 0 && error_.empty())
+                {
+                    error_ = std::string(kCounterNames[c]) + ": " + std::strerror(errno);
+                }
+            }
+#else
+            error_ = "perf_event_open is only available on Linux";
+#endif
+        }
+
+        perf_counters(const perf_counters&) = delete;
+        perf_counters& operator=(const perf_counters&) = delete;
+
+        ~perf_counters()
+        {
+#ifdef __linux__
+            for (auto fd: fds_)
+            {
+                if (fd >= 0)
+                {
+                    close(fd);
+                }
+            }
+#endif
+        }
+
+        bool available(counter c) const
+        {
+            return fds_[c] >= 0;
+        }
+
+        /**
+         * Returns why the first counter could not be opened, empty if all are available.
+         */
+        const std::string& error() const
+        {
+            return error_;
+        }
+
+        void start()
+        {
+#ifdef __linux__
+            for (auto fd: fds_)
+            {
+                if (fd >= 0)
+                {
+                    ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+                    ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+                }
+            }
+#endif
+        }
+
+        /**
+         * Stops counting and returns the counts since @see start, scaled up if the kernel multiplexed counters.
+         */
+        std::array<std::optional<double>, kCounters> stop()
+        {
+            std::array<std::optional<double>, kCounters> counts;
+
+#ifdef __linux__
+            for (auto c = 0; c < kCounters; ++c)
+            {
+                if (fds_[c] >= 0)
+                {
+                    ioctl(fds_[c], PERF_EVENT_IOC_DISABLE, 0);
+                }
+            }
+
+            for (auto c = 0; c < kCounters; ++c)
+            {
+                // Value, time enabled, time running
+                std::uint64_t data[3];
+
+                if (fds_[c] < 0
+                    || read(fds_[c], data, sizeof(data)) != sizeof(data)
+                    || data[2] == 0)
+                {
+                    continue;
+                }
+
+                counts[c] = static_cast<double>(data[0]) * static_cast<double>(data[1]) / static_cast<double>(data[2]);
+            }
+#endif
+
+            return counts;
+        }
+    };
+
+    // Time and counters per ID of one operation
+    struct measurement
+    {
+        // Fastest run, the one least disturbed by other processes, and its counters
+        double ns;
+        std::array<std::optional<double>, kCounters> counters;
+
+        // Time per ID of every run
+        std::vector<double> samples;
+    };
+
+    // Every run repeats an operation for at least this long, so short operations are not lost in timer noise
+    const std::chrono::microseconds kMinRunTime(2000);
+
+    measurement empty_measurement()
+    {
+        return measurement{1e300, {}, {}};
+    }
+
+    // Times one run of an operation and keeps the counters of the fastest run
+    void measure_run(perf_counters& counters, std::size_t ids, const std::function<void()>& f, measurement& m)
+    {
+        std::size_t repeats = 0;
+        std::chrono::duration<double, std::nano> elapsed(0);
+
+        counters.start();
+        auto start = std::chrono::steady_clock::now();
+
+        do
+        {
+            f();
+            ++repeats;
+            elapsed = std::chrono::steady_clock::now() - start;
+        } while (elapsed < kMinRunTime);
+
+        auto counts = counters.stop();
+        auto per_id = static_cast<double>(ids * repeats);
+
+        m.samples.push_back(elapsed.count() / per_id);
+
+        if (elapsed.count() / per_id < m.ns)
+        {
+            m.ns = elapsed.count() / per_id;
+
+            for (auto c = 0; c < kCounters; ++c)
+            {
+                m.counters[c] = counts[c] ? std::optional<double>(*counts[c] / per_id) : std::nullopt;
+            }
+        }
+    }
+
+    // Values below base^(length - 1) that are all padded to exactly length digits
+    template<class Encoder>
+    std::vector<std::uint64_t> sample_values(const Encoder& encoder, std::size_t length, std::size_t ids)
+    {
+        std::uint64_t limit = 1;
+        for (std::size_t i = 0; i + 1 < length && limit <= UINT64_MAX / encoder.alphabet().size(); ++i)
+        {
+            limit *= encoder.alphabet().size();
+        }
+
+        std::mt19937_64 random(42);
+        std::uniform_int_distribution<std::uint64_t> distribution(0, limit - 1);
+
+        std::vector<std::uint64_t> values(ids);
+        for (auto& value: values)
+        {
+            value = distribution(random);
+        }
+
+        return values;
+    }
+
+    struct diffusion
+    {
+        // Share of ID characters that change when one bit of the value flips
+        double mean;
+
+        // Lowest change rate of any pair of value bit and character position
+        double worst;
+    };
+
+    template<class Encoder>
+    diffusion avalanche(const Encoder& encoder, const std::vector<std::uint64_t>& values, std::uint64_t limit)
+    {
+        std::size_t bits = 0;
+        while (bits < 63 && (std::uint64_t{2} << bits) <= limit)
+        {
+            ++bits;
+        }
+
+        const auto length = encoder.encoded_length(limit);
+        const auto samples = std::min<std::size_t>(values.size(), 4096);
+        std::vector<std::size_t> changed(bits * length);
+
+        for (std::size_t i = 0; i < samples; ++i)
+        {
+            auto id = encoder.encode(values[i]);
+
+            for (std::size_t bit = 0; bit < bits; ++bit)
+            {
+                auto flipped = encoder.encode(values[i] ^ (std::uint64_t{1} << bit));
+
+                for (std::size_t c = 0; c < length; ++c)
+                {
+                    changed[bit * length + c] += id[c] != flipped[c];
+                }
+            }
+        }
+
+        std::size_t total = 0;
+        std::size_t worst = samples;
+        for (auto n: changed)
+        {
+            total += n;
+            worst = std::min(worst, n);
+        }
+
+        return diffusion{static_cast<double>(total) / (samples * changed.size()),
+                         static_cast<double>(worst) / samples};
+    }
+
+    std::string rounds(const schrott_id_encoder& encoder, std::size_t length)
+    {
+        return encoder.algorithm() == algorithm::cascade
+               ? std::to_string(encoder.schedule().rounds(length))
+               : "-";
+    }
+
+    std::string rounds(const ff1_encoder& encoder, std::size_t)
+    {
+        return encoder.hardware_aes() ? "ni" : "soft";
+    }
+
+    // Unique name of the kernel an encoder runs
+    std::string kernel(const schrott_id_encoder& encoder)
+    {
+        return encoder.version();
+    }
+
+    std::string kernel(const ff1_encoder& encoder)
+    {
+        return encoder.version() + (encoder.hardware_aes() ? "-ni" : "-soft");
+    }
+
+    const char* alphabet_chars(const std::string& name)
+    {
+        if (name == "base58")
+        {
+            return alphabets::base58;
+        }
+
+        if (name == "base36")
+        {
+            return alphabets::base36;
+        }
+
+        if (name == "base32")
+        {
+            return alphabets::base32;
+        }
+
+        return alphabets::base64;
+    }
+
+    // The permutation of control.txt for Base64, a fixed shuffle for other alphabets so runs are comparable
+    std::string permutation_for(const std::string& alphabet)
+    {
+        if (alphabet == alphabets::base64)
+        {
+            return kPermutation;
+        }
+
+        std::vector<byte> permutation(alphabet.size());
+        for (std::size_t i = 0; i < permutation.size(); ++i)
+        {
+            permutation[i] = static_cast<byte>(i);
+        }
+
+        std::shuffle(permutation.begin(), permutation.end(), std::mt19937_64(42));
+
+        return base64::encode(permutation);
+    }
+
+    std::string json_string(const std::string& s)
+    {
+        std::string quoted = "\"";
+
+        for (auto c: s)
+        {
+            if (c == '"' || c == '\\')
+            {
+                quoted += '\\';
+            }
+
+            quoted += static_cast<unsigned char>(c) < 0x20 ? ' ' : c;
+        }
+
+        return quoted + "\"";
+    }
+
+    void write_json(std::ostream& out, const measurement& m)
+    {
+        auto s = benchmark::summarize(m.samples);
+
+        out << "{\"ns\": " << m.ns << ", \"mean\": " << s.mean << ", \"ci95\": " << benchmark::ci95(s) << ", \"samples\": [";
+
+        for (std::size_t i = 0; i < m.samples.size(); ++i)
+        {
+            out << (i ? ", " : "") << m.samples[i];
+        }
+
+        out << "]";
+
+        for (auto c = 0; c < kCounters; ++c)
+        {
+            out << ", \"" << kCounterNames[c] << "\": ";
+
+            if (m.counters[c])
+            {
+                out << *m.counters[c];
+            }
+            else
+            {
+                out << "null";
+            }
+        }
+
+        out << ", \"ipc\": ";
+
+        if (m.counters[cycles] && m.counters[instructions] && *m.counters[cycles] > 0)
+        {
+            out << *m.counters[instructions] / *m.counters[cycles];
+        }
+        else
+        {
+            out << "null";
+        }
+
+        out << "}";
+    }
+
+    struct scenario
+    {
+        std::string alphabet;
+        std::size_t length;
+        std::size_t ids;
+    };
+
+    const std::size_t kOperations = 5;
+    const char* const kOperationNames[kOperations] = {"encode", "encode_batch", "decode", "decode_batch",
+                                                      "decode_scattered"};
+
+    // Results of one encoder in one scenario, rows are matched with a baseline by kernel, alphabet, length and rounds
+    struct row
+    {
+        std::string kernel;
+        std::string version;
+        std::string alphabet;
+        std::size_t length;
+        std::size_t ids;
+        std::string rounds;
+        measurement operations[kOperations];
+        diffusion diffused;
+    };
+
+    std::size_t decode_scattered(const schrott_id_encoder& encoder, const std::vector<std::string_view>& ids,
+                                 std::uint64_t* values, error* errors)
+    {
+        return encoder.decode_batch(ids.data(), ids.size(), values, errors);
+    }
+
+    // Encoders without a gather decode decode one ID at a time
+    template<class Encoder>
+    std::size_t decode_scattered(const Encoder& encoder, const std::vector<std::string_view>& ids,
+                                 std::uint64_t* values, error* errors)
+    {
+        std::size_t failed = 0;
+
+        for (std::size_t i = 0; i < ids.size(); ++i)
+        {
+            errors[i] = encoder.try_decode(ids[i].data(), ids[i].size(), values[i]);
+            failed += errors[i] != error::none;
+        }
+
+        return failed;
+    }
+
+    /**
+     * Times one run of every operation of an encoder and adds it to its row, which the first run fills in.
+     * Buffers are allocated for every run, so the runs also sample where they are placed in memory.
+     */
+    template<class Encoder>
+    void benchmark_encoder(const Encoder& encoder, const scenario& s, perf_counters& counters, row& r)
+    {
+        auto values = sample_values(encoder, s.length, s.ids);
+        auto limit = *std::max_element(values.begin(), values.end());
+
+        std::vector<char> chars(values.size() * encoder.max_encoded_length());
+        std::vector<std::size_t> offsets(values.size() + 1);
+        std::vector<std::uint64_t> decoded(values.size());
+        std::vector<error> errors(values.size());
+
+        if (r.kernel.empty())
+        {
+            r = {kernel(encoder), encoder.version(), s.alphabet, s.length, s.ids, rounds(encoder, s.length), {}, {}};
+
+            for (auto& m: r.operations)
+            {
+                m = empty_measurement();
+            }
+
+            r.diffused = avalanche(encoder, values, limit);
+        }
+
+        std::vector<char> id(encoder.max_encoded_length());
+        encoder.encode_batch(values.data(), values.size(), chars.data(), chars.size(), offsets.data());
+
+        // The same IDs, one per cache line in random order, like strings parsed from requests
+        std::vector<char> scattered(values.size() * 64);
+        std::vector<std::size_t> lines(values.size());
+        std::vector<std::string_view> ids(values.size());
+        std::iota(lines.begin(), lines.end(), std::size_t{0});
+        std::shuffle(lines.begin(), lines.end(), std::mt19937_64(1));
+
+        for (std::size_t i = 0; i < values.size(); ++i)
+        {
+            auto line = scattered.data() + lines[i] * 64;
+            std::memcpy(line, chars.data() + offsets[i], offsets[i + 1] - offsets[i]);
+            ids[i] = std::string_view(line, offsets[i + 1] - offsets[i]);
+        }
+
+        const std::function<void()> operations[kOperations] = {
+                [&]
+                {
+                    std::uint64_t total = 0;
+                    for (auto value: values)
+                    {
+                        total += encoder.encode_to(value, id.data(), id.size());
+                    }
+                    sink = total;
+                },
+                [&]
+                {
+                    encoder.encode_batch(values.data(), values.size(), chars.data(), chars.size(), offsets.data());
+                    sink = offsets.back();
+                },
+                [&]
+                {
+                    std::uint64_t total = 0;
+                    for (std::size_t i = 0; i < values.size(); ++i)
+                    {
+                        std::uint64_t value = 0;
+                        encoder.try_decode(chars.data() + offsets[i], offsets[i + 1] - offsets[i], value);
+                        total += value;
+                    }
+                    sink = total;
+                },
+                [&]
+                {
+                    sink = encoder.decode_batch(chars.data(), offsets.data(), values.size(), decoded.data(),
+                                                errors.data());
+                },
+                [&]
+                {
+                    sink = decode_scattered(encoder, ids, decoded.data(), errors.data());
+                }};
+
+        for (std::size_t op = 0; op < kOperations; ++op)
+        {
+            measure_run(counters, values.size(), operations[op], r.operations[op]);
+        }
+    }
+
+    void print_row(const row& r)
+    {
+        std::cout << std::left << std::setw(11) << r.version
+                  << std::right << std::setw(7) << r.rounds
+                  << std::fixed << std::setprecision(1);
+
+        for (auto& m: r.operations)
+        {
+            std::cout << std::setw(10) << m.ns;
+        }
+
+        std::cout << std::setprecision(3)
+                  << std::setw(11) << r.diffused.mean
+                  << std::setw(8) << r.diffused.worst << '\n';
+    }
+
+    void write_report(std::ostream& out, const std::vector<row>& rows, const perf_counters& counters,
+                      const options& opts)
+    {
+        out << "{\n  \"format\": " << kReportFormat << ", \"runs\": " << opts.runs << ",\n  \"counters\": {";
+
+        for (auto c = 0; c < kCounters; ++c)
+        {
+            out << "\"" << kCounterNames[c] << "\": " << (counters.available(counter(c)) ? "true" : "false") << ", ";
+        }
+
+        out << "\"error\": " << json_string(counters.error()) << "},\n  \"results\": [";
+
+        for (std::size_t i = 0; i < rows.size(); ++i)
+        {
+            auto& r = rows[i];
+
+            out << (i ? ",\n" : "\n")
+                << "    {\"kernel\": " << json_string(r.kernel) << ", \"alphabet\": " << json_string(r.alphabet)
+                << ", \"length\": " << r.length << ", \"ids\": " << r.ids
+                << ", \"rounds\": " << json_string(r.rounds) << ",\n";
+
+            for (std::size_t op = 0; op < kOperations; ++op)
+            {
+                out << "     \"" << kOperationNames[op] << "\": ";
+                write_json(out, r.operations[op]);
+                out << ",\n";
+            }
+
+            out << "     \"avalanche\": " << r.diffused.mean << ", \"avalanche_worst\": " << r.diffused.worst << "}";
+        }
+
+        out << "\n  ]\n}\n";
+    }
+
+    /**
+     * JSON document read from a saved run, enough of JSON for the reports this tool writes.
+     */
+    struct json
+    {
+        enum kind
+        {
+            null,
+            boolean,
+            number,
+            string,
+            array,
+            object
+        };
+
+        kind type = null;
+        double value = 0;
+        std::string text;
+        std::vector<json> items;
+        std::vector<std::pair<std::string, json>> members;
+
+        const json* find(const std::string& key) const
+        {
+            for (auto& member: members)
+            {
+                if (member.first == key)
+                {
+                    return &member.second;
+                }
+            }
+
+            return nullptr;
+        }
+    };
+
+    class json_parser
+    {
+    private:
+        const char* pos_;
+        const char* end_;
+
+        void skip_space()
+        {
+            while (pos_ < end_ && std::strchr(" \t\r\n", *pos_))
+            {
+                ++pos_;
+            }
+        }
+
+        bool consume(char c)
+        {
+            skip_space();
+
+            if (pos_ < end_ && *pos_ == c)
+            {
+                ++pos_;
+                return true;
+            }
+
+            return false;
+        }
+
+        bool parse_string(std::string& out)
+        {
+            if (!consume('"'))
+            {
+                return false;
+            }
+
+            while (pos_ < end_ && *pos_ != '"')
+            {
+                if (*pos_ == '\\' && ++pos_ == end_)
+                {
+                    return false;
+                }
+
+                out += *pos_++;
+            }
+
+            return consume('"');
+        }
+
+    public:
+        explicit json_parser(const std::string& text)
+                : pos_(text.data()),
+                  end_(text.data() + text.size())
+        {
+        }
+
+        bool parse(json& out)
+        {
+            skip_space();
+
+            if (pos_ == end_)
+            {
+                return false;
+            }
+
+            if (*pos_ == '{')
+            {
+                out.type = json::object;
+                ++pos_;
+
+                if (consume('}'))
+                {
+                    return true;
+                }
+
+                do
+                {
+                    std::pair<std::string, json> member;
+
+                    if (!parse_string(member.first) || !consume(':') || !parse(member.second))
+                    {
+                        return false;
+                    }
+
+                    out.members.push_back(std::move(member));
+                } while (consume(','));
+
+                return consume('}');
+            }
+
+            if (*pos_ == '[')
+            {
+                out.type = json::array;
+                ++pos_;
+
+                if (consume(']'))
+                {
+                    return true;
+                }
+
+                do
+                {
+                    out.items.emplace_back();
+
+                    if (!parse(out.items.back()))
+                    {
+                        return false;
+                    }
+                } while (consume(','));
+
+                return consume(']');
+            }
+
+            if (*pos_ == '"')
+            {
+                out.type = json::string;
+                return parse_string(out.text);
+            }
+
+            for (auto literal: {"null", "true", "false"})
+            {
+                auto length = std::strlen(literal);
+
+                if (static_cast<std::size_t>(end_ - pos_) >= length && std::strncmp(pos_, literal, length) == 0)
+                {
+                    out.type = literal[0] == 'n' ? json::null : json::boolean;
+                    out.value = literal[0] == 't';
+                    pos_ += length;
+                    return true;
+                }
+            }
+
+            char* number_end;
+            out.type = json::number;
+            out.value = std::strtod(pos_, &number_end);
+
+            if (number_end == pos_)
+            {
+                return false;
+            }
+
+            pos_ = number_end;
+            return true;
+        }
+    };
+
+    std::vector<double> samples_of(const json& operation)
+    {
+        std::vector<double> samples;
+
+        if (auto list = operation.find("samples"))
+        {
+            for (auto& item: list->items)
+            {
+                samples.push_back(item.value);
+            }
+        }
+
+        return samples;
+    }
+
+    /**
+     * Compares the rows of this run with a saved run and prints every operation that changed.
+     * @see benchmark::compare
+     * @return Number of regressed operations, or -1 if the baseline cannot be read
+     */
+    int compare(const std::vector<row>& rows, const options& opts, std::ostream& out)
+    {
+        std::ifstream file(opts.compare);
+        std::stringstream text;
+        text << file.rdbuf();
+
+        json baseline;
+        auto format = json_parser(text.str()).parse(baseline) ? baseline.find("format") : nullptr;
+
+        if (!file || !format || format->value != kReportFormat || !baseline.find("results"))
+        {
+            std::cerr << "Cannot read " << opts.compare << " as a benchmark baseline of format " << kReportFormat
+                      << '\n';
+            return -1;
+        }
+
+        // Rows and operations of the timings
+        std::vector<std::pair<const row*, std::size_t>> compared;
+        std::vector<benchmark::timing> timings;
+        auto missing = 0;
+
+        for (auto& r: rows)
+        {
+            const json* match = nullptr;
+
+            for (auto& result: baseline.find("results")->items)
+            {
+                auto kernel = result.find("kernel");
+                auto alphabet = result.find("alphabet");
+                auto length = result.find("length");
+                auto rounds = result.find("rounds");
+
+                if (kernel && kernel->text == r.kernel && alphabet && alphabet->text == r.alphabet
+                    && length && length->value == r.length && rounds && rounds->text == r.rounds)
+                {
+                    match = &result;
+                }
+            }
+
+            if (!match)
+            {
+                ++missing;
+                continue;
+            }
+
+            for (std::size_t op = 0; op < kOperations; ++op)
+            {
+                auto base_operation = match->find(kOperationNames[op]);
+
+                if (!base_operation)
+                {
+                    continue;
+                }
+
+                benchmark::timing t = {samples_of(*base_operation), r.operations[op].samples};
+
+                if (t.before.empty() || t.after.empty()
+                    || *std::min_element(t.before.begin(), t.before.end()) <= 0
+                    || *std::min_element(t.after.begin(), t.after.end()) <= 0)
+                {
+                    continue;
+                }
+
+                compared.emplace_back(&r, op);
+                timings.push_back(std::move(t));
+            }
+        }
+
+        auto result = benchmark::compare(timings, opts.threshold);
+
+        out << "\nCompared with " << opts.compare << ", fastest ns per ID, 95% confidence, threshold "
+            << opts.threshold * 100 << "%\n\n"
+            << "kernel           alphabet length operation      baseline   current   change         \n";
+
+        for (std::size_t i = 0; i < compared.size(); ++i)
+        {
+            auto& r = *compared[i].first;
+            auto& c = result.changes[i];
+
+            const char* verdict = c.verdict == benchmark::verdict::regressed ? "REGRESSED"
+                                  : c.verdict == benchmark::verdict::improved ? "improved" : "";
+
+            std::ostringstream delta;
+            delta << std::showpos << std::fixed << std::setprecision(1) << c.change * 100 << "% "
+                  << std::noshowpos << "+-" << c.margin * 100 << "%";
+
+            out << std::left << std::setw(17) << r.kernel
+                << std::setw(9) << r.alphabet
+                << std::right << std::setw(6) << r.length << ' '
+                << std::left << std::setw(14) << kOperationNames[compared[i].second]
+                << std::right << std::fixed << std::setprecision(1)
+                << std::setw(9) << c.before
+                << std::setw(10) << c.after << "   "
+                << std::left << std::setw(16) << delta.str() << verdict << '\n';
+        }
+
+        out << '\n' << result.regressions << " operations regressed";
+
+        if (missing > 0)
+        {
+            out << ", " << missing << " results not in the baseline";
+        }
+
+        out << '\n';
+
+        return result.regressions;
+    }
+
+    template<class T, class Parse>
+    std::vector<T> parse_list(const char* list, Parse parse)
+    {
+        std::vector<T> items;
+        std::stringstream stream(list);
+        std::string item;
+
+        while (std::getline(stream, item, ','))
+        {
+            items.push_back(parse(item));
+        }
+
+        return items;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    options opts;
+
+    for (auto i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--json") == 0)
+        {
+            opts.json = true;
+        }
+        else if (i + 1 == argc)
+        {
+            break;
+        }
+        else if (std::strcmp(argv[i], "--lengths") == 0 || std::strcmp(argv[i], "--length") == 0)
+        {
+            opts.lengths = parse_list<std::size_t>(argv[++i], [](const std::string& s)
+            {
+                return static_cast<std::size_t>(std::stoul(s));
+            });
+        }
+        else if (std::strcmp(argv[i], "--alphabets") == 0)
+        {
+            opts.alphabets = parse_list<std::string>(argv[++i], [](const std::string& s)
+            {
+                return s;
+            });
+        }
+        else if (std::strcmp(argv[i], "--ids") == 0)
+        {
+            opts.ids = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(argv[i], "--runs") == 0)
+        {
+            opts.runs = std::max<std::size_t>(1, std::strtoul(argv[++i], nullptr, 10));
+        }
+        else if (std::strcmp(argv[i], "--save") == 0)
+        {
+            opts.save = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--compare") == 0)
+        {
+            opts.compare = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--threshold") == 0)
+        {
+            opts.threshold = std::atof(argv[++i]) / 100;
+        }
+    }
+
+    perf_counters counters;
+    std::vector<row> rows;
+
+    const round_schedule schedules[] = {
+            round_schedule::v3(),
+            round_schedule::per_length(2),
+            round_schedule::per_length(1),
+            round_schedule::constant(8),
+            round_schedule::constant(4),
+            round_schedule::constant(2),
+            round_schedule::constant(1),
+    };
+
+    // Every run goes through all encoders, so a slow phase of the machine hits one run of many operations
+    // instead of all runs of a few
+    for (std::size_t run = 0; run < opts.runs; ++run)
+    {
+        std::size_t next = 0;
+
+        auto slot = [&]() -> row&
+        {
+            if (run == 0)
+            {
+                rows.emplace_back();
+            }
+
+            return rows[next++];
+        };
+
+        for (auto& name: opts.alphabets)
+        {
+            std::string alphabet = alphabet_chars(name);
+            auto permutation = permutation_for(alphabet);
+
+            for (auto length: opts.lengths)
+            {
+                const scenario s{name, length, opts.ids};
+                const auto min_length = static_cast<int>(length);
+
+                for (auto& schedule: schedules)
+                {
+                    benchmark_encoder(schrott_id_encoder(alphabet, permutation, min_length, schedule), s, counters,
+                                      slot());
+                }
+
+                benchmark_encoder(schrott_id_encoder(alphabet, permutation, min_length, algorithm::feistel), s,
+                                  counters, slot());
+
+                // FF1 is far slower, fewer IDs give the same precision
+                auto ff1_scenario = s;
+                ff1_scenario.ids = std::max<std::size_t>(opts.ids / 512, 64);
+                const std::vector<byte> key(16, 0x2B);
+
+                benchmark_encoder(ff1_encoder(alphabet, key, min_length), ff1_scenario, counters, slot());
+                benchmark_encoder(ff1_encoder(alphabet, key, min_length, std::vector<byte>(), false), ff1_scenario,
+                                  counters, slot());
+            }
+        }
+    }
+
+    if (opts.json)
+    {
+        write_report(std::cout, rows, counters, opts);
+    }
+    else
+    {
+        for (std::size_t i = 0; i < rows.size(); ++i)
+        {
+            auto& r = rows[i];
+
+            if (i == 0 || r.alphabet != rows[i - 1].alphabet || r.length != rows[i - 1].length)
+            {
+                auto size = std::strlen(alphabet_chars(r.alphabet));
+
+                std::cout << (i == 0 ? "" : "\n")
+                          << r.alphabet << ", IDs of length " << r.length << ", ns per ID, ideal avalanche "
+                          << std::fixed << std::setprecision(3) << (static_cast<double>(size) - 1) / static_cast<double>(size)
+                          << "\n\n"
+                          << "version     rounds    encode     batch    decode     batch scattered  avalanche  worst\n";
+            }
+
+            print_row(r);
+        }
+
+        if (!counters.error().empty())
+        {
+            std::cout << "\nHardware counters unavailable (" << counters.error() << ")\n";
+        }
+    }
+
+    if (!opts.save.empty())
+    {
+        std::ofstream file(opts.save);
+        write_report(file, rows, counters, opts);
+
+        if (!file)
+        {
+            std::cerr << "Cannot write " << opts.save << '\n';
+            return 2;
+        }
+    }
+
+    if (!opts.compare.empty())
+    {
+        // With --json the comparison goes to stderr, so stdout stays a single JSON document
+        auto regressions = compare(rows, opts, opts.json ? std::cerr : std::cout);
+
+        if (regressions < 0)
+        {
+            return 2;
+        }
+
+        if (regressions > 0)
+        {
+            return 1;
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,159 @@
+/**
+ * Comparison of benchmark timings with a saved baseline
+ *
+ * Used by schrott_id_benchmark --compare and kept apart from the timing code so it can be tested
+ * with synthetic timings.
+ *
+ * https://github.com/lorisleitner/schrott-id
+ */
+
+#ifndef SCHROTT_ID_BENCHMARK_COMPARE_HPP
+#define SCHROTT_ID_BENCHMARK_COMPARE_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace schrott_id
+{
+    namespace benchmark
+    {
+        // Slowdowns up to this much are taken as noise between invocations, which the runs of one invocation
+        // do not show, like frequency scaling or a different placement in memory
+        const double kNoiseFloor = 0.05;
+
+        // Mean and sample variance of the runs of an operation
+        struct summary
+        {
+            double mean;
+            double variance;
+            std::size_t n;
+        };
+
+        inline summary summarize(const std::vector<double>& samples)
+        {
+            summary s = {0, 0, samples.size()};
+
+            for (auto x: samples)
+            {
+                s.mean += x / samples.size();
+            }
+
+            for (auto x: samples)
+            {
+                s.variance += samples.size() > 1 ? (x - s.mean) * (x - s.mean) / (samples.size() - 1) : 0;
+            }
+
+            return s;
+        }
+
+        // Two-sided 95% quantile of Student's t distribution
+        inline double t_quantile(double df)
+        {
+            static const double table[] = {
+                    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                    2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                    2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+
+            auto index = static_cast<std::size_t>(std::max(1.0, std::floor(df)));
+            return index <= sizeof(table) / sizeof(table[0]) ? table[index - 1] : 1.960;
+        }
+
+        // Half width of the 95% confidence interval of a mean
+        inline double ci95(const summary& s)
+        {
+            return s.n > 1 ? t_quantile(s.n - 1.0) * std::sqrt(s.variance / s.n) : 0;
+        }
+
+        // Nanoseconds per ID of every run of an operation, in the baseline and in this run
+        struct timing
+        {
+            std::vector<double> before;
+            std::vector<double> after;
+        };
+
+        enum class verdict
+        {
+            unchanged,
+            improved,
+            regressed
+        };
+
+        struct operation_change
+        {
+            // Fastest runs, the ones least disturbed by other processes
+            double before;
+            double after;
+
+            // Change of the fastest run against the baseline
+            double change;
+
+            // Change that is taken as noise, on top of the threshold
+            double margin;
+
+            benchmark::verdict verdict;
+        };
+
+        struct comparison
+        {
+            // One per timing, in the same order
+            std::vector<operation_change> changes;
+
+            int regressions;
+        };
+
+        /**
+         * Compares the timings of operations with their baseline.
+         *
+         * Every operation is compared with its own baseline. It counts as regressed if it got slower than the
+         * threshold plus a margin, the larger of the 95% confidence interval of the difference of the mean times
+         * and @see kNoiseFloor. A slowdown of all operations alike counts for every one of them, as it is as likely
+         * a regression in shared code as a slower machine; compare on the machine that saved the baseline.
+         * @param timings Timings with at least one run before and after, all of them positive
+         * @param threshold Slowdown that counts as a regression, 0.05 for 5%
+         */
+        inline comparison compare(const std::vector<timing>& timings, double threshold)
+        {
+            comparison result = {{}, 0};
+
+            for (auto& t: timings)
+            {
+                auto before = summarize(t.before);
+                auto after = summarize(t.after);
+
+                // Welch's t-test: confidence interval of the difference of means with unequal variances
+                auto a = after.n > 1 ? after.variance / after.n : 0;
+                auto b = before.n > 1 ? before.variance / before.n : 0;
+                auto se = std::sqrt(a + b);
+                auto df = after.n > 1 && before.n > 1 && a + b > 0
+                          ? (a + b) * (a + b) / (a * a / (after.n - 1) + b * b / (before.n - 1))
+                          : 1e9;
+
+                // The fastest runs are the ones least disturbed by other processes
+                operation_change c = {*std::min_element(t.before.begin(), t.before.end()),
+                                      *std::min_element(t.after.begin(), t.after.end()),
+                                      0, std::max(kNoiseFloor, t_quantile(df) * se / before.mean),
+                                      verdict::unchanged};
+
+                c.change = c.after / c.before - 1;
+
+                if (c.change - c.margin > threshold)
+                {
+                    c.verdict = verdict::regressed;
+                    ++result.regressions;
+                }
+                else if (c.change + c.margin < -threshold)
+                {
+                    c.verdict = verdict::improved;
+                }
+
+                result.changes.push_back(c);
+            }
+
+            return result;
+        }
+    }
+}
+
+#endif // SCHROTT_ID_BENCHMARK_COMPARE_HPP
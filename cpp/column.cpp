@@ -0,0 +1,1003 @@
+/**
+ * Transcodes binary columns of integer keys to SchrottID columns and back
+ *
+ * The integer column is a file of little-endian 64-bit values. The SchrottID column is either a file of fixed-width
+ * records, NUL-padded at the end, or a pair of files in the layout of Arrow string columns: <path>.offsets holds
+ * count + 1 little-endian 64-bit offsets starting at 0, <path>.chars the IDs back to back.
+ *
+ * Files are processed in blocks that run through a ring of buffers: one thread reads the next block while the
+ * blocks before it are encoded on all cores and written by another thread. Reads and writes of whole blocks are
+ * aligned to 4096 bytes, so --io direct can bypass the page cache with O_DIRECT, and --io mmap maps the input
+ * instead of copying it. File systems without O_DIRECT fall back to buffered I/O.
+ *
+ * Usage: schrott_id_column encode|decode [options] <input> <output>
+ *   --format <name>            fixed (default) or offsets
+ *   --alphabet <chars>         Alphabet, Base64 by default
+ *   --permutation <base64>     Permutation, the one of test/control.txt by default
+ *   --min-length <n>           Minimum length, 3 by default
+ *   --max <n>                  Largest value, every record then has the length of its ID, only with fixed
+ *   --width <n>                Characters per record, the length of the longest ID by default
+ *   --threads <n>              Encoding threads, the number of cores by default
+ *   --block <n>                Values per block, 1048576 by default, rounded up to a multiple of 4096
+ *   --io <mode>                read (default), direct or mmap, mmap only applies to input files
+ *
+ * https://github.com/lorisleitner/schrott-id
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "schrott_id.hpp"
+
+#ifndef O_DIRECT
+#define O_DIRECT 0
+#endif
+
+using namespace schrott_id;
+
+namespace
+{
+    const char* const kPermutation =
+            "HwEMFAcAMAYEPxc4Dy4RAxAkEgstJggbGSMiKB0yHgk7OSsNMxoYKRMWNg49LzEFFTQKPDUhHAIsICclOio+Nw==";
+
+    // Alignment of buffers, file positions and sizes of direct I/O
+    const std::size_t kAlign = 4096;
+
+    // Blocks in flight: one being read, one being encoded and one being written
+    const std::size_t kSlots = 3;
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    const bool kLittleEndian = false;
+#else
+    const bool kLittleEndian = true;
+#endif
+
+    enum class io_mode
+    {
+        read,
+        direct,
+        mmap
+    };
+
+    struct options
+    {
+        bool encode = true;
+        bool offsets = false;
+        std::string alphabet = alphabets::base64;
+        std::string permutation = kPermutation;
+        int min_length = 3;
+        std::uint64_t max = 0;
+        bool has_max = false;
+        std::size_t width = 0;
+        unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+        std::size_t block = std::size_t{1} << 20;
+        io_mode io = io_mode::read;
+        std::string input;
+        std::string output;
+    };
+
+    int usage()
+    {
+        std::cerr << "Usage: schrott_id_column encode|decode [--format fixed|offsets] [--alphabet <chars>]\n"
+                     "                         [--permutation <base64>] [--min-length <n>] [--max <n>] [--width <n>]\n"
+                     "                         [--threads <n>] [--block <n>] [--io read|direct|mmap]\n"
+                     "                         <input> <output>\n";
+        return 2;
+    }
+
+    std::runtime_error system_error(const std::string& what, const std::string& path)
+    {
+        return std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+    }
+
+    void swap_bytes(std::uint64_t* values, std::size_t count)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            values[i] = __builtin_bswap64(values[i]);
+        }
+    }
+
+    std::size_t align_up(std::size_t n)
+    {
+        return (n + kAlign - 1) / kAlign * kAlign;
+    }
+
+    // Page aligned memory as direct I/O needs it, grows without keeping its contents
+    class aligned_buffer
+    {
+        struct release
+        {
+            void operator()(char* p) const
+            {
+                std::free(p);
+            }
+        };
+
+        std::unique_ptr<char, release> data_;
+        std::size_t capacity_ = 0;
+
+    public:
+        char* data() const
+        {
+            return data_.get();
+        }
+
+        void reserve(std::size_t size)
+        {
+            if (size <= capacity_)
+            {
+                return;
+            }
+
+            void* p = nullptr;
+            capacity_ = align_up(size);
+
+            if (posix_memalign(&p, kAlign, capacity_) != 0)
+            {
+                throw std::bad_alloc();
+            }
+
+            data_.reset(static_cast<char*>(p));
+        }
+    };
+
+    class input_file
+    {
+        std::string path_;
+        int fd_ = -1;
+        bool direct_ = false;
+        char* map_ = nullptr;
+        std::uint64_t size_ = 0;
+        std::uint64_t position_ = 0;
+
+    public:
+        input_file(const std::string& path, io_mode mode)
+                : path_(path)
+        {
+            if (mode == io_mode::direct && O_DIRECT != 0)
+            {
+                fd_ = open(path.c_str(), O_RDONLY | O_DIRECT);
+                direct_ = fd_ >= 0;
+            }
+
+            if (fd_ < 0)
+            {
+                fd_ = open(path.c_str(), O_RDONLY);
+            }
+
+            struct stat info;
+
+            if (fd_ < 0 || fstat(fd_, &info) != 0)
+            {
+                throw system_error("Cannot open", path);
+            }
+
+            size_ = static_cast<std::uint64_t>(info.st_size);
+
+            if (mode == io_mode::mmap && size_ > 0)
+            {
+                auto p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+
+                if (p == MAP_FAILED)
+                {
+                    throw system_error("Cannot map", path);
+                }
+
+                map_ = static_cast<char*>(p);
+                madvise(map_, size_, MADV_SEQUENTIAL);
+            }
+        }
+
+        input_file(const input_file&) = delete;
+        input_file& operator=(const input_file&) = delete;
+
+        ~input_file()
+        {
+            if (map_)
+            {
+                munmap(map_, size_);
+            }
+
+            close(fd_);
+        }
+
+        std::uint64_t size() const
+        {
+            return size_;
+        }
+
+        std::uint64_t remaining() const
+        {
+            return size_ - position_;
+        }
+
+        /**
+         * Returns the next size bytes, fewer at the end of the file. Mapped files return a pointer into the mapping,
+         * others read into buffer, which is reserved to a multiple of kAlign bytes.
+         */
+        const char* read(std::size_t size, aligned_buffer& buffer, std::size_t& got)
+        {
+            got = static_cast<std::size_t>(std::min<std::uint64_t>(size, remaining()));
+
+            if (map_)
+            {
+                auto p = map_ + position_;
+                position_ += got;
+                return p;
+            }
+
+            // Direct reads must start at aligned positions, the rest of the file is read through the page cache
+            if (direct_ && position_ % kAlign != 0)
+            {
+                fcntl(fd_, F_SETFL, fcntl(fd_, F_GETFL) & ~O_DIRECT);
+                direct_ = false;
+            }
+
+            auto length = direct_ ? align_up(got) : got;
+            buffer.reserve(length);
+
+            for (std::size_t done = 0; done < got;)
+            {
+                auto n = pread(fd_, buffer.data() + done, length - done, static_cast<off_t>(position_ + done));
+
+                if (n < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+
+                if (n <= 0)
+                {
+                    throw system_error("Cannot read", path_);
+                }
+
+                done += static_cast<std::size_t>(n);
+            }
+
+            position_ += got;
+            return buffer.data();
+        }
+    };
+
+    class output_file
+    {
+        std::string path_;
+        int fd_ = -1;
+        bool direct_ = false;
+        std::uint64_t position_ = 0;
+
+    public:
+        output_file(const std::string& path, io_mode mode)
+                : path_(path)
+        {
+            if (mode == io_mode::direct && O_DIRECT != 0)
+            {
+                fd_ = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_DIRECT, 0644);
+                direct_ = fd_ >= 0;
+            }
+
+            if (fd_ < 0)
+            {
+                fd_ = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            }
+
+            if (fd_ < 0)
+            {
+                throw system_error("Cannot create", path);
+            }
+        }
+
+        output_file(const output_file&) = delete;
+        output_file& operator=(const output_file&) = delete;
+
+        ~output_file()
+        {
+            close(fd_);
+        }
+
+        std::uint64_t size() const
+        {
+            return position_;
+        }
+
+        void write(const char* data, std::size_t size)
+        {
+            // Direct writes need aligned memory, positions and sizes, the unaligned tail goes through the page cache
+            if (direct_ && (position_ % kAlign != 0 || reinterpret_cast<std::uintptr_t>(data) % kAlign != 0))
+            {
+                buffered();
+            }
+
+            if (direct_ && size % kAlign != 0)
+            {
+                auto aligned = size / kAlign * kAlign;
+                write_all(data, aligned);
+                buffered();
+                write_all(data + aligned, size - aligned);
+                return;
+            }
+
+            write_all(data, size);
+        }
+
+    private:
+        void buffered()
+        {
+            fcntl(fd_, F_SETFL, fcntl(fd_, F_GETFL) & ~O_DIRECT);
+            direct_ = false;
+        }
+
+        void write_all(const char* data, std::size_t size)
+        {
+            for (std::size_t done = 0; done < size;)
+            {
+                auto n = pwrite(fd_, data + done, size - done, static_cast<off_t>(position_));
+
+                if (n < 0 && errno == EINTR)
+                {
+                    continue;
+                }
+
+                if (n < 0)
+                {
+                    throw system_error("Cannot write", path_);
+                }
+
+                done += static_cast<std::size_t>(n);
+                position_ += static_cast<std::uint64_t>(n);
+            }
+        }
+    };
+
+    // Encoder of the records, fixed_length_encoder with --max
+    struct codec
+    {
+        schrott_id_encoder encoder;
+        std::unique_ptr<fixed_length_encoder> fixed;
+        std::size_t width;
+
+        error encode(const std::uint64_t* values, std::size_t count, char* out) const
+        {
+            return fixed
+                   ? fixed->encode_batch(values, count, out, count * width)
+                   : encoder.encode_records(values, count, out, width);
+        }
+
+        std::size_t decode(const char* records, std::size_t count, std::uint64_t* values, error* errors) const
+        {
+            return fixed
+                   ? fixed->decode_batch(records, count, values, errors)
+                   : encoder.decode_records(records, count, width, values, errors);
+        }
+    };
+
+    enum class stage
+    {
+        free,
+        read,
+        processed
+    };
+
+    // A block in flight, count 0 marks the end of the input
+    struct slot
+    {
+        stage state = stage::free;
+        std::size_t first = 0;
+        std::size_t count = 0;
+        const char* data = nullptr;
+        aligned_buffer input;
+        aligned_buffer entries;
+        aligned_buffer output;
+        std::size_t output_size = 0;
+        std::vector<std::size_t> offsets;
+        std::vector<std::uint64_t> chars_offsets;
+        std::vector<error> errors;
+    };
+
+    class transcoder
+    {
+        const options& opts_;
+        const codec& codec_;
+        std::size_t max_length_;
+
+        std::unique_ptr<input_file> input_;
+        std::unique_ptr<input_file> input_chars_;
+        std::unique_ptr<output_file> output_;
+        std::unique_ptr<output_file> output_offsets_;
+
+        std::mutex mutex_;
+        std::condition_variable changed_;
+        slot slots_[kSlots];
+        std::string failure_;
+
+        // Position in the chars file behind the IDs handed out so far
+        std::uint64_t chars_end_ = 0;
+
+    public:
+        std::uint64_t values = 0;
+        std::uint64_t failed = 0;
+        std::uint64_t first_failed = 0;
+
+        transcoder(const options& opts, const codec& c)
+                : opts_(opts),
+                  codec_(c),
+                  max_length_(c.encoder.max_encoded_length())
+        {
+            if (opts.encode)
+            {
+                input_.reset(new input_file(opts.input, opts.io));
+
+                if (input_->size() % 8 != 0)
+                {
+                    throw std::runtime_error(opts.input + " is no column of 64-bit values");
+                }
+
+                if (opts.offsets)
+                {
+                    output_.reset(new output_file(opts.output + ".chars", opts.io));
+                    output_offsets_.reset(new output_file(opts.output + ".offsets", opts.io));
+                    output_offsets_->write("\0\0\0\0\0\0\0\0", 8);
+                }
+                else
+                {
+                    output_.reset(new output_file(opts.output, opts.io));
+                }
+            }
+            else
+            {
+                if (opts.offsets)
+                {
+                    input_.reset(new input_file(opts.input + ".offsets", opts.io));
+                    input_chars_.reset(new input_file(opts.input + ".chars", opts.io));
+
+                    // The first offset is always 0
+                    aligned_buffer buffer;
+                    std::size_t got;
+                    input_->read(8, buffer, got);
+
+                    if (input_->size() % 8 != 0 || got != 8)
+                    {
+                        throw std::runtime_error(opts.input + ".offsets is no column of 64-bit offsets");
+                    }
+                }
+                else
+                {
+                    input_.reset(new input_file(opts.input, opts.io));
+
+                    if (input_->size() % c.width != 0)
+                    {
+                        throw std::runtime_error(opts.input + " is no column of " + std::to_string(c.width)
+                                                 + " character records");
+                    }
+                }
+
+                output_.reset(new output_file(opts.output, opts.io));
+            }
+        }
+
+        /**
+         * Runs the pipeline, throws std::runtime_error if a file could not be read or written or a value
+         * could not be encoded. Values that failed to decode are counted.
+         */
+        void run()
+        {
+            std::thread reader([this]
+                               { read_blocks(); });
+            std::thread writer([this]
+                               { write_blocks(); });
+
+            for (std::size_t b = 0;; ++b)
+            {
+                auto& s = slots_[b % kSlots];
+                wait(s, stage::read);
+
+                if (s.count > 0 && !failing())
+                {
+                    try
+                    {
+                        process(s);
+                    }
+                    catch (const std::exception& e)
+                    {
+                        fail(e.what());
+                    }
+                }
+
+                // Once advanced the slot may already be reused for a later block
+                auto last = s.count == 0;
+                advance(s, stage::processed);
+
+                if (last)
+                {
+                    break;
+                }
+            }
+
+            reader.join();
+            writer.join();
+
+            if (!failure_.empty())
+            {
+                throw std::runtime_error(failure_);
+            }
+        }
+
+        std::uint64_t bytes_read() const
+        {
+            return input_->size() + (input_chars_ ? input_chars_->size() : 0);
+        }
+
+        std::uint64_t bytes_written() const
+        {
+            return output_->size() + (output_offsets_ ? output_offsets_->size() : 0);
+        }
+
+    private:
+        void wait(slot& s, stage state)
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            changed_.wait(lock, [&]
+            { return s.state == state; });
+        }
+
+        void advance(slot& s, stage state)
+        {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                s.state = state;
+            }
+
+            changed_.notify_all();
+        }
+
+        void fail(const std::string& message)
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+
+            if (failure_.empty())
+            {
+                failure_ = message;
+            }
+        }
+
+        bool failing()
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return !failure_.empty();
+        }
+
+        void read_blocks()
+        {
+            for (std::size_t b = 0, first = 0;; ++b)
+            {
+                auto& s = slots_[b % kSlots];
+                wait(s, stage::free);
+
+                s.first = first;
+                s.count = 0;
+
+                if (!failing())
+                {
+                    try
+                    {
+                        read_block(s);
+                    }
+                    catch (const std::exception& e)
+                    {
+                        fail(e.what());
+                        s.count = 0;
+                    }
+                }
+
+                first += s.count;
+                advance(s, stage::read);
+
+                if (s.count == 0)
+                {
+                    return;
+                }
+            }
+        }
+
+        void read_block(slot& s)
+        {
+            std::size_t got;
+
+            if (opts_.encode)
+            {
+                s.data = input_->read(opts_.block * 8, s.input, got);
+                s.count = got / 8;
+
+                if (!kLittleEndian)
+                {
+                    s.input.reserve(got);
+
+                    if (s.data != s.input.data())
+                    {
+                        std::memcpy(s.input.data(), s.data, got);
+                        s.data = s.input.data();
+                    }
+
+                    swap_bytes(reinterpret_cast<std::uint64_t*>(s.input.data()), s.count);
+                }
+            }
+            else if (!opts_.offsets)
+            {
+                s.data = input_->read(opts_.block * codec_.width, s.input, got);
+                s.count = got / codec_.width;
+            }
+            else
+            {
+                auto p = input_->read(opts_.block * 8, s.entries, got);
+                s.count = got / 8;
+
+                if (s.count == 0)
+                {
+                    return;
+                }
+
+                // The end of the i-th ID relative to the chars of the block is offsets[i + 1]
+                s.offsets.resize(s.count + 1);
+                s.offsets[0] = 0;
+
+                auto start = chars_end_;
+
+                for (std::size_t i = 0; i < s.count; ++i)
+                {
+                    std::uint64_t end;
+                    std::memcpy(&end, p + i * 8, 8);
+
+                    if (!kLittleEndian)
+                    {
+                        swap_bytes(&end, 1);
+                    }
+
+                    if (end < chars_end_ || end - chars_end_ > max_length_ || end > input_chars_->size())
+                    {
+                        throw std::runtime_error("Offset " + std::to_string(s.first + i + 1) + " is out of order");
+                    }
+
+                    chars_end_ = end;
+                    s.offsets[i + 1] = static_cast<std::size_t>(end - start);
+                }
+
+                s.data = input_chars_->read(s.offsets[s.count], s.input, got);
+            }
+        }
+
+        void process(slot& s)
+        {
+            auto threads = static_cast<std::size_t>(opts_.threads);
+            auto part = (s.count + threads - 1) / threads;
+            auto parts = (s.count + part - 1) / part;
+            std::vector<error> errors(parts, error::none);
+            std::vector<std::size_t> failures(parts, 0);
+
+            if (opts_.encode)
+            {
+                s.output.reserve(s.count * (opts_.offsets ? max_length_ : codec_.width));
+            }
+            else
+            {
+                s.output.reserve(s.count * 8);
+                s.errors.resize(s.count);
+            }
+
+            if (opts_.offsets)
+            {
+                s.offsets.resize(opts_.encode ? s.count + parts : s.offsets.size());
+            }
+
+            auto work = [&](std::size_t k)
+            {
+                auto first = k * part;
+                auto count = std::min(part, s.count - first);
+                auto values = reinterpret_cast<const std::uint64_t*>(s.data) + first;
+                auto decoded = reinterpret_cast<std::uint64_t*>(s.output.data()) + first;
+
+                if (opts_.encode && opts_.offsets)
+                {
+                    // Each part encodes into its own region and receives count + 1 offsets
+                    errors[k] = codec_.encoder.encode_batch(values, count, s.output.data() + first * max_length_,
+                                                            count * max_length_, s.offsets.data() + first + k);
+                }
+                else if (opts_.encode)
+                {
+                    errors[k] = codec_.encode(values, count, s.output.data() + first * codec_.width);
+                }
+                else if (opts_.offsets)
+                {
+                    failures[k] = codec_.encoder.decode_batch(s.data, s.offsets.data() + first, count, decoded,
+                                                            s.errors.data() + first);
+                }
+                else
+                {
+                    failures[k] = codec_.decode(s.data + first * codec_.width, count, decoded, s.errors.data() + first);
+                }
+            };
+
+            std::vector<std::thread> helpers;
+
+            for (std::size_t k = 1; k < parts; ++k)
+            {
+                helpers.emplace_back(work, k);
+            }
+
+            work(0);
+
+            for (auto& helper: helpers)
+            {
+                helper.join();
+            }
+
+            for (std::size_t k = 0; k < parts; ++k)
+            {
+                if (errors[k] != error::none)
+                {
+                    throw std::runtime_error("Cannot encode the values from " + std::to_string(s.first + k * part)
+                                             + ": " + error_message(errors[k]));
+                }
+
+                failed_ids(s, k * part, failures[k]);
+            }
+
+            if (opts_.encode && opts_.offsets)
+            {
+                compact(s, part, parts);
+            }
+            else if (opts_.encode)
+            {
+                s.output_size = s.count * codec_.width;
+            }
+            else
+            {
+                if (!kLittleEndian)
+                {
+                    swap_bytes(reinterpret_cast<std::uint64_t*>(s.output.data()), s.count);
+                }
+
+                s.output_size = s.count * 8;
+            }
+
+            values += s.count;
+        }
+
+        void failed_ids(const slot& s, std::size_t first, std::size_t count)
+        {
+            if (count == 0)
+            {
+                return;
+            }
+
+            if (failed == 0)
+            {
+                while (s.errors[first] == error::none)
+                {
+                    ++first;
+                }
+
+                first_failed = s.first + first;
+            }
+
+            failed += count;
+        }
+
+        // Moves the IDs of the parts next to each other and turns their offsets into offsets of the chars file
+        void compact(slot& s, std::size_t part, std::size_t parts)
+        {
+            std::size_t pos = 0;
+            s.chars_offsets.resize(s.count);
+
+            for (std::size_t k = 0; k < parts; ++k)
+            {
+                auto first = k * part;
+                auto count = std::min(part, s.count - first);
+                auto offsets = s.offsets.data() + first + k;
+
+                std::memmove(s.output.data() + pos, s.output.data() + first * max_length_, offsets[count]);
+
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    s.chars_offsets[first + i] = chars_end_ + pos + offsets[i + 1];
+                }
+
+                pos += offsets[count];
+            }
+
+            if (!kLittleEndian)
+            {
+                swap_bytes(s.chars_offsets.data(), s.count);
+            }
+
+            chars_end_ += pos;
+            s.output_size = pos;
+        }
+
+        void write_blocks()
+        {
+            for (std::size_t b = 0;; ++b)
+            {
+                auto& s = slots_[b % kSlots];
+                wait(s, stage::processed);
+
+                if (s.count == 0)
+                {
+                    return;
+                }
+
+                if (!failing())
+                {
+                    try
+                    {
+                        output_->write(s.output.data(), s.output_size);
+
+                        if (output_offsets_)
+                        {
+                            output_offsets_->write(reinterpret_cast<const char*>(s.chars_offsets.data()),
+                                                   s.count * 8);
+                        }
+                    }
+                    catch (const std::exception& e)
+                    {
+                        fail(e.what());
+                    }
+                }
+
+                advance(s, stage::free);
+            }
+        }
+    };
+}
+
+int main(int argc, char** argv)
+{
+    options opts;
+    std::vector<const char*> files;
+
+    if (argc < 2 || (std::strcmp(argv[1], "encode") != 0 && std::strcmp(argv[1], "decode") != 0))
+    {
+        return usage();
+    }
+
+    opts.encode = std::strcmp(argv[1], "encode") == 0;
+
+    for (auto i = 2; i < argc; ++i)
+    {
+        const char* option = argv[i];
+
+        if (std::strncmp(option, "--", 2) != 0)
+        {
+            files.push_back(option);
+            continue;
+        }
+
+        if (i + 1 == argc)
+        {
+            return usage();
+        }
+
+        const char* value = argv[++i];
+
+        if (std::strcmp(option, "--format") == 0)
+        {
+            opts.offsets = std::strcmp(value, "offsets") == 0;
+
+            if (!opts.offsets && std::strcmp(value, "fixed") != 0)
+            {
+                return usage();
+            }
+        }
+        else if (std::strcmp(option, "--alphabet") == 0)
+        {
+            opts.alphabet = value;
+        }
+        else if (std::strcmp(option, "--permutation") == 0)
+        {
+            opts.permutation = value;
+        }
+        else if (std::strcmp(option, "--min-length") == 0)
+        {
+            opts.min_length = std::atoi(value);
+        }
+        else if (std::strcmp(option, "--max") == 0)
+        {
+            opts.max = std::strtoull(value, nullptr, 10);
+            opts.has_max = true;
+        }
+        else if (std::strcmp(option, "--width") == 0)
+        {
+            opts.width = std::strtoul(value, nullptr, 10);
+        }
+        else if (std::strcmp(option, "--threads") == 0)
+        {
+            opts.threads = std::max(1, std::atoi(value));
+        }
+        else if (std::strcmp(option, "--block") == 0)
+        {
+            opts.block = align_up(std::max<std::size_t>(1, std::strtoul(value, nullptr, 10)));
+        }
+        else if (std::strcmp(option, "--io") == 0)
+        {
+            if (std::strcmp(value, "read") == 0)
+            {
+                opts.io = io_mode::read;
+            }
+            else if (std::strcmp(value, "direct") == 0)
+            {
+                opts.io = io_mode::direct;
+            }
+            else if (std::strcmp(value, "mmap") == 0)
+            {
+                opts.io = io_mode::mmap;
+            }
+            else
+            {
+                return usage();
+            }
+        }
+        else
+        {
+            return usage();
+        }
+    }
+
+    if (files.size() != 2 || (opts.has_max && opts.offsets))
+    {
+        return usage();
+    }
+
+    opts.input = files[0];
+    opts.output = files[1];
+
+    try
+    {
+        codec c{schrott_id_encoder(opts.alphabet, opts.permutation, opts.min_length), nullptr, 0};
+
+        if (opts.has_max)
+        {
+            c.fixed.reset(new fixed_length_encoder(c.encoder, opts.max));
+            c.width = c.fixed->length();
+        }
+        else
+        {
+            c.width = opts.width > 0 ? opts.width : c.encoder.max_encoded_length();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+
+        transcoder t(opts, c);
+        t.run();
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << (opts.encode ? "Encoded " : "Decoded ") << t.values << " values, read "
+                  << t.bytes_read() << " bytes and wrote " << t.bytes_written() << " bytes in "
+                  << elapsed.count() << " s\n";
+
+        if (t.failed > 0)
+        {
+            std::cerr << t.failed << " IDs failed to decode, the first is record " << t.first_failed << '\n';
+            return 1;
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,40 @@
+#!/bin/sh
+# Round trip of a column through schrott_id_column in both formats, with blocks and thread counts that split it
+# unevenly. The column has a size that is neither a multiple of the block size nor of 4096 bytes.
+#
+# Usage: column_test.sh <schrott_id_column>
+
+set -e
+
+column=$1
+dir=$(mktemp -d)
+trap 'rm -rf "$dir"' EXIT
+
+# 9000 random values and a few short ones, so the IDs of the offsets format differ in length
+head -c 72000 /dev/urandom > "$dir/values"
+printf '\000\000\000\000\000\000\000\000\001\000\000\000\000\000\000\000\377\377\000\000\000\000\000\000' \
+        >> "$dir/values"
+
+for format in fixed offsets; do
+    for threads in 1 3 8; do
+        "$column" encode --format $format --block 4096 --threads $threads "$dir/values" "$dir/ids.$threads" \
+                > /dev/null
+        "$column" decode --format $format --block 4096 --threads $threads "$dir/ids.$threads" \
+                "$dir/decoded.$threads" > /dev/null
+
+        if ! cmp -s "$dir/values" "$dir/decoded.$threads"; then
+            echo "$format with $threads threads does not round trip" >&2
+            exit 1
+        fi
+    done
+
+    # The encoded column does not depend on the number of threads
+    if [ $format = fixed ]; then
+        cmp "$dir/ids.1" "$dir/ids.8"
+    else
+        cmp "$dir/ids.1.offsets" "$dir/ids.8.offsets"
+        cmp "$dir/ids.1.chars" "$dir/ids.8.chars"
+    fi
+done
+
+echo "Round trips passed"
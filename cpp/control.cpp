@@ -0,0 +1,403 @@
+/**
+ * Writes control files like test/control.txt for arbitrary encoder parameters
+ *
+ * With --verify it instead encodes all N^L values that have IDs of length L, on all cores, and checks that every
+ * string of length L comes up exactly once, using a bitmap of N^L bits, and that decode returns the value.
+ * The minimum length is set to L for this.
+ *
+ * Usage: schrott_id_control [options] > control.txt
+ *   --alphabet <chars>         Alphabet, Base64 by default
+ *   --permutation <base64>     Permutation, the one of test/control.txt by default
+ *   --min-length <n>           Minimum length, 3 by default
+ *   --rounds-per-digit <n>     Rounds per digit, 3 (v3) by default
+ *   --fixed-rounds <n>         Rounds independent of the length, 0 (v3) by default
+ *   --algorithm <name>         cascade (default), feistel or ff1, feistel and ff1 ignore the rounds
+ *   --key <hex>                AES key of ff1, which ignores the permutation
+ *   --count <n>                Number of values starting at 0, 10000 by default
+ *   --verify <L>               Verify the bijection onto IDs of length L instead of writing a control file
+ *   --threads <n>              Threads of --verify, the number of cores by default
+ *
+ * https://github.com/lorisleitner/schrott-id
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <thread>
+
+#include "schrott_id.hpp"
+#include "schrott_id_ff1.hpp"
+
+using namespace schrott_id;
+
+namespace
+{
+    const char* const kControlPermutation =
+            "HwEMFAcAMAYEPxc4Dy4RAxAkEgstJggbGSMiKB0yHgk7OSsNMxoYKRMWNg49LzEFFTQKPDUhHAIsICclOio+Nw==";
+
+    int usage()
+    {
+        std::cerr << "Usage: schrott_id_control [--alphabet <chars>] [--permutation <base64>] [--min-length <n>]\n"
+                     "                          [--rounds-per-digit <n>] [--fixed-rounds <n>] [--count <n>]\n"
+                     "                          [--algorithm cascade|feistel|ff1] [--key <hex>]\n"
+                     "                          [--verify <length> [--threads <n>]]\n";
+        return 2;
+    }
+
+    std::vector<byte> parse_hex(const std::string& hex)
+    {
+        std::vector<byte> bytes;
+
+        for (std::size_t i = 0; i + 1 < hex.size(); i += 2)
+        {
+            bytes.push_back(static_cast<byte>(std::stoul(hex.substr(i, 2), nullptr, 16)));
+        }
+
+        return bytes;
+    }
+
+    template<class Encoder>
+    void write_values(const Encoder& encoder, std::uint64_t count)
+    {
+        std::cout << "\n# Use this file to verify implementations in new languages\n\n";
+
+        for (std::uint64_t value = 0; value < count; ++value)
+        {
+            std::cout << encoder.encode(value) << '\n';
+        }
+    }
+
+    // Values encoded and decoded per batch of a verifying thread
+    const std::size_t kVerifyChunk = 4096;
+
+    // Largest N^L that --verify checks, its bitmap takes 2 GiB
+    const std::uint64_t kVerifyMaxValues = std::uint64_t{1} << 34;
+
+    // Cascade encoders step through consecutive values digit by digit
+    error encode_chunk(const schrott_id_encoder& encoder, const std::uint64_t* values, std::size_t count, char* out,
+                       std::size_t out_size, std::size_t* offsets)
+    {
+        return encoder.encode_range(values[0], count, out, out_size, offsets);
+    }
+
+    template<class Encoder>
+    error encode_chunk(const Encoder& encoder, const std::uint64_t* values, std::size_t count, char* out,
+                       std::size_t out_size, std::size_t* offsets)
+    {
+        return encoder.encode_batch(values, count, out, out_size, offsets);
+    }
+
+    // State shared by the verifying threads, the first failure stops all of them
+    struct verification
+    {
+        std::uint64_t total;
+        std::vector<std::atomic<std::uint64_t>> seen;
+        std::atomic<std::uint64_t> next{0};
+        std::atomic<bool> failed{false};
+        std::mutex mutex;
+        std::string message;
+
+        explicit verification(std::uint64_t values)
+                : total(values),
+                  seen((values + 63) / 64)
+        {
+            for (auto& word: seen)
+            {
+                word.store(0, std::memory_order_relaxed);
+            }
+        }
+
+        void fail(const std::string& text)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+
+            if (!failed.exchange(true))
+            {
+                message = text;
+            }
+        }
+    };
+
+    template<class Encoder>
+    void verify_values(const Encoder& encoder, std::size_t length, verification& v)
+    {
+        const auto& alphabet = encoder.alphabet();
+        std::uint16_t digits[256];
+        std::fill(std::begin(digits), std::end(digits), 0);
+
+        for (std::size_t i = 0; i < alphabet.size(); ++i)
+        {
+            digits[static_cast<byte>(alphabet[i])] = static_cast<std::uint16_t>(i);
+        }
+
+        std::vector<std::uint64_t> values(kVerifyChunk);
+        std::vector<char> chars(kVerifyChunk * length);
+        std::vector<std::size_t> offsets(kVerifyChunk + 1);
+        std::vector<std::uint64_t> decoded(kVerifyChunk);
+        std::vector<error> errors(kVerifyChunk);
+
+        while (!v.failed.load(std::memory_order_relaxed))
+        {
+            auto start = v.next.fetch_add(kVerifyChunk, std::memory_order_relaxed);
+
+            if (start >= v.total)
+            {
+                return;
+            }
+
+            auto count = static_cast<std::size_t>(std::min<std::uint64_t>(kVerifyChunk, v.total - start));
+
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                values[i] = start + i;
+            }
+
+            if (encode_chunk(encoder, values.data(), count, chars.data(), chars.size(), offsets.data()) != error::none
+                || offsets[count] != count * length)
+            {
+                v.fail("Values from " + std::to_string(start) + " have IDs of another length than "
+                       + std::to_string(length));
+                return;
+            }
+
+            encoder.decode_batch(chars.data(), offsets.data(), count, decoded.data(), errors.data());
+
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                auto id = chars.data() + i * length;
+
+                if (errors[i] != error::none || decoded[i] != values[i])
+                {
+                    v.fail("Value " + std::to_string(values[i]) + " encodes to " + std::string(id, length)
+                           + ", which decodes to " + (errors[i] == error::none
+                                                      ? std::to_string(decoded[i])
+                                                      : std::string(error_message(errors[i]))));
+                    return;
+                }
+
+                // The ID read as a number in base N is its position in the bitmap
+                std::uint64_t index = 0;
+                for (std::size_t k = 0; k < length; ++k)
+                {
+                    index = index * alphabet.size() + digits[static_cast<byte>(id[k])];
+                }
+
+                auto bit = std::uint64_t{1} << (index % 64);
+
+                if (v.seen[index / 64].fetch_or(bit, std::memory_order_relaxed) & bit)
+                {
+                    v.fail("ID " + std::string(id, length) + " of value " + std::to_string(values[i])
+                           + " was produced before");
+                    return;
+                }
+            }
+        }
+    }
+
+    template<class Encoder>
+    int verify(const Encoder& encoder, std::size_t length, unsigned threads)
+    {
+        std::uint64_t total = 1;
+
+        for (std::size_t i = 0; i < length; ++i)
+        {
+            if (total > kVerifyMaxValues / encoder.alphabet().size())
+            {
+                std::cerr << "Too many IDs of length " << length << " to verify\n";
+                return 1;
+            }
+
+            total *= encoder.alphabet().size();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+
+        verification v(total);
+        std::vector<std::thread> workers;
+
+        for (unsigned t = 0; t < threads; ++t)
+        {
+            workers.emplace_back(verify_values<Encoder>, std::cref(encoder), length, std::ref(v));
+        }
+
+        for (auto& worker: workers)
+        {
+            worker.join();
+        }
+
+        // Without collisions all bits are set, unless the encoder skipped values
+        for (std::uint64_t i = 0; !v.failed && i < total; ++i)
+        {
+            if (!(v.seen[i / 64].load(std::memory_order_relaxed) >> (i % 64) & 1))
+            {
+                v.fail("No value encodes to the " + std::to_string(i) + "th ID of length " + std::to_string(length));
+            }
+        }
+
+        if (v.failed)
+        {
+            std::cerr << v.message << '\n';
+            return 1;
+        }
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        std::cout << "Verified " << total << " IDs of length " << length << " on " << threads << " threads in "
+                  << elapsed.count() << " s\n";
+
+        return 0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    std::string alphabet = alphabets::base64;
+    std::string permutation = kControlPermutation;
+    int min_length = 3;
+    round_schedule schedule;
+    auto kind = algorithm::cascade;
+    auto ff1 = false;
+    std::string key;
+    std::uint64_t count = 10000;
+    std::size_t verify_length = 0;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+
+    for (auto i = 1; i < argc; ++i)
+    {
+        if (i + 1 == argc)
+        {
+            return usage();
+        }
+
+        const char* option = argv[i];
+        const char* value = argv[++i];
+
+        if (std::strcmp(option, "--alphabet") == 0)
+        {
+            alphabet = value;
+        }
+        else if (std::strcmp(option, "--permutation") == 0)
+        {
+            permutation = value;
+        }
+        else if (std::strcmp(option, "--min-length") == 0)
+        {
+            min_length = std::atoi(value);
+        }
+        else if (std::strcmp(option, "--rounds-per-digit") == 0)
+        {
+            schedule.per_digit = static_cast<std::uint32_t>(std::strtoul(value, nullptr, 10));
+        }
+        else if (std::strcmp(option, "--fixed-rounds") == 0)
+        {
+            schedule.fixed = static_cast<std::uint32_t>(std::strtoul(value, nullptr, 10));
+        }
+        else if (std::strcmp(option, "--algorithm") == 0)
+        {
+            ff1 = std::strcmp(value, "ff1") == 0;
+
+            if (ff1 || std::strcmp(value, "cascade") == 0)
+            {
+                kind = algorithm::cascade;
+            }
+            else if (std::strcmp(value, "feistel") == 0)
+            {
+                kind = algorithm::feistel;
+            }
+            else
+            {
+                return usage();
+            }
+        }
+        else if (std::strcmp(option, "--key") == 0)
+        {
+            key = value;
+        }
+        else if (std::strcmp(option, "--count") == 0)
+        {
+            count = std::strtoull(value, nullptr, 10);
+        }
+        else if (std::strcmp(option, "--verify") == 0)
+        {
+            verify_length = std::strtoul(value, nullptr, 10);
+
+            if (verify_length == 0)
+            {
+                return usage();
+            }
+        }
+        else if (std::strcmp(option, "--threads") == 0)
+        {
+            threads = std::max(1, std::atoi(value));
+        }
+        else
+        {
+            return usage();
+        }
+    }
+
+    if (verify_length > 0)
+    {
+        min_length = static_cast<int>(verify_length);
+    }
+
+    try
+    {
+        if (ff1)
+        {
+            ff1_encoder encoder(alphabet, parse_hex(key), min_length);
+
+            if (verify_length > 0)
+            {
+                return verify(encoder, verify_length, threads);
+            }
+
+            std::cout << "# This file contains the encoded values from 0 to " << count - 1
+                      << " using the following parameters:\n"
+                      << "# Alphabet = " << alphabet << "\n"
+                      << "# Key = " << key << "\n"
+                      << "# Min length = " << encoder.min_length() << "\n"
+                      << "# Algorithm = " << encoder.version() << "\n";
+
+            write_values(encoder, count);
+            return 0;
+        }
+
+        auto encoder = kind == algorithm::cascade
+                       ? schrott_id_encoder(alphabet, permutation, min_length, schedule)
+                       : schrott_id_encoder(alphabet, permutation, min_length, kind);
+
+        if (verify_length > 0)
+        {
+            return verify(encoder, verify_length, threads);
+        }
+
+        std::cout << "# This file contains the encoded values from 0 to " << count - 1
+                  << " using the following parameters:\n"
+                  << "# Alphabet = " << alphabet << "\n"
+                  << "# Permutation = " << permutation << "\n"
+                  << "# Min length = " << min_length << "\n";
+
+        if (kind == algorithm::feistel)
+        {
+            std::cout << "# Algorithm = " << encoder.version() << "\n";
+        }
+        else if (!schedule.is_v3())
+        {
+            std::cout << "# Rounds = " << schedule.version() << " (" << schedule.per_digit
+                      << " per digit + " << schedule.fixed << ")\n";
+        }
+
+        write_values(encoder, count);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,580 @@
+/**
+ * Differential fuzzer for SchrottID encoders
+ *
+ * Derives an alphabet, permutation, minimum length, round schedule and values from the input and checks
+ * every encode and decode path of schrott_id_encoder and fixed_length_encoder against a frozen copy of
+ * the original round function, which rotates, permutes and cascades one step at a time. Feistel encoders
+ * have no reference and are checked for agreement between their single and batch paths.
+ *
+ * Built with -DSCHROTT_ID_LIBFUZZER and -fsanitize=fuzzer it is a libFuzzer target. Otherwise it feeds
+ * itself random inputs, shrinks the first failing case and prints it as a reproducer.
+ *
+ * Usage: schrott_id_fuzz [--seed <n>] [--iterations <n>]
+ *
+ * https://github.com/lorisleitner/schrott-id
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <sstream>
+
+#include "schrott_id.hpp"
+
+using namespace schrott_id;
+
+namespace
+{
+    /**
+     * The round function as the reference implementation runs it, for comparison only.
+     * Changes here change what the fuzzer accepts, so keep it as it is.
+     */
+    namespace reference
+    {
+        std::size_t length(std::uint64_t value, std::size_t base, int min_length)
+        {
+            auto digits = std::max(static_cast<int>(std::ceil(std::log(value + 1.0) / std::log(base))), min_length);
+
+            // The reference crashes where the logarithm rounds below the real digit count
+            std::size_t real = 1;
+            for (auto v = value / base; v > 0; v /= base)
+            {
+                ++real;
+            }
+
+            return std::max(static_cast<std::size_t>(digits), real);
+        }
+
+        void rotate_left(std::vector<byte>& buf)
+        {
+            std::rotate(buf.begin(), buf.begin() + 1, buf.end());
+        }
+
+        std::string encode(std::uint64_t value, const std::string& alphabet, const std::vector<byte>& permutation,
+                           int min_length, const round_schedule& schedule)
+        {
+            std::vector<byte> buf(length(value, alphabet.size(), min_length));
+
+            auto i = buf.size();
+            do
+            {
+                buf[--i] = value % alphabet.size();
+                value = value / alphabet.size();
+            } while (value > 0);
+
+            for (std::size_t round = 0; round < schedule.rounds(buf.size()); ++round)
+            {
+                rotate_left(buf);
+
+                for (auto& digit: buf)
+                {
+                    digit = permutation[digit];
+                }
+
+                rotate_left(buf);
+
+                byte last = 0;
+                for (auto& digit: buf)
+                {
+                    digit = (digit + last) % alphabet.size();
+                    last = digit;
+                }
+
+                rotate_left(buf);
+            }
+
+            std::string s(buf.size(), '\0');
+            for (std::size_t k = 0; k < buf.size(); ++k)
+            {
+                s[k] = alphabet[buf[k]];
+            }
+
+            return s;
+        }
+    }
+
+    struct fuzz_case
+    {
+        std::string alphabet;
+        std::vector<byte> permutation;
+        int min_length;
+        round_schedule schedule;
+        std::vector<std::uint64_t> values;
+    };
+
+    struct failure
+    {
+        std::string path;
+        std::uint64_t value;
+        std::string expected;
+        std::string actual;
+    };
+
+    // Reads parameters from fuzzer input, running out of input reads zeros
+    class input
+    {
+    private:
+        const std::uint8_t* data_;
+        std::size_t size_;
+
+    public:
+        input(const std::uint8_t* data, std::size_t size)
+                : data_(data),
+                  size_(size)
+        {
+        }
+
+        std::size_t remaining() const
+        {
+            return size_;
+        }
+
+        std::uint8_t next()
+        {
+            if (size_ == 0)
+            {
+                return 0;
+            }
+
+            --size_;
+            return *data_++;
+        }
+
+        std::uint64_t next64()
+        {
+            std::uint64_t value = 0;
+
+            for (auto i = 0; i < 8; ++i)
+            {
+                value = (value << 8) | next();
+            }
+
+            return value;
+        }
+    };
+
+    fuzz_case parse(const std::uint8_t* data, std::size_t size)
+    {
+        input in(data, size);
+        fuzz_case c;
+
+        std::size_t base = 2 + in.next() % 255;
+        c.min_length = 1 + in.next() % 24;
+
+        auto rounds = in.next();
+        if (rounds & 0x80)
+        {
+            c.schedule.per_digit = rounds % 5;
+            c.schedule.fixed = in.next() % 9;
+
+            if (c.schedule.rounds(1) == 0)
+            {
+                c.schedule = round_schedule::v3();
+            }
+        }
+
+        std::mt19937_64 random(in.next64());
+
+        std::vector<byte> chars(256);
+        for (std::size_t i = 0; i < chars.size(); ++i)
+        {
+            chars[i] = static_cast<byte>(i);
+        }
+
+        std::shuffle(chars.begin(), chars.end(), random);
+        c.alphabet.assign(chars.begin(), chars.begin() + base);
+
+        c.permutation.resize(base);
+        for (std::size_t i = 0; i < base; ++i)
+        {
+            c.permutation[i] = static_cast<byte>(i);
+        }
+
+        std::shuffle(c.permutation.begin(), c.permutation.end(), random);
+
+        // Values are taken whole or as a number of low bits, so all lengths come up
+        while (in.remaining() > 0 && c.values.size() < 64)
+        {
+            auto bits = in.next() % 65;
+            auto value = in.next64();
+            c.values.push_back(bits == 64 ? value : value & ((std::uint64_t{1} << bits) - 1));
+        }
+
+        if (c.values.empty())
+        {
+            c.values.push_back(0);
+        }
+
+        return c;
+    }
+
+    bool mismatch(failure& f, const std::string& path, std::uint64_t value, const std::string& expected,
+                  const std::string& actual)
+    {
+        if (expected == actual)
+        {
+            return false;
+        }
+
+        f = failure{path, value, expected, actual};
+        return true;
+    }
+
+    std::string value_string(std::uint64_t value)
+    {
+        return std::to_string(value);
+    }
+
+    schrott_id_encoder make_encoder(const fuzz_case& c, int min_length)
+    {
+        return schrott_id_encoder(c.alphabet, base64::encode(c.permutation), min_length, c.schedule);
+    }
+
+    bool check_cascade(const fuzz_case& c, failure& f)
+    {
+        auto encoder = make_encoder(c, c.min_length);
+        auto& values = c.values;
+
+        std::vector<std::string> expected;
+        std::string all;
+
+        for (auto value: values)
+        {
+            expected.push_back(reference::encode(value, c.alphabet, c.permutation, c.min_length, c.schedule));
+            all += expected.back();
+        }
+
+        for (std::size_t i = 0; i < values.size(); ++i)
+        {
+            char buf[128];
+            auto len = encoder.encode_to(values[i], buf, sizeof(buf));
+            std::uint64_t decoded = 0;
+            auto e = encoder.try_decode(expected[i].data(), expected[i].size(), decoded);
+
+            if (mismatch(f, "encode", values[i], expected[i], encoder.encode(values[i]))
+                || mismatch(f, "encode_to", values[i], expected[i], std::string(buf, len))
+                || mismatch(f, "try_decode", values[i], value_string(values[i]),
+                            e == error::none ? value_string(decoded) : error_message(e)))
+            {
+                return true;
+            }
+        }
+
+        // Batches run groups of equal length through the lane kernels
+        std::vector<char> chars(values.size() * encoder.max_encoded_length());
+        std::vector<std::size_t> offsets(values.size() + 1);
+        encoder.encode_batch(values.data(), values.size(), chars.data(), chars.size(), offsets.data());
+
+        for (std::size_t i = 0; i < values.size(); ++i)
+        {
+            std::string actual(chars.data() + offsets[i], chars.data() + offsets[i + 1]);
+
+            if (mismatch(f, "encode_batch", values[i], expected[i], actual))
+            {
+                return true;
+            }
+        }
+
+        std::vector<std::size_t> expected_offsets(1, 0);
+        for (auto& id: expected)
+        {
+            expected_offsets.push_back(expected_offsets.back() + id.size());
+        }
+
+        std::vector<std::uint64_t> decoded(values.size());
+        std::vector<error> errors(values.size());
+        encoder.decode_batch(all.data(), expected_offsets.data(), values.size(), decoded.data(), errors.data());
+
+        for (std::size_t i = 0; i < values.size(); ++i)
+        {
+            if (mismatch(f, "decode_batch", values[i], value_string(values[i]),
+                         errors[i] == error::none ? value_string(decoded[i]) : error_message(errors[i])))
+            {
+                return true;
+            }
+        }
+
+        std::vector<std::uint64_t> unique(values);
+        std::sort(unique.begin(), unique.end());
+        unique.erase(std::unique(unique.begin(), unique.end()), unique.end());
+
+        std::vector<std::size_t> positions(values.size());
+        auto n = encoder.decode_batch_sorted_unique(all.data(), expected_offsets.data(), values.size(), decoded.data(),
+                                                    positions.data(), errors.data());
+
+        for (std::size_t i = 0; i < values.size(); ++i)
+        {
+            auto actual = positions[i] < n ? value_string(decoded[positions[i]]) : error_message(errors[i]);
+
+            if (mismatch(f, "decode_batch_sorted_unique", values[i], value_string(values[i]), actual)
+                || mismatch(f, "decode_batch_sorted_unique count", values[i], value_string(unique.size()),
+                            value_string(n)))
+            {
+                return true;
+            }
+        }
+
+        // Ranges increment digits instead of converting values
+        auto start = values[0];
+        std::size_t count = start > UINT64_MAX - 39 ? static_cast<std::size_t>(UINT64_MAX - start + 1) : 40;
+        chars.assign(count * encoder.max_encoded_length(), 0);
+        offsets.assign(count + 1, 0);
+        encoder.encode_range(start, count, chars.data(), chars.size(), offsets.data());
+
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            std::string actual(chars.data() + offsets[i], chars.data() + offsets[i + 1]);
+
+            if (mismatch(f, "encode_range", start + i,
+                         reference::encode(start + i, c.alphabet, c.permutation, c.min_length, c.schedule), actual))
+            {
+                return true;
+            }
+        }
+
+        // Fixed length records of the largest value's length
+        fixed_length_encoder fixed(encoder, *std::max_element(values.begin(), values.end()));
+        auto width = fixed.length();
+        std::string records(values.size() * width, '\0');
+        fixed.encode_batch(values.data(), values.size(), &records[0], records.size());
+
+        for (std::size_t i = 0; i < values.size(); ++i)
+        {
+            auto want = reference::encode(values[i], c.alphabet, c.permutation, static_cast<int>(width), c.schedule);
+
+            if (mismatch(f, "fixed_length encode_batch", values[i], want, records.substr(i * width, width)))
+            {
+                return true;
+            }
+        }
+
+        fixed.decode_batch(records.data(), values.size(), decoded.data(), errors.data());
+
+        for (std::size_t i = 0; i < values.size(); ++i)
+        {
+            if (mismatch(f, "fixed_length decode_batch", values[i], value_string(values[i]),
+                         errors[i] == error::none ? value_string(decoded[i]) : error_message(errors[i])))
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool check_feistel(const fuzz_case& c, failure& f)
+    {
+        schrott_id_encoder encoder(c.alphabet, base64::encode(c.permutation), c.min_length, algorithm::feistel);
+        auto& values = c.values;
+
+        std::vector<char> chars(values.size() * encoder.max_encoded_length());
+        std::vector<std::size_t> offsets(values.size() + 1);
+        encoder.encode_batch(values.data(), values.size(), chars.data(), chars.size(), offsets.data());
+
+        std::vector<std::uint64_t> decoded(values.size());
+        std::vector<error> errors(values.size());
+        encoder.decode_batch(chars.data(), offsets.data(), values.size(), decoded.data(), errors.data());
+
+        for (std::size_t i = 0; i < values.size(); ++i)
+        {
+            auto single = encoder.encode(values[i]);
+            std::string batch(chars.data() + offsets[i], chars.data() + offsets[i + 1]);
+
+            if (mismatch(f, "feistel encode_batch", values[i], single, batch)
+                || mismatch(f, "feistel decode_batch", values[i], value_string(values[i]),
+                            errors[i] == error::none ? value_string(decoded[i]) : error_message(errors[i])))
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    bool check(const fuzz_case& c, failure& f)
+    {
+        return check_cascade(c, f) || check_feistel(c, f);
+    }
+
+    std::string quote(const std::string& s)
+    {
+        std::ostringstream out;
+        out << '"';
+
+        for (auto ch: s)
+        {
+            auto b = static_cast<byte>(ch);
+
+            if (b >= 0x20 && b < 0x7F && ch != '"' && ch != '\\' && ch != '?')
+            {
+                out << ch;
+            }
+            else
+            {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\%03o", b);
+                out << escaped;
+            }
+        }
+
+        out << '"';
+        return out.str();
+    }
+
+    void report(const fuzz_case& c, const failure& f)
+    {
+        std::cerr << "Mismatch in " << f.path << " for value " << f.value << "\n"
+                  << "  expected " << quote(f.expected) << "\n"
+                  << "  actual   " << quote(f.actual) << "\n\n"
+                  << "Reproducer:\n"
+                  << "  round_schedule schedule;\n"
+                  << "  schedule.per_digit = " << c.schedule.per_digit << ";\n"
+                  << "  schedule.fixed = " << c.schedule.fixed << ";\n"
+                  << "  schrott_id_encoder encoder(std::string(" << quote(c.alphabet) << ", " << c.alphabet.size()
+                  << "),\n"
+                  << "                             \"" << base64::encode(c.permutation) << "\", " << c.min_length
+                  << ", schedule);\n"
+                  << "  values = {";
+
+        for (std::size_t i = 0; i < c.values.size(); ++i)
+        {
+            std::cerr << (i ? ", " : "") << c.values[i] << "u";
+        }
+
+        std::cerr << "};\n";
+    }
+
+    // Shrinks a failing case by dropping values, lowering the minimum length and clearing value bits,
+    // as long as it keeps failing
+    fuzz_case minimize(fuzz_case c)
+    {
+        failure f;
+
+        for (auto changed = true; changed;)
+        {
+            changed = false;
+
+            for (std::size_t i = 0; c.values.size() > 1 && i < c.values.size(); ++i)
+            {
+                auto smaller = c;
+                smaller.values.erase(smaller.values.begin() + i);
+
+                if (check(smaller, f))
+                {
+                    c = smaller;
+                    changed = true;
+                    --i;
+                }
+            }
+
+            while (c.min_length > 1)
+            {
+                auto smaller = c;
+                --smaller.min_length;
+
+                if (!check(smaller, f))
+                {
+                    break;
+                }
+
+                c = smaller;
+                changed = true;
+            }
+
+            for (auto& value: c.values)
+            {
+                for (auto bit = 64; bit-- > 0;)
+                {
+                    auto smaller = c;
+                    auto& v = smaller.values[&value - &c.values[0]];
+
+                    if (!(v >> bit & 1))
+                    {
+                        continue;
+                    }
+
+                    v &= ~(std::uint64_t{1} << bit);
+
+                    if (check(smaller, f))
+                    {
+                        c = smaller;
+                        changed = true;
+                    }
+                }
+            }
+        }
+
+        return c;
+    }
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const std::uint8_t* data, std::size_t size)
+{
+    auto c = parse(data, size);
+    failure f;
+
+    if (check(c, f))
+    {
+        report(c, f);
+        std::abort();
+    }
+
+    return 0;
+}
+
+#ifndef SCHROTT_ID_LIBFUZZER
+
+int main(int argc, char** argv)
+{
+    std::uint64_t seed = std::random_device()();
+    std::uint64_t iterations = 10000;
+
+    for (auto i = 1; i + 1 < argc; i += 2)
+    {
+        if (std::strcmp(argv[i], "--seed") == 0)
+        {
+            seed = std::strtoull(argv[i + 1], nullptr, 10);
+        }
+        else if (std::strcmp(argv[i], "--iterations") == 0)
+        {
+            iterations = std::strtoull(argv[i + 1], nullptr, 10);
+        }
+    }
+
+    std::mt19937_64 random(seed);
+    std::uniform_int_distribution<std::size_t> sizes(0, 600);
+    std::vector<std::uint8_t> data;
+
+    for (std::uint64_t iteration = 0; iteration < iterations; ++iteration)
+    {
+        data.resize(sizes(random));
+        for (auto& b: data)
+        {
+            b = static_cast<std::uint8_t>(random());
+        }
+
+        auto c = parse(data.data(), data.size());
+        failure f;
+
+        if (check(c, f))
+        {
+            std::cerr << "Seed " << seed << ", iteration " << iteration << "\n";
+
+            c = minimize(c);
+            check(c, f);
+            report(c, f);
+
+            return 1;
+        }
+    }
+
+    std::cout << iterations << " cases passed, seed " << seed << "\n";
+
+    return 0;
+}
+
+#endif
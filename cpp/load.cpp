@@ -0,0 +1,313 @@
+/**
+ * Measures throughput and tail latency of SchrottID encoders under concurrent load
+ *
+ * Runs 1, 2, 4, ... up to the given number of threads, each mixing encodes and decodes, either on one shared
+ * encoder or on a copy per thread. Threads run in closed loop, or at a fixed rate per thread, in which case
+ * latency counts from the time an operation was due, so a stalled thread does not hide its backlog.
+ * Scaling efficiency is the throughput per thread relative to a single thread.
+ *
+ * Usage: schrott_id_load [options]
+ *   --threads <n>          Most threads, the number of cores by default
+ *   --copies               Give every thread its own copy of the encoder instead of sharing one
+ *   --decode-share <f>     Share of operations that decode, 0.5 by default
+ *   --rate <n>             Operations per second and thread, 0 (closed loop) by default
+ *   --seconds <f>          Duration per thread count, 1 by default
+ *   --length <n>           ID length, 8 by default
+ *   --buffers              Use encode_to and try_decode instead of the std::string functions
+ *
+ * https://github.com/lorisleitner/schrott-id
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <thread>
+
+#include "schrott_id.hpp"
+#include "schrott_id_metrics.hpp"
+
+using namespace schrott_id;
+
+namespace
+{
+    const char* const kPermutation =
+            "HwEMFAcAMAYEPxc4Dy4RAxAkEgstJggbGSMiKB0yHgk7OSsNMxoYKRMWNg49LzEFFTQKPDUhHAIsICclOio+Nw==";
+
+    const std::size_t kPool = 4096;
+
+    volatile std::uint64_t sink;
+
+    struct options
+    {
+        unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+        bool copies = false;
+        double decode_share = 0.5;
+        double rate = 0;
+        double seconds = 1;
+        std::size_t length = 8;
+        bool buffers = false;
+    };
+
+    struct thread_result
+    {
+        std::uint64_t operations = 0;
+        metrics::histogram latency = {};
+    };
+
+    struct run_result
+    {
+        double throughput;
+        metrics::histogram latency;
+    };
+
+    // Control shared by the threads of a run: they start together and stop when told
+    struct run_control
+    {
+        std::atomic<unsigned> ready{0};
+        std::atomic<bool> go{false};
+        std::atomic<bool> stop{false};
+    };
+
+    void work(const schrott_id_encoder& shared, const options& opts, unsigned seed, run_control& control,
+              thread_result& out)
+    {
+        // Copies are made on the thread that uses them, so their memory is local to it
+        std::unique_ptr<schrott_id_encoder> copy(opts.copies ? new schrott_id_encoder(shared) : nullptr);
+        const auto& encoder = copy ? *copy : shared;
+
+        std::mt19937_64 random(seed);
+        std::uint64_t limit = 1;
+        for (std::size_t i = 0; i + 1 < opts.length && limit <= UINT64_MAX / encoder.alphabet().size(); ++i)
+        {
+            limit *= encoder.alphabet().size();
+        }
+
+        std::uniform_int_distribution<std::uint64_t> values(0, limit - 1);
+        std::bernoulli_distribution decodes(opts.decode_share);
+
+        std::vector<std::uint64_t> pool(kPool);
+        std::vector<std::string> ids(kPool);
+        std::vector<bool> kinds(kPool);
+
+        for (std::size_t i = 0; i < kPool; ++i)
+        {
+            pool[i] = values(random);
+            ids[i] = encoder.encode(pool[i]);
+            kinds[i] = decodes(random);
+        }
+
+        char buf[128];
+        const auto interval = opts.rate > 0
+                              ? std::chrono::nanoseconds(static_cast<std::int64_t>(1e9 / opts.rate))
+                              : std::chrono::nanoseconds(0);
+
+        control.ready.fetch_add(1);
+        while (!control.go.load(std::memory_order_acquire))
+        {
+            std::this_thread::yield();
+        }
+
+        // Counted locally so threads do not share cache lines while running
+        thread_result result;
+        auto due = std::chrono::steady_clock::now();
+        std::uint64_t total = 0;
+
+        for (std::size_t i = 0; !control.stop.load(std::memory_order_relaxed); i = (i + 1) % kPool)
+        {
+            auto start = std::chrono::steady_clock::now();
+
+            if (opts.rate > 0)
+            {
+                due += interval;
+
+                if (due > start)
+                {
+                    std::this_thread::sleep_until(due);
+                }
+
+                start = due;
+            }
+
+            if (kinds[i])
+            {
+                if (opts.buffers)
+                {
+                    std::uint64_t value;
+                    encoder.try_decode(ids[i].data(), ids[i].size(), value);
+                    total += value;
+                }
+                else
+                {
+                    total += encoder.decode(ids[i]);
+                }
+            }
+            else
+            {
+                total += opts.buffers
+                         ? encoder.encode_to(pool[i], buf, sizeof(buf))
+                         : encoder.encode(pool[i]).size();
+            }
+
+            auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - start).count();
+
+            ++result.latency.buckets[metrics::bucket(static_cast<std::uint64_t>(std::max<std::int64_t>(ns, 0)))];
+            ++result.operations;
+        }
+
+        sink = total;
+        out = result;
+    }
+
+    // Doubles the threads, ending with the most threads even if that is no power of two
+    unsigned next_thread_count(unsigned threads, unsigned most)
+    {
+        return threads < most && threads * 2 > most ? most : threads * 2;
+    }
+
+    run_result run(const schrott_id_encoder& encoder, const options& opts, unsigned threads)
+    {
+        run_control control;
+        std::vector<thread_result> results(threads);
+        std::vector<std::thread> workers;
+
+        for (unsigned t = 0; t < threads; ++t)
+        {
+            workers.emplace_back(work, std::cref(encoder), std::cref(opts), t + 1, std::ref(control),
+                                 std::ref(results[t]));
+        }
+
+        while (control.ready.load() < threads)
+        {
+            std::this_thread::yield();
+        }
+
+        auto start = std::chrono::steady_clock::now();
+        control.go.store(true, std::memory_order_release);
+
+        std::this_thread::sleep_for(std::chrono::duration<double>(opts.seconds));
+        control.stop.store(true);
+
+        for (auto& worker: workers)
+        {
+            worker.join();
+        }
+
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+        run_result merged = {0, {}};
+        std::uint64_t operations = 0;
+
+        for (auto& result: results)
+        {
+            operations += result.operations;
+
+            for (std::size_t i = 0; i < metrics::kBuckets; ++i)
+            {
+                merged.latency.buckets[i] += result.latency.buckets[i];
+            }
+        }
+
+        merged.throughput = operations / elapsed.count();
+
+        return merged;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    options opts;
+
+    for (auto i = 1; i < argc; ++i)
+    {
+        const char* option = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : "";
+
+        if (std::strcmp(option, "--copies") == 0)
+        {
+            opts.copies = true;
+        }
+        else if (std::strcmp(option, "--buffers") == 0)
+        {
+            opts.buffers = true;
+        }
+        else if (std::strcmp(option, "--threads") == 0)
+        {
+            opts.threads = std::max(1, std::atoi(value));
+            ++i;
+        }
+        else if (std::strcmp(option, "--decode-share") == 0)
+        {
+            opts.decode_share = std::atof(value);
+            ++i;
+        }
+        else if (std::strcmp(option, "--rate") == 0)
+        {
+            opts.rate = std::atof(value);
+            ++i;
+        }
+        else if (std::strcmp(option, "--seconds") == 0)
+        {
+            opts.seconds = std::atof(value);
+            ++i;
+        }
+        else if (std::strcmp(option, "--length") == 0)
+        {
+            opts.length = std::strtoul(value, nullptr, 10);
+            ++i;
+        }
+        else
+        {
+            std::cerr << "Unknown option " << option << '\n';
+            return 2;
+        }
+    }
+
+    schrott_id_encoder encoder(alphabets::base64, kPermutation, static_cast<int>(opts.length));
+
+    std::cout << "Base64, IDs of length " << opts.length << ", " << opts.decode_share * 100 << "% decodes, "
+              << (opts.copies ? "encoder per thread" : "shared encoder") << ", "
+              << (opts.buffers ? "caller buffers" : "std::string") << ", ";
+
+    if (opts.rate > 0)
+    {
+        std::cout << opts.rate << " operations per second and thread\n\n";
+    }
+    else
+    {
+        std::cout << "closed loop\n\n";
+    }
+
+    std::cout << "threads     ops/s   per thread  efficiency    p50 ns    p99 ns  p99.9 ns\n";
+
+    double single = 0;
+
+    for (unsigned threads = 1; threads <= opts.threads; threads = next_thread_count(threads, opts.threads))
+    {
+        auto result = run(encoder, opts, threads);
+        auto per_thread = result.throughput / threads;
+
+        if (threads == 1)
+        {
+            single = per_thread;
+        }
+
+        std::cout << std::setw(7) << threads
+                  << std::fixed << std::setprecision(0)
+                  << std::setw(10) << result.throughput
+                  << std::setw(13) << per_thread
+                  << std::setprecision(2)
+                  << std::setw(12) << per_thread / single
+                  << std::setw(10) << result.latency.percentile(0.5)
+                  << std::setw(10) << result.latency.percentile(0.99)
+                  << std::setw(10) << result.latency.percentile(0.999) << '\n';
+    }
+
+    return 0;
+}
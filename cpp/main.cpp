@@ -2,7 +2,21 @@
 
 #include "lib/catch2.hpp"
 
+#include <cstdio>
+#include <list>
+#include <numeric>
+#include <random>
+#include <unordered_set>
+#include <thread>
+
+#include "benchmark_compare.hpp"
 #include "schrott_id.hpp"
+#include "schrott_id_cache.hpp"
+#include "schrott_id_ff1.hpp"
+#include "schrott_id_generator.hpp"
+#include "schrott_id_json.hpp"
+#include "schrott_id_views.hpp"
+#include "schrott_id_c.h"
 
 using namespace Catch;
 using namespace schrott_id;
@@ -55,6 +69,496 @@ TEST_CASE("Test encode decode control")
     REQUIRE(std::equal(control_lines.begin(), control_lines.end(), schrott_ids.begin()));
 }
 
+std::vector<std::string> read_control(const std::string& path)
+{
+    std::ifstream control_file(path);
+    REQUIRE_FALSE(control_file.fail());
+
+    std::string line;
+    std::vector<std::string> control_lines;
+    control_lines.reserve(10000);
+
+    while (std::getline(control_file, line))
+    {
+        if (!line.empty()
+            && line.find('#') != 0)
+        {
+            control_lines.emplace_back(std::move(line));
+        }
+    }
+
+    return control_lines;
+}
+
+std::vector<std::string> encode_control(const schrott_id_encoder& schrott_id)
+{
+    std::vector<std::string> schrott_ids;
+    schrott_ids.reserve(10000);
+
+    for (auto i = 0; i < 10000; ++i)
+    {
+        schrott_ids.emplace_back(schrott_id.encode(i));
+    }
+
+    return schrott_ids;
+}
+
+TEST_CASE("Round schedule control")
+{
+    // Control files of the other round schedules are written by schrott_id_control
+
+    auto r1l = read_control("../../test/control_v3-r1L.txt");
+    auto r8 = read_control("../../test/control_v3-r8.txt");
+
+    schrott_id_encoder per_length(alphabets::base64, test_permutation, 3, round_schedule::per_length(1));
+    schrott_id_encoder constant(alphabets::base64, test_permutation, 3, round_schedule::constant(8));
+
+    REQUIRE(r1l == encode_control(per_length));
+    REQUIRE(r8 == encode_control(constant));
+
+    // Schedules are versions of their own, their IDs are unrelated to v3 IDs of the same value
+    auto v3 = read_control("../../test/control.txt");
+    auto same = 0;
+    for (auto i = 0; i < 10000; ++i)
+    {
+        same += r1l[i] == v3[i];
+    }
+    REQUIRE(same < 10);
+}
+
+TEST_CASE("Round schedule encode and decode")
+{
+    const round_schedule schedules[] = {
+            round_schedule::per_length(1),
+            round_schedule::per_length(2),
+            round_schedule::constant(1),
+            round_schedule::constant(7),
+    };
+
+    std::mt19937_64 random(7);
+
+    for (auto& schedule: schedules)
+    {
+        schrott_id_encoder schrott_id(alphabets::base58, schrott_id_encoder::generate_permutation(alphabets::base58),
+                                      1, schedule);
+
+        std::vector<std::uint64_t> values(200);
+        for (std::size_t i = 0; i < values.size(); ++i)
+        {
+            values[i] = i < 100 ? i : random() >> (random() % 64);
+        }
+
+        std::vector<char> chars(values.size() * schrott_id.max_encoded_length());
+        std::vector<std::size_t> offsets(values.size() + 1);
+        REQUIRE(schrott_id.encode_batch(values.data(), values.size(), chars.data(), chars.size(), offsets.data())
+                == error::none);
+
+        std::vector<std::uint64_t> decoded(values.size());
+        std::vector<error> errors(values.size());
+        REQUIRE(schrott_id.decode_batch(chars.data(), offsets.data(), values.size(), decoded.data(), errors.data())
+                == 0);
+
+        for (std::size_t i = 0; i < values.size(); ++i)
+        {
+            auto id = schrott_id.encode(values[i]);
+
+            REQUIRE(id == std::string(chars.data() + offsets[i], offsets[i + 1] - offsets[i]));
+            REQUIRE(schrott_id.decode(id) == values[i]);
+            REQUIRE(decoded[i] == values[i]);
+        }
+    }
+}
+
+TEST_CASE("Round schedule empty and single character IDs")
+{
+    // Constant schedules run rounds whatever the length, empty IDs have no digits to run them on
+    schrott_id_encoder schrott_id(alphabets::base64, test_permutation, 3, round_schedule::constant(8));
+    schrott_id_encoder single(alphabets::base64, test_permutation, 1, round_schedule::constant(8));
+
+    std::uint64_t value = 42;
+    REQUIRE(schrott_id.try_decode("", 0, value) == error::none);
+    REQUIRE(value == 0);
+    REQUIRE(schrott_id.decode("") == 0);
+    REQUIRE(schrott_id.encode_bytes(std::vector<byte>()).empty());
+    REQUIRE(schrott_id.decode_bytes("").empty());
+
+    const std::size_t offsets[] = {0, 0, 1};
+    std::uint64_t decoded[2];
+    error errors[2];
+    REQUIRE(single.decode_batch("A", offsets, 2, decoded, errors) == 0);
+    REQUIRE(decoded[0] == 0);
+
+    for (std::uint64_t i = 0; i < 64; ++i)
+    {
+        auto id = single.encode(i);
+
+        REQUIRE(id.size() == 1);
+        REQUIRE(single.decode(id) == i);
+    }
+
+    schrott_id_handle* handle = nullptr;
+    REQUIRE(schrott_id_create_with_rounds(alphabets::base64, 64, test_permutation, 3, 0, 8, &handle)
+            == SCHROTT_ID_OK);
+    REQUIRE(schrott_id_decode(handle, "", 0, &value) == SCHROTT_ID_OK);
+    REQUIRE(value == 0);
+    schrott_id_destroy(handle);
+}
+
+TEST_CASE("Round schedule version")
+{
+    REQUIRE(round_schedule::v3().version() == "v3");
+    REQUIRE(round_schedule::per_length(1).version() == "v3-r1L");
+    REQUIRE(round_schedule::constant(8).version() == "v3-r8");
+
+    round_schedule mixed;
+    mixed.per_digit = 2;
+    mixed.fixed = 4;
+    REQUIRE(mixed.version() == "v3-r2L+4");
+    REQUIRE(mixed.rounds(5) == 14);
+
+    REQUIRE_THROWS_AS(schrott_id_encoder(alphabets::base64, test_permutation, 3, round_schedule::constant(0)),
+                      std::invalid_argument);
+}
+
+TEST_CASE("Feistel control")
+{
+    auto control_lines = read_control("../../test/control_v3-feistel.txt");
+
+    schrott_id_encoder schrott_id(alphabets::base64, test_permutation, 3, algorithm::feistel);
+
+    REQUIRE(schrott_id.version() == "v3-feistel");
+    REQUIRE(control_lines == encode_control(schrott_id));
+}
+
+TEST_CASE("Feistel encode and decode 64-bit range")
+{
+    const char* alphabets[] = {"01", "0123456789", alphabets::base58, alphabets::base64};
+    std::mt19937_64 random(13);
+
+    for (auto alphabet: alphabets)
+    {
+        for (auto min_length: {1, 5, 80})
+        {
+            schrott_id_encoder cascade(alphabet, schrott_id_encoder::generate_permutation(alphabet), min_length);
+            schrott_id_encoder feistel(alphabet, cascade.permutation(), min_length, algorithm::feistel);
+
+            // Every bit width, both ends of it and random values in between
+            std::vector<std::uint64_t> values = {0, 1, UINT64_MAX, UINT64_MAX - 1};
+            for (auto bits = 1; bits < 64; ++bits)
+            {
+                auto top = std::uint64_t{1} << bits;
+                values.push_back(top - 1);
+                values.push_back(top);
+                values.push_back(top | (random() & (top - 1)));
+            }
+
+            for (auto value: values)
+            {
+                auto id = feistel.encode(value);
+
+                REQUIRE(id.size() == cascade.encode(value).size());
+                REQUIRE(feistel.decode(id) == value);
+            }
+
+            std::vector<char> chars(values.size() * feistel.max_encoded_length());
+            std::vector<std::size_t> offsets(values.size() + 1);
+            REQUIRE(feistel.encode_batch(values.data(), values.size(), chars.data(), chars.size(), offsets.data())
+                    == error::none);
+
+            std::vector<std::uint64_t> decoded(values.size());
+            REQUIRE(feistel.decode_batch(chars.data(), offsets.data(), values.size(), decoded.data(), nullptr) == 0);
+            REQUIRE(decoded == values);
+        }
+    }
+}
+
+TEST_CASE("Feistel is a bijection per length")
+{
+    // Values 0 to 9999 all take 4 digits, so their IDs must be all 10000 strings of 4 digits
+    schrott_id_encoder schrott_id("0123456789", schrott_id_encoder::generate_permutation("0123456789"), 4,
+                                  algorithm::feistel);
+
+    std::unordered_set<std::string> ids;
+    for (std::uint64_t i = 0; i < 10000; ++i)
+    {
+        ids.insert(schrott_id.encode(i));
+    }
+
+    REQUIRE(ids.size() == 10000);
+
+    std::vector<char> chars(1000 * schrott_id.max_encoded_length());
+    std::vector<std::size_t> offsets(1001);
+    REQUIRE(schrott_id.encode_range(9500, 1000, chars.data(), chars.size(), offsets.data()) == error::none);
+
+    for (std::size_t i = 0; i < 1000; ++i)
+    {
+        REQUIRE(std::string(chars.data() + offsets[i], offsets[i + 1] - offsets[i]) == schrott_id.encode(9500 + i));
+    }
+}
+
+TEST_CASE("Feistel permutes domains beyond 64 bits")
+{
+    // 24 hex digits hold 96 bits, so IDs must use all of them, not only the 16 digits of a 64-bit value
+    schrott_id_encoder schrott_id("0123456789abcdef", schrott_id_encoder::generate_permutation("0123456789abcdef"), 24,
+                                  algorithm::feistel);
+
+    std::mt19937_64 random(17);
+    std::unordered_set<char> leading;
+    std::size_t overflows = 0;
+
+    for (auto i = 0; i < 1000; ++i)
+    {
+        auto value = i < 500 ? static_cast<std::uint64_t>(i) : random();
+        auto id = schrott_id.encode(value);
+
+        REQUIRE(id.size() == 24);
+        REQUIRE(schrott_id.decode(id) == value);
+        leading.insert(id[0]);
+
+        // Only one in 2^32 IDs of 24 digits belongs to a 64-bit value
+        std::string forged(24, '0');
+        for (auto& c: forged)
+        {
+            c = "0123456789abcdef"[random() % 16];
+        }
+
+        std::uint64_t decoded;
+        auto e = schrott_id.try_decode(forged.data(), forged.size(), decoded);
+        overflows += e == error::range_overflow;
+
+        if (e == error::none)
+        {
+            REQUIRE(schrott_id.encode(decoded) == forged);
+        }
+    }
+
+    REQUIRE(leading.size() == 16);
+    REQUIRE(overflows == 1000);
+
+    // IDs longer than the encoder produces decode in their own domain
+    auto longer = std::string(30, '7');
+    std::uint64_t decoded;
+    REQUIRE(schrott_id.try_decode(longer.data(), longer.size(), decoded) == error::range_overflow);
+}
+
+TEST_CASE("Feistel limits")
+{
+    schrott_id_encoder schrott_id(alphabets::base64, test_permutation, 3, algorithm::feistel);
+
+    // 11 characters can hold values beyond 64 bits, which no 64-bit value encodes to
+    std::uint64_t value;
+    REQUIRE(schrott_id.try_decode("///////////", 11, value) == error::range_overflow);
+    REQUIRE_THROWS_WITH(schrott_id.decode("///////////"), Contains("Value exceeds the supported range"));
+    REQUIRE_THROWS_WITH(schrott_id.decode("$%&"), Contains("Character not in alphabet"));
+
+    std::uint64_t wide[] = {1, 1};
+    REQUIRE_THROWS_AS(schrott_id.encode_words(wide, 2), std::invalid_argument);
+    REQUIRE_THROWS_AS(schrott_id.encode_bytes({1, 2, 3}), std::invalid_argument);
+
+    std::uint64_t narrow[] = {420, 0};
+    auto id = schrott_id.encode_words(narrow, 2);
+    REQUIRE(id == schrott_id.encode(420));
+
+    std::uint64_t words[2];
+    REQUIRE(schrott_id.decode_words(id.data(), id.size(), words, 2) == error::none);
+    REQUIRE(words[0] == 420);
+    REQUIRE(words[1] == 0);
+
+    prefixed_encoder prefixed(schrott_id, "ord_", true);
+    REQUIRE(prefixed.encoder().algorithm() == algorithm::feistel);
+    REQUIRE(prefixed.decode(prefixed.encode(420)) == 420);
+}
+
+std::vector<byte> from_hex(const std::string& hex)
+{
+    std::vector<byte> bytes;
+
+    for (std::size_t i = 0; i < hex.size(); i += 2)
+    {
+        bytes.push_back(static_cast<byte>(std::stoul(hex.substr(i, 2), nullptr, 16)));
+    }
+
+    return bytes;
+}
+
+TEST_CASE("AES known answers")
+{
+    // FIPS-197 appendix C
+    auto plaintext = from_hex("00112233445566778899aabbccddeeff");
+
+    struct vector
+    {
+        const char* key;
+        const char* ciphertext;
+    };
+
+    const vector vectors[] = {
+            {"000102030405060708090a0b0c0d0e0f", "69c4e0d86a7b0430d8cdb78070b4c55a"},
+            {"000102030405060708090a0b0c0d0e0f1011121314151617", "dda97ca4864cdfe06eaf70a0ec0d7191"},
+            {"000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f", "8ea2b7ca516745bfeafc49904b496089"},
+    };
+
+    for (auto& v: vectors)
+    {
+        for (auto hardware: {false, true})
+        {
+            auto key = from_hex(v.key);
+            schrott_id::detail::aes cipher(key.data(), key.size(), hardware);
+
+            // Nine blocks go through both the pipelined and the single block path
+            std::vector<byte> blocks;
+            for (auto i = 0; i < 9; ++i)
+            {
+                blocks.insert(blocks.end(), plaintext.begin(), plaintext.end());
+            }
+
+            cipher.encrypt(blocks.data(), 9);
+
+            for (auto i = 0; i < 9; ++i)
+            {
+                REQUIRE(std::vector<byte>(blocks.begin() + 16 * i, blocks.begin() + 16 * i + 16)
+                        == from_hex(v.ciphertext));
+            }
+        }
+    }
+
+    byte key[15] = {};
+    REQUIRE_THROWS_AS(schrott_id::detail::aes(key, sizeof(key)), std::invalid_argument);
+}
+
+TEST_CASE("FF1 known answers")
+{
+    // NIST SP 800-38G samples 1 to 9
+    struct vector
+    {
+        const char* key;
+        const char* alphabet;
+        const char* tweak;
+        const char* plaintext;
+        const char* ciphertext;
+    };
+
+    const char* k128 = "2B7E151628AED2A6ABF7158809CF4F3C";
+    const char* k192 = "2B7E151628AED2A6ABF7158809CF4F3CEF4359D8D580AA4F";
+    const char* k256 = "2B7E151628AED2A6ABF7158809CF4F3CEF4359D8D580AA4F7F036D6F04FC6A94";
+    const char* digits = "0123456789";
+    const char* base36 = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+    const vector vectors[] = {
+            {k128, digits, "", "0123456789", "2433477484"},
+            {k128, digits, "39383736353433323130", "0123456789", "6124200773"},
+            {k128, base36, "3737373770717273373737", "0123456789abcdefghi", "a9tv40mll9kdu509eum"},
+            {k192, digits, "", "0123456789", "2830668132"},
+            {k192, digits, "39383736353433323130", "0123456789", "2496655549"},
+            {k192, base36, "3737373770717273373737", "0123456789abcdefghi", "xbj3kv35jrawxv32ysr"},
+            {k256, digits, "", "0123456789", "6657667009"},
+            {k256, digits, "39383736353433323130", "0123456789", "1001623463"},
+            {k256, base36, "3737373770717273373737", "0123456789abcdefghi", "xs8a0azh2avyalyzuwd"},
+    };
+
+    for (auto& v: vectors)
+    {
+        for (auto hardware: {false, true})
+        {
+            ff1_encoder ff1(v.alphabet, from_hex(v.key), 1, from_hex(v.tweak), hardware);
+
+            REQUIRE(ff1.encrypt(v.plaintext) == v.ciphertext);
+            REQUIRE(ff1.decrypt(v.ciphertext) == v.plaintext);
+        }
+    }
+}
+
+TEST_CASE("FF1 control")
+{
+    auto control_lines = read_control("../../test/control_ff1-aes128.txt");
+
+    ff1_encoder ff1(alphabets::base64, from_hex("2B7E151628AED2A6ABF7158809CF4F3C"), 3);
+
+    REQUIRE(ff1.version() == "ff1-aes128");
+    REQUIRE(ff1.min_length() == 4);
+
+    std::vector<std::string> ids;
+    for (auto i = 0; i < 10000; ++i)
+    {
+        ids.emplace_back(ff1.encode(i));
+    }
+
+    REQUIRE(control_lines == ids);
+}
+
+TEST_CASE("FF1 encode and decode")
+{
+    std::mt19937_64 random(17);
+    auto key = from_hex("000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f");
+
+    for (auto alphabet: {"01", alphabets::base58, alphabets::base64})
+    {
+        for (auto hardware: {false, true})
+        {
+            ff1_encoder ff1(alphabet, key, 1, std::vector<byte>(), hardware);
+            schrott_id_encoder v3(alphabet, schrott_id_encoder::generate_permutation(alphabet), ff1.min_length());
+
+            std::vector<std::uint64_t> values = {0, 1, UINT64_MAX};
+            for (auto i = 0; i < 100; ++i)
+            {
+                values.push_back(random() >> (random() % 64));
+            }
+
+            std::vector<char> chars(values.size() * ff1.max_encoded_length());
+            std::vector<std::size_t> offsets(values.size() + 1);
+            REQUIRE(ff1.encode_batch(values.data(), values.size(), chars.data(), chars.size(), offsets.data())
+                    == error::none);
+
+            std::vector<std::uint64_t> decoded(values.size());
+            REQUIRE(ff1.decode_batch(chars.data(), offsets.data(), values.size(), decoded.data(), nullptr) == 0);
+            REQUIRE(decoded == values);
+
+            for (std::size_t i = 0; i < values.size(); ++i)
+            {
+                auto id = ff1.encode(values[i]);
+
+                REQUIRE(id.size() == v3.encoded_length(values[i]));
+                REQUIRE(id == std::string(chars.data() + offsets[i], offsets[i + 1] - offsets[i]));
+                REQUIRE(ff1.decode(id) == values[i]);
+            }
+        }
+    }
+}
+
+TEST_CASE("FF1 invalid")
+{
+    auto key = from_hex("2B7E151628AED2A6ABF7158809CF4F3C");
+    ff1_encoder ff1(alphabets::base64, key, 3);
+
+    std::uint64_t value;
+    REQUIRE(ff1.try_decode("abc", 3, value) == error::invalid_length);
+    REQUIRE(ff1.try_decode("ab.d", 4, value) == error::invalid_character);
+    REQUIRE_THROWS_AS(ff1.decode("abc"), std::out_of_range);
+
+    // 11 characters decrypt to values of up to 66 bits, about three in four do not fit into 64 bits
+    auto overflows = 0;
+    for (auto c: std::string(alphabets::base64))
+    {
+        std::string id(11, c);
+        overflows += ff1.try_decode(id.data(), id.size(), value) == error::range_overflow;
+    }
+    REQUIRE(overflows > 16);
+
+    const char chars[] = "abcdab.dABCD";
+    std::size_t offsets[] = {0, 3, 8, 12};
+    std::uint64_t values[3];
+    error errors[3];
+    REQUIRE(ff1.decode_batch(chars, offsets, 3, values, errors) == 2);
+    REQUIRE(errors[0] == error::invalid_length);
+    REQUIRE(errors[1] == error::invalid_character);
+    REQUIRE(errors[2] == error::none);
+
+    REQUIRE_THROWS_AS(ff1_encoder(alphabets::base64, std::vector<byte>(20), 3), std::invalid_argument);
+    REQUIRE_THROWS_AS(ff1_encoder(alphabets::base64, key, 129), std::invalid_argument);
+    REQUIRE_THROWS_AS(ff1_encoder(alphabets::base64, key, 3, std::vector<byte>(257)), std::invalid_argument);
+    REQUIRE_THROWS_AS(ff1.encrypt("abc"), std::invalid_argument);
+}
+
 TEST_CASE("Generate permutation")
 {
     // This test depends on randomness, loop 1000 times to make sure we cover as many cases as possible
@@ -142,9 +646,1363 @@ TEST_CASE("Permutation invalid indices")
                         Contains("Invalid indices for used alphabet"));
 }
 
+TEST_CASE("Create returns errors")
+{
+    REQUIRE(schrott_id_encoder::create(std::string(257, 'A'), test_permutation, 3).error()
+            == error::invalid_alphabet_size);
+    REQUIRE(schrott_id_encoder::create("ABC", "√∫¥", 3).error() == error::invalid_base64);
+    REQUIRE(schrott_id_encoder::create(alphabets::base32, "QUFBQUFBQUFBQUFBQUFBQUFBQUFBQUFBQUFBQUFBQUE=", 3).error()
+            == error::duplicate_position);
+    REQUIRE_THROWS_WITH(schrott_id_encoder::create("ABC", test_permutation, -1).value(),
+                        Contains("min_length must be greater than 0"));
+
+    auto created = schrott_id_encoder::create(alphabets::base64, test_permutation, 3);
+    REQUIRE(created.has_value());
+    REQUIRE(created->encode(0) == schrott_id_encoder(alphabets::base64, test_permutation, 3).encode(0));
+}
+
+TEST_CASE("Generate permutation with a random source")
+{
+    std::mt19937_64 random(1);
+
+    for (auto alphabet: {alphabets::base32, alphabets::base58, alphabets::base64})
+    {
+        auto permutation = schrott_id_encoder::generate_permutation(alphabet, random);
+        REQUIRE(schrott_id_encoder::create(alphabet, permutation, 3).has_value());
+    }
+}
+
 TEST_CASE("Decode invalid")
 {
     auto s_id = schrott_id_encoder(alphabets::base64, test_permutation, 3);
 
     REQUIRE_THROWS_WITH(s_id.decode("$%&"), Contains("Character not in alphabet"));
-}
\ No newline at end of file
+}
+
+TEST_CASE("Encoded length matches reference")
+{
+    const char* alphabets[] = {alphabets::base64, alphabets::base58, alphabets::base36, alphabets::base32, "01"};
+
+    for (auto alphabet: alphabets)
+    {
+        auto base = strlen(alphabet);
+        auto permutation = schrott_id_encoder::generate_permutation(alphabet);
+        schrott_id_encoder schrott_id(alphabet, permutation, 1);
+
+        // Test around every power of the base, where the floating point length is most fragile
+        for (double power = 1; power < 9007199254740992.0; power *= base)
+        {
+            for (std::uint64_t value = static_cast<std::uint64_t>(power) - 1;
+                 value <= static_cast<std::uint64_t>(power) + 1;
+                 ++value)
+            {
+                // Where the reference length is too short for the value, the real digit count is used
+                auto expected = static_cast<std::size_t>(std::ceil(std::log(value + 1) / std::log(base)));
+                auto digits = std::size_t{1};
+                for (auto v = value / base; v > 0; v /= base)
+                {
+                    ++digits;
+                }
+                expected = std::max(expected, digits);
+
+                REQUIRE(schrott_id.encoded_length(value) == expected);
+                REQUIRE(schrott_id.encode(value).size() == expected);
+                REQUIRE(schrott_id.decode(schrott_id.encode(value)) == value);
+            }
+        }
+
+        REQUIRE(schrott_id.decode(schrott_id.encode(UINT64_MAX)) == UINT64_MAX);
+        REQUIRE(schrott_id.encode(UINT64_MAX).size() == schrott_id.max_encoded_length());
+    }
+}
+
+TEST_CASE("Encode and decode batch")
+{
+    schrott_id_encoder schrott_id(alphabets::base64, test_permutation, 3);
+
+    std::vector<std::uint64_t> values;
+    for (std::uint64_t i = 0; i < 1000; ++i)
+    {
+        values.push_back(i * 0x9E3779B97F4A7C15ull);
+    }
+
+    std::vector<char> chars(values.size() * schrott_id.max_encoded_length());
+    std::vector<std::size_t> offsets(values.size() + 1);
+
+    REQUIRE(schrott_id.encode_batch(values.data(), values.size(), chars.data(), chars.size(), offsets.data())
+            == error::none);
+
+    for (std::size_t i = 0; i < values.size(); ++i)
+    {
+        REQUIRE(std::string(chars.data() + offsets[i], chars.data() + offsets[i + 1]) == schrott_id.encode(values[i]));
+    }
+
+    std::vector<std::uint64_t> decoded(values.size());
+    std::vector<error> errors(values.size());
+
+    REQUIRE(schrott_id.decode_batch(chars.data(), offsets.data(), values.size(), decoded.data(), errors.data()) == 0);
+    REQUIRE(decoded == values);
+}
+
+TEST_CASE("Encode batch buffer too small")
+{
+    schrott_id_encoder schrott_id(alphabets::base64, test_permutation, 3);
+
+    std::uint64_t values[] = {1, 2, 3};
+    char chars[8];
+    std::size_t offsets[4];
+
+    REQUIRE(schrott_id.encode_batch(values, 3, chars, sizeof(chars), offsets) == error::buffer_too_small);
+}
+
+TEST_CASE("Decode batch invalid")
+{
+    schrott_id_encoder schrott_id(alphabets::base64, test_permutation, 3);
+
+    std::string chars = schrott_id.encode(1) + "$%&" + schrott_id.encode(2);
+    std::size_t offsets[] = {0, 3, 6, 9};
+    std::uint64_t values[3];
+    error errors[3];
+
+    REQUIRE(schrott_id.decode_batch(chars.data(), offsets, 3, values, errors) == 1);
+    REQUIRE(values[0] == 1);
+    REQUIRE(values[1] == 0);
+    REQUIRE(values[2] == 2);
+    REQUIRE(errors[1] == error::invalid_character);
+}
+
+TEST_CASE("Encode and decode records")
+{
+    schrott_id_encoder schrott_id(alphabets::base64, test_permutation, 3);
+
+    std::vector<std::uint64_t> values;
+    for (std::uint64_t i = 0; i < 1000; ++i)
+    {
+        values.push_back(i % 2 ? i : i * 0x9E3779B97F4A7C15ull);
+    }
+
+    auto width = schrott_id.max_encoded_length();
+    std::vector<char> records(values.size() * width, 'x');
+
+    REQUIRE(schrott_id.encode_records(values.data(), values.size(), records.data(), width) == error::none);
+
+    for (std::size_t i = 0; i < values.size(); ++i)
+    {
+        auto id = schrott_id.encode(values[i]);
+        auto record = std::string(records.data() + i * width, width);
+
+        REQUIRE(record == id + std::string(width - id.size(), '\0'));
+    }
+
+    std::vector<std::uint64_t> decoded(values.size());
+    std::vector<error> errors(values.size());
+
+    REQUIRE(schrott_id.decode_records(records.data(), values.size(), width, decoded.data(), errors.data()) == 0);
+    REQUIRE(decoded == values);
+
+    records[5 * width] = '$';
+    REQUIRE(schrott_id.decode_records(records.data(), values.size(), width, decoded.data(), errors.data()) == 1);
+    REQUIRE(errors[5] == error::invalid_character);
+
+    REQUIRE(schrott_id.encode_records(values.data(), values.size(), records.data(), 3) == error::buffer_too_small);
+}
+
+TEST_CASE("Decode batch of string views")
+{
+    schrott_id_encoder schrott_id(alphabets::base64, test_permutation, 3);
+
+    std::mt19937_64 random(9);
+    std::vector<std::uint64_t> values;
+    std::vector<std::string> ids;
+
+    for (auto i = 0; i < 2000; ++i)
+    {
+        // Six lengths interleaved, more than are staged at once
+        auto value = random() >> (random() % 6 * 12);
+        values.push_back(value);
+        ids.push_back(i % 97 == 3 ? "$%&" : schrott_id.encode(value));
+    }
+
+    std::vector<std::string_view> views(ids.begin(), ids.end());
+    std::vector<std::uint64_t> decoded(views.size());
+    std::vector<error> errors(views.size());
+
+    REQUIRE(schrott_id.decode_batch(views.data(), views.size(), decoded.data(), errors.data()) == 21);
+
+    for (std::size_t i = 0; i < values.size(); ++i)
+    {
+        if (i % 97 == 3)
+        {
+            REQUIRE(errors[i] == error::invalid_character);
+            REQUIRE(decoded[i] == 0);
+        }
+        else
+        {
+            REQUIRE(errors[i] == error::none);
+            REQUIRE(decoded[i] == values[i]);
+        }
+    }
+}
+
+TEST_CASE("Decode batch sorted unique")
+{
+    schrott_id_encoder schrott_id(alphabets::base64, test_permutation, 3);
+
+    std::mt19937_64 random(5);
+    std::vector<std::uint64_t> values;
+
+    for (auto i = 0; i < 5000; ++i)
+    {
+        // Mix of small and large values with plenty of duplicates
+        values.push_back(i % 3 ? random() % 1000 : random());
+    }
+
+    std::string chars;
+    std::vector<std::size_t> offsets{0};
+
+    for (std::size_t i = 0; i < values.size(); ++i)
+    {
+        chars += i % 100 == 7 ? "$%&" : schrott_id.encode(values[i]);
+        offsets.push_back(chars.size());
+    }
+
+    std::vector<std::uint64_t> unique(values.size());
+    std::vector<std::size_t> positions(values.size());
+    std::vector<error> errors(values.size());
+
+    auto n = schrott_id.decode_batch_sorted_unique(chars.data(), offsets.data(), values.size(),
+                                                  unique.data(), positions.data(), errors.data());
+    unique.resize(n);
+
+    std::set<std::uint64_t> expected;
+    for (std::size_t i = 0; i < values.size(); ++i)
+    {
+        if (i % 100 == 7)
+        {
+            REQUIRE(positions[i] == schrott_id::npos);
+            REQUIRE(errors[i] == error::invalid_character);
+        }
+        else
+        {
+            REQUIRE(unique[positions[i]] == values[i]);
+            expected.insert(values[i]);
+        }
+    }
+
+    REQUIRE(unique == std::vector<std::uint64_t>(expected.begin(), expected.end()));
+}
+
+TEST_CASE("Encode range")
+{
+    struct range
+    {
+        std::uint64_t start;
+        std::size_t count;
+    };
+
+    // Ranges crossing length boundaries of base64 with min_length 1 and the end of the value range
+    range ranges[] = {{0, 5000}, {4090, 10}, {262100, 300}, {UINT64_MAX - 99, 100}, {UINT64_MAX, 1}, {7, 0}};
+
+    for (auto min_length: {1, 3, 20})
+    {
+        schrott_id_encoder schrott_id(alphabets::base64, test_permutation, min_length);
+
+        for (auto r: ranges)
+        {
+            std::vector<char> chars(r.count * schrott_id.max_encoded_length());
+            std::vector<std::size_t> offsets(r.count + 1);
+
+            REQUIRE(schrott_id.encode_range(r.start, r.count, chars.data(), chars.size(), offsets.data())
+                    == error::none);
+
+            for (std::size_t i = 0; i < r.count; ++i)
+            {
+                REQUIRE(std::string(chars.data() + offsets[i], chars.data() + offsets[i + 1])
+                        == schrott_id.encode(r.start + i));
+            }
+        }
+    }
+}
+
+TEST_CASE("Encode range base 256")
+{
+    std::string alphabet;
+    for (auto i = 0; i < 256; ++i)
+    {
+        alphabet.push_back(static_cast<char>(i));
+    }
+
+    schrott_id_encoder schrott_id(alphabet, schrott_id_encoder::generate_permutation(alphabet), 1);
+
+    std::vector<char> chars(1000 * schrott_id.max_encoded_length());
+    std::vector<std::size_t> offsets(1001);
+
+    REQUIRE(schrott_id.encode_range(65000, 1000, chars.data(), chars.size(), offsets.data()) == error::none);
+
+    for (std::size_t i = 0; i < 1000; ++i)
+    {
+        REQUIRE(std::string(chars.data() + offsets[i], chars.data() + offsets[i + 1]) == schrott_id.encode(65000 + i));
+    }
+}
+
+TEST_CASE("Encode range errors")
+{
+    schrott_id_encoder schrott_id(alphabets::base64, test_permutation, 3);
+
+    char chars[64];
+    std::size_t offsets[101];
+
+    REQUIRE(schrott_id.encode_range(UINT64_MAX - 1, 3, chars, sizeof(chars), offsets) == error::range_overflow);
+    REQUIRE(schrott_id.encode_range(0, 100, chars, sizeof(chars), offsets) == error::buffer_too_small);
+}
+
+#ifdef __SIZEOF_INT128__
+
+TEST_CASE("Encode and decode 128-bit")
+{
+    schrott_id_encoder schrott_id(alphabets::base64, test_permutation, 3);
+
+    REQUIRE(schrott_id.encode(static_cast<unsigned __int128>(420)) == schrott_id.encode(420));
+    REQUIRE(schrott_id.encode(static_cast<unsigned __int128>(UINT64_MAX)) == schrott_id.encode(UINT64_MAX));
+
+    std::mt19937_64 random(42);
+    std::vector<unsigned __int128> values{0, UINT64_MAX, static_cast<unsigned __int128>(UINT64_MAX) + 1, ~static_cast<unsigned __int128>(0)};
+
+    for (auto shift = 0; shift < 128; ++shift)
+    {
+        auto one = static_cast<unsigned __int128>(1) << shift;
+        values.push_back(one);
+        values.push_back(one - 1);
+        values.push_back(((static_cast<unsigned __int128>(random()) << 64) | random()) >> shift);
+    }
+
+    for (auto value: values)
+    {
+        auto encoded = schrott_id.encode(value);
+
+        REQUIRE(schrott_id.decode128(encoded) == value);
+    }
+
+    REQUIRE(schrott_id.encode(~static_cast<unsigned __int128>(0)).size() == 22);
+}
+
+#endif
+
+TEST_CASE("Encode and decode words")
+{
+    for (auto alphabet: {alphabets::base64, alphabets::base58, alphabets::base36, "01"})
+    {
+        schrott_id_encoder schrott_id(alphabet, schrott_id_encoder::generate_permutation(alphabet), 3);
+
+        std::mt19937_64 random(7);
+
+        for (auto i = 0; i < 200; ++i)
+        {
+            std::uint64_t words[4] = {random(), random(), random(), random()};
+            words[i % 4] = i % 3 ? words[i % 4] : 0;
+            words[3] >>= i % 64;
+
+            auto encoded = schrott_id.encode_words(words, 4);
+
+            std::uint64_t decoded[4];
+            REQUIRE(schrott_id.decode_words(encoded.data(), encoded.size(), decoded, 4) == error::none);
+            REQUIRE(std::equal(words, words + 4, decoded));
+        }
+
+        std::uint64_t small[] = {420, 0, 0};
+        REQUIRE(schrott_id.encode_words(small, 3) == schrott_id.encode(420));
+    }
+}
+
+TEST_CASE("Decode words overflow")
+{
+    schrott_id_encoder schrott_id(alphabets::base64, test_permutation, 3);
+
+    std::uint64_t words[] = {1, 2, 3};
+    auto encoded = schrott_id.encode_words(words, 3);
+
+    std::uint64_t decoded[2];
+    REQUIRE(schrott_id.decode_words(encoded.data(), encoded.size(), decoded, 2) == error::range_overflow);
+    REQUIRE(schrott_id.decode_words("$%&", 3, decoded, 2) == error::invalid_character);
+}
+
+TEST_CASE("Encode and decode bytes")
+{
+    std::string base256;
+    for (auto i = 0; i < 256; ++i)
+    {
+        base256.push_back(static_cast<char>(i));
+    }
+
+    for (auto alphabet: {std::string(alphabets::base64), std::string(alphabets::base58),
+                         std::string(alphabets::base32), std::string("0123456789abcdef"), base256})
+    {
+        schrott_id_encoder schrott_id(alphabet, schrott_id_encoder::generate_permutation(alphabet), 3);
+
+        std::mt19937 random(11);
+
+        for (std::size_t size = 0; size <= 40; ++size)
+        {
+            for (auto i = 0; i < 20; ++i)
+            {
+                std::vector<byte> bytes(size);
+                for (auto& b: bytes)
+                {
+                    b = random() % 256;
+                }
+
+                // Leading zero bytes and all ones must survive as well
+                if (i == 0 && size > 2)
+                {
+                    bytes[0] = bytes[1] = 0;
+                }
+                if (i == 1)
+                {
+                    std::fill(bytes.begin(), bytes.end(), 0xFF);
+                }
+
+                auto encoded = schrott_id.encode_bytes(bytes);
+
+                REQUIRE(encoded.size() == schrott_id.encoded_bytes_length(size));
+                REQUIRE(schrott_id.decode_bytes(encoded) == bytes);
+            }
+        }
+    }
+}
+
+TEST_CASE("Encode bytes UUID length")
+{
+    schrott_id_encoder schrott_id(alphabets::base64, test_permutation, 3);
+
+    REQUIRE(schrott_id.encoded_bytes_length(16) == 22);
+    REQUIRE(schrott_id.encoded_bytes_length(20) == 27);
+}
+
+TEST_CASE("Decode bytes invalid")
+{
+    schrott_id_encoder schrott_id(alphabets::base58, schrott_id_encoder::generate_permutation(alphabets::base58), 1);
+
+    std::vector<byte> bytes;
+
+    // Encoded lengths of 0, 1, 2 and 3 bytes are 1, 2, 3 and 5 base58 digits, 4 digits is invalid
+    REQUIRE(schrott_id.encoded_bytes_length(3) == 5);
+    REQUIRE(schrott_id.decode_bytes(std::string(4, '1').data(), 4, bytes) == error::invalid_length);
+
+    // 3000 is encoded with 2 digits but does not fit into 1 byte
+    auto encoded = schrott_id.encode(3000);
+    REQUIRE(encoded.size() == 2);
+    REQUIRE(schrott_id.decode_bytes(encoded.data(), encoded.size(), bytes) == error::range_overflow);
+
+    REQUIRE_THROWS_WITH(schrott_id.decode_bytes("$%"), Contains("Character not in alphabet"));
+}
+
+TEST_CASE("Encode and decode tuple")
+{
+    schrott_id_encoder schrott_id(alphabets::base64, test_permutation, 3);
+
+    tuple_layout tenant_order({20, 40});
+
+    auto encoded = schrott_id.encode_tuple(tenant_order, {42, 123456789});
+
+    REQUIRE(encoded == schrott_id.encode((std::uint64_t{42} << 40) | 123456789));
+    REQUIRE(schrott_id.decode_tuple(tenant_order, encoded) == std::vector<std::uint64_t>{42, 123456789});
+
+    // Fields spanning word boundaries
+    tuple_layout wide({7, 64, 33, 64});
+    std::mt19937_64 random(3);
+
+    for (auto i = 0; i < 100; ++i)
+    {
+        std::vector<std::uint64_t> fields{random() >> 57, random(), random() >> 31, random()};
+
+        REQUIRE(schrott_id.decode_tuple(wide, schrott_id.encode_tuple(wide, fields.data())) == fields);
+    }
+}
+
+TEST_CASE("Tuple invalid")
+{
+    schrott_id_encoder schrott_id(alphabets::base64, test_permutation, 3);
+
+    REQUIRE_THROWS_WITH(tuple_layout({}), Contains("at least one field"));
+    REQUIRE_THROWS_WITH(tuple_layout({8, 65}), Contains("between 1 and 64"));
+
+    tuple_layout layout({8, 8});
+
+    REQUIRE_THROWS_WITH(schrott_id.encode_tuple(layout, {256, 1}), Contains("does not fit"));
+    REQUIRE_THROWS_WITH(schrott_id.encode_tuple(layout, {1}), Contains("Number of fields"));
+
+    REQUIRE(tuple_layout::create({}).error() == error::invalid_tuple_layout);
+    REQUIRE(tuple_layout::create({0, 8}).error() == error::invalid_tuple_layout);
+    REQUIRE(tuple_layout::create({8, 65}).error() == error::invalid_tuple_layout);
+    REQUIRE(tuple_layout::create({8, 8})->total_bits() == 16);
+    REQUIRE_THROWS_WITH(result<int>(error::none), Contains("needs an error"));
+
+    char out[64];
+    std::size_t written;
+    std::uint64_t overflowing[] = {256, 1};
+    std::uint64_t valid[] = {255, 1};
+    REQUIRE(schrott_id.encode_tuple(layout, overflowing, out, sizeof(out), written) == error::range_overflow);
+    REQUIRE(written == 0);
+    REQUIRE(schrott_id.encode_tuple(layout, valid, out, 2, written) == error::buffer_too_small);
+    REQUIRE(schrott_id.encode_tuple(layout, valid, out, sizeof(out), written) == error::none);
+    REQUIRE(std::string(out, written) == schrott_id.encode_tuple(layout, valid));
+
+    tuple_layout wide({64, 64});
+    std::uint64_t wide_fields[] = {3, 5};
+    REQUIRE(schrott_id.encode_tuple(wide, wide_fields, out, sizeof(out), written) == error::none);
+    REQUIRE(std::string(out, written) == schrott_id.encode_tuple(wide, wide_fields));
+    REQUIRE(schrott_id.encode_tuple(wide, wide_fields, out, written - 1, written) == error::buffer_too_small);
+
+    schrott_id_encoder feistel(alphabets::base64, test_permutation, 3, algorithm::feistel);
+    REQUIRE(feistel.encode_tuple(wide, wide_fields, out, sizeof(out), written) == error::range_overflow);
+    REQUIRE_THROWS_WITH(feistel.encode_tuple(wide, wide_fields), Contains("up to 64 bits"));
+
+    std::uint64_t fields[2];
+    auto too_wide = schrott_id.encode(1 << 16);
+    REQUIRE(schrott_id.decode_tuple(layout, too_wide.data(), too_wide.size(), fields) == error::range_overflow);
+
+    // IDs beyond 64 bits do not wrap into a 64-bit layout
+    tuple_layout full({32, 32});
+    std::uint64_t beyond[] = {5, 1};
+    auto overlong = schrott_id.encode_words(beyond, 2);
+    REQUIRE(schrott_id.decode_tuple(full, overlong.data(), overlong.size(), fields) == error::range_overflow);
+}
+
+TEST_CASE("Fixed length rejects values beyond 64 bits")
+{
+    // 24 hex digits hold 96 bits, IDs of values above 2^64 must not wrap into the range
+    schrott_id_encoder schrott_id("0123456789abcdef", schrott_id_encoder::generate_permutation("0123456789abcdef"), 24);
+    fixed_length_encoder keys(schrott_id, std::uint64_t{1} << 40);
+
+    REQUIRE(keys.length() == 24);
+
+    std::uint64_t beyond[] = {5, 1};
+    auto forged = keys.encoder().encode_words(beyond, 2);
+    REQUIRE(forged.size() == 24);
+    REQUIRE(forged != keys.encode(5));
+
+    std::uint64_t value;
+    REQUIRE(keys.try_decode(forged.data(), forged.size(), value) == error::range_overflow);
+
+    auto chars = keys.encode(5) + forged;
+    std::uint64_t values[2];
+    error errors[2];
+    REQUIRE(keys.decode_batch(chars.data(), 2, values, errors) == 1);
+    REQUIRE(values[0] == 5);
+    REQUIRE(errors[1] == error::range_overflow);
+}
+
+TEST_CASE("Prefixed encode and decode")
+{
+    schrott_id_encoder schrott_id(alphabets::base64, test_permutation, 3);
+    prefixed_encoder orders(schrott_id, "ord_");
+
+    REQUIRE(orders.encode(420) == "ord_gnH");
+    REQUIRE(orders.decode("ord_gnH") == 420);
+
+    char buf[8];
+    REQUIRE(orders.encode_to(420, buf, sizeof(buf)) == 7);
+    REQUIRE(std::string(buf, 7) == "ord_gnH");
+    REQUIRE(orders.encode_to(420, buf, 6) == 0);
+
+    std::uint64_t value;
+    REQUIRE(orders.try_decode("usr_gnH", 7, value) == error::invalid_prefix);
+    REQUIRE(orders.try_decode("ord", 3, value) == error::invalid_prefix);
+    REQUIRE_THROWS_WITH(orders.decode("ord_$%&"), Contains("Character not in alphabet"));
+}
+
+TEST_CASE("Prefixed encoder tweak")
+{
+    schrott_id_encoder schrott_id(alphabets::base64, test_permutation, 3);
+    prefixed_encoder orders(schrott_id, "ord_", true);
+    prefixed_encoder users(schrott_id, "usr_", true);
+
+    auto differ = 0;
+
+    for (std::uint64_t i = 0; i < 1000; ++i)
+    {
+        auto order = orders.encode(i);
+        auto user = users.encode(i);
+
+        REQUIRE(orders.decode(order) == i);
+        REQUIRE(users.decode(user) == i);
+
+        differ += order.substr(4) != user.substr(4);
+    }
+
+    REQUIRE(differ > 990);
+
+    // Tweaked permutations are stable across platforms and releases
+    REQUIRE(orders.encode(420) == "ord_FX9");
+    REQUIRE(orders.encode(0) == "ord_3vM");
+}
+
+TEST_CASE("Fixed length encode and decode")
+{
+    schrott_id_encoder schrott_id(alphabets::base64, test_permutation, 3);
+    fixed_length_encoder keys(schrott_id, (std::uint64_t{1} << 40) - 1);
+
+    REQUIRE(keys.length() == 7);
+    REQUIRE(keys.encode(0).size() == 7);
+    REQUIRE(keys.encode(keys.max_value()).size() == 7);
+
+    schrott_id_encoder padded(alphabets::base64, test_permutation, 7);
+    REQUIRE(keys.encode(420) == padded.encode(420));
+    REQUIRE(keys.decode(keys.encode(420)) == 420);
+
+    REQUIRE_THROWS_AS(keys.encode(keys.max_value() + 1), std::out_of_range);
+
+    char buf[7];
+    REQUIRE(keys.encode_to(keys.max_value() + 1, buf, sizeof(buf)) == 0);
+    REQUIRE(keys.encode_to(1, buf, 6) == 0);
+
+    std::uint64_t value;
+    REQUIRE(keys.try_decode("gnH", 3, value) == error::invalid_length);
+    REQUIRE(keys.try_decode("gnH$%&/", 7, value) == error::invalid_character);
+    REQUIRE(keys.try_decode(padded.encode(std::uint64_t{1} << 40).data(), 7, value) == error::range_overflow);
+}
+
+TEST_CASE("Fixed length batch")
+{
+    schrott_id_encoder schrott_id(alphabets::base64, test_permutation, 3);
+
+    for (auto& encoder: {schrott_id, schrott_id_encoder(alphabets::base64, test_permutation, 3, algorithm::feistel)})
+    {
+        fixed_length_encoder keys(encoder, 999999);
+
+        std::vector<std::uint64_t> values;
+        for (std::uint64_t i = 0; i < 1000; ++i)
+        {
+            values.push_back(i * 997 % 1000000);
+        }
+
+        std::string chars(values.size() * keys.length(), '\0');
+        REQUIRE(keys.encode_batch(values.data(), values.size(), &chars[0], chars.size()) == error::none);
+        REQUIRE(keys.encode_batch(values.data(), values.size(), &chars[0], chars.size() - 1)
+                == error::buffer_too_small);
+
+        for (std::size_t i = 0; i < values.size(); ++i)
+        {
+            REQUIRE(chars.substr(i * keys.length(), keys.length()) == keys.encode(values[i]));
+        }
+
+        std::vector<std::uint64_t> decoded(values.size());
+        std::vector<error> errors(values.size());
+
+        REQUIRE(keys.decode_batch(chars.data(), values.size(), decoded.data(), errors.data()) == 0);
+        REQUIRE(decoded == values);
+
+        // An invalid character and a value beyond the maximum fail on their own
+        chars[3 * keys.length()] = '$';
+        auto beyond = keys.encoder().encode(10000000);
+        std::copy(beyond.begin(), beyond.end(), &chars[5 * keys.length()]);
+
+        REQUIRE(keys.decode_batch(chars.data(), values.size(), decoded.data(), errors.data()) == 2);
+        REQUIRE(errors[3] == error::invalid_character);
+        REQUIRE(errors[5] == error::range_overflow);
+        REQUIRE(decoded[5] == 0);
+        REQUIRE(decoded[6] == values[6]);
+
+        values[7] = 1000000;
+        REQUIRE(keys.encode_batch(values.data(), values.size(), &chars[0], chars.size()) == error::range_overflow);
+    }
+}
+
+namespace
+{
+    std::uint64_t fixed_clock_ms = 1577836800000 + 1000;
+
+    std::uint64_t fixed_clock()
+    {
+        return fixed_clock_ms;
+    }
+}
+
+TEST_CASE("Generator layout")
+{
+    generator_layout layout;
+    layout.block_size = 16;
+
+    id_generator generator(schrott_id_encoder(alphabets::base64, test_permutation, 3), layout, 5, &fixed_clock);
+    id_generator::worker worker(generator);
+
+    for (std::uint64_t i = 0; i < 100; ++i)
+    {
+        auto generated = worker.next_encoded();
+
+        std::uint64_t time_ms, node, sequence;
+        generator.split(generated.value, time_ms, node, sequence);
+
+        REQUIRE(generator.encoder().decode(generated.id) == generated.value);
+        REQUIRE(node == 5);
+        REQUIRE(sequence == i);
+        REQUIRE(time_ms == fixed_clock_ms);
+    }
+}
+
+TEST_CASE("Generator runs ahead when a millisecond is used up")
+{
+    generator_layout layout;
+    layout.sequence_bits = 4;
+    layout.block_size = 4;
+
+    id_generator generator(schrott_id_encoder(alphabets::base64, test_permutation, 3), layout, 1, &fixed_clock);
+    id_generator::worker first(generator);
+    id_generator::worker second(generator);
+
+    std::unordered_set<std::uint64_t> seen;
+    std::uint64_t previous_time = 0;
+
+    for (auto i = 0; i < 64; ++i)
+    {
+        auto id = (i % 8 < 4 ? first : second).next();
+        REQUIRE(seen.insert(id).second);
+
+        std::uint64_t time_ms, node, sequence;
+        generator.split(id, time_ms, node, sequence);
+        REQUIRE(time_ms >= previous_time);
+        previous_time = time_ms;
+    }
+
+    REQUIRE(previous_time == fixed_clock_ms + 3);
+}
+
+TEST_CASE("Generator unique across threads")
+{
+    id_generator generator(schrott_id_encoder(alphabets::base64, test_permutation, 3), generator_layout(), 1);
+
+    const auto kThreads = 4;
+    const auto kIds = 50000;
+    std::vector<std::vector<std::uint64_t>> ids(kThreads);
+    std::vector<std::thread> threads;
+
+    for (auto t = 0; t < kThreads; ++t)
+    {
+        threads.emplace_back([&generator, &ids, t, kIds]()
+                             {
+                                 id_generator::worker worker(generator);
+                                 char buf[16];
+                                 std::uint64_t value;
+
+                                 for (auto i = 0; i < kIds; ++i)
+                                 {
+                                     worker.next_encoded(buf, sizeof(buf), value);
+                                     ids[t].push_back(value);
+                                 }
+                             });
+    }
+
+    for (auto& thread: threads)
+    {
+        thread.join();
+    }
+
+    std::unordered_set<std::uint64_t> seen;
+    for (auto& list: ids)
+    {
+        for (auto id: list)
+        {
+            REQUIRE(seen.insert(id).second);
+        }
+    }
+}
+
+TEST_CASE("Generator invalid")
+{
+    schrott_id_encoder schrott_id(alphabets::base64, test_permutation, 3);
+
+    generator_layout too_wide;
+    too_wide.time_bits = 50;
+    REQUIRE_THROWS_WITH(id_generator(schrott_id, too_wide, 0), Contains("at most 64 bits"));
+
+    REQUIRE_THROWS_WITH(id_generator(schrott_id, generator_layout(), 1024), Contains("Node does not fit"));
+
+    generator_layout short_time;
+    short_time.time_bits = 8;
+    id_generator generator(schrott_id, short_time, 0, &fixed_clock);
+    id_generator::worker worker(generator);
+
+    REQUIRE_THROWS_AS(worker.next(), std::overflow_error);
+}
+
+TEST_CASE("C interface encode and decode")
+{
+    schrott_id_handle* handle = nullptr;
+
+    REQUIRE(schrott_id_create(alphabets::base64, strlen(alphabets::base64), test_permutation, 3, &handle)
+            == SCHROTT_ID_OK);
+
+    schrott_id_encoder schrott_id(alphabets::base64, test_permutation, 3);
+
+    std::uint64_t values[] = {0, 420, 9999, UINT64_MAX};
+    std::vector<char> chars(4 * schrott_id_max_encoded_length(handle));
+    std::size_t offsets[5];
+
+    REQUIRE(schrott_id_encode_batch(handle, values, 4, chars.data(), chars.size(), offsets) == SCHROTT_ID_OK);
+
+    for (auto i = 0; i < 4; ++i)
+    {
+        REQUIRE(std::string(chars.data() + offsets[i], chars.data() + offsets[i + 1]) == schrott_id.encode(values[i]));
+    }
+
+    std::uint64_t decoded[4];
+    schrott_id_status statuses[4];
+
+    REQUIRE(schrott_id_decode_batch(handle, chars.data(), offsets, 4, decoded, statuses) == 0);
+    REQUIRE(std::equal(values, values + 4, decoded));
+
+    std::size_t positions[4];
+    std::size_t unique;
+
+    REQUIRE(schrott_id_decode_batch_sorted_unique(handle, chars.data(), offsets, 4, decoded, positions, statuses, &unique)
+            == SCHROTT_ID_OK);
+    REQUIRE(unique == 4);
+    REQUIRE(positions[3] == 3);
+
+    REQUIRE(schrott_id_encode_range(handle, 9998, 2, chars.data(), chars.size(), offsets) == SCHROTT_ID_OK);
+    REQUIRE(std::string(chars.data() + offsets[1], chars.data() + offsets[2]) == schrott_id.encode(9999));
+    REQUIRE(schrott_id_encode_range(handle, UINT64_MAX, 2, chars.data(), chars.size(), offsets)
+            == SCHROTT_ID_ERROR_OUT_OF_RANGE);
+
+    char id[16];
+    std::size_t written;
+    std::uint64_t value;
+
+    REQUIRE(schrott_id_encode(handle, 420, id, sizeof(id), &written) == SCHROTT_ID_OK);
+    REQUIRE(std::string(id, written) == "gnH");
+    REQUIRE(schrott_id_encode(handle, 420, id, 2, &written) == SCHROTT_ID_ERROR_BUFFER_TOO_SMALL);
+    REQUIRE(schrott_id_decode(handle, id, 3, &value) == SCHROTT_ID_OK);
+    REQUIRE(value == 420);
+    REQUIRE(schrott_id_decode(handle, "$%&", 3, &value) == SCHROTT_ID_ERROR_INVALID_CHARACTER);
+
+    schrott_id_destroy(handle);
+}
+
+TEST_CASE("C interface invalid arguments")
+{
+    schrott_id_handle* handle = nullptr;
+    char permutation[345];
+
+    REQUIRE(schrott_id_create("ABC", 3, test_permutation, 3, &handle) == SCHROTT_ID_ERROR_INVALID_ARGUMENT);
+    REQUIRE(handle == nullptr);
+    REQUIRE(schrott_id_generate_permutation("A", 1, permutation, sizeof(permutation))
+            == SCHROTT_ID_ERROR_INVALID_ARGUMENT);
+    REQUIRE(schrott_id_generate_permutation(alphabets::base64, 64, permutation, 10)
+            == SCHROTT_ID_ERROR_BUFFER_TOO_SMALL);
+    REQUIRE(schrott_id_generate_permutation(alphabets::base64, 64, permutation, sizeof(permutation))
+            == SCHROTT_ID_OK);
+    REQUIRE(schrott_id_create(alphabets::base64, 64, permutation, 3, &handle) == SCHROTT_ID_OK);
+
+    schrott_id_destroy(handle);
+}
+
+TEST_CASE("C interface algorithm")
+{
+    schrott_id_handle* handle = nullptr;
+
+    REQUIRE(schrott_id_create_with_algorithm(alphabets::base64, 64, test_permutation, 3, 7, &handle)
+            == SCHROTT_ID_ERROR_INVALID_ARGUMENT);
+    REQUIRE(schrott_id_create_with_algorithm(alphabets::base64, 64, test_permutation, 3,
+                                             SCHROTT_ID_ALGORITHM_FEISTEL, &handle) == SCHROTT_ID_OK);
+
+    char out[16];
+    std::size_t written;
+    REQUIRE(schrott_id_encode(handle, 420, out, sizeof(out), &written) == SCHROTT_ID_OK);
+
+    schrott_id_encoder schrott_id(alphabets::base64, test_permutation, 3, algorithm::feistel);
+    REQUIRE(std::string(out, written) == schrott_id.encode(420));
+
+    std::uint64_t value;
+    REQUIRE(schrott_id_decode(handle, "///////////", 11, &value) == SCHROTT_ID_ERROR_OUT_OF_RANGE);
+
+    schrott_id_destroy(handle);
+}
+
+TEST_CASE("C interface round schedule")
+{
+    schrott_id_handle* handle = nullptr;
+
+    REQUIRE(schrott_id_create_with_rounds(alphabets::base64, 64, test_permutation, 3, 0, 0, &handle)
+            == SCHROTT_ID_ERROR_INVALID_ARGUMENT);
+    REQUIRE(schrott_id_create_with_rounds(alphabets::base64, 64, test_permutation, 3, 0, 8, &handle)
+            == SCHROTT_ID_OK);
+
+    char out[16];
+    std::size_t written;
+    REQUIRE(schrott_id_encode(handle, 420, out, sizeof(out), &written) == SCHROTT_ID_OK);
+
+    schrott_id_encoder schrott_id(alphabets::base64, test_permutation, 3, round_schedule::constant(8));
+    REQUIRE(std::string(out, written) == schrott_id.encode(420));
+
+    schrott_id_destroy(handle);
+}
+
+TEST_CASE("Cache encode and decode")
+{
+    schrott_id_cache cache(schrott_id_encoder(alphabets::base64, test_permutation, 3), 1024);
+
+    for (auto pass = 0; pass < 2; ++pass)
+    {
+        for (std::uint64_t i = 0; i < 100; ++i)
+        {
+            auto encoded = cache.encode(i);
+
+            REQUIRE(encoded == cache.encoder().encode(i));
+            REQUIRE(cache.decode(encoded) == i);
+        }
+    }
+
+    auto stats = cache.stats();
+
+    REQUIRE(stats.encode_hits + stats.encode_misses == 200);
+    REQUIRE(stats.encode_hits >= 90);
+    REQUIRE(stats.decode_hits >= 90);
+
+    REQUIRE_THROWS_WITH(cache.decode("$%&"), Contains("Character not in alphabet"));
+
+    schrott_id_cache feistel(schrott_id_encoder(alphabets::base64, test_permutation, 3, algorithm::feistel), 16);
+    REQUIRE_THROWS_WITH(feistel.decode("///////////"), Contains("Value exceeds the supported range"));
+
+    cache.reset_stats();
+    REQUIRE(cache.stats().decode_hits == 0);
+}
+
+TEST_CASE("Cache evicts when full")
+{
+    schrott_id_cache cache(schrott_id_encoder(alphabets::base64, test_permutation, 3), 64);
+
+    for (std::uint64_t i = 0; i < 10000; ++i)
+    {
+        char buf[16];
+        auto len = cache.encode_to(i % 1000, buf, sizeof(buf));
+
+        REQUIRE(std::string(buf, len) == cache.encoder().encode(i % 1000));
+    }
+
+    REQUIRE(cache.stats().encode_misses > 1000);
+}
+
+TEST_CASE("Cache concurrent access")
+{
+    schrott_id_cache cache(schrott_id_encoder(alphabets::base64, test_permutation, 3), 256);
+    std::atomic<int> failures{0};
+    std::vector<std::thread> threads;
+
+    for (auto t = 0; t < 8; ++t)
+    {
+        threads.emplace_back([&cache, &failures, t]()
+                             {
+                                 for (std::uint64_t i = 0; i < 20000; ++i)
+                                 {
+                                     auto value = (i * 7 + t) % 512;
+                                     auto encoded = cache.encode(value);
+
+                                     if (encoded != cache.encoder().encode(value)
+                                         || cache.decode(encoded) != value)
+                                     {
+                                         ++failures;
+                                     }
+                                 }
+                             });
+    }
+
+    for (auto& thread: threads)
+    {
+        thread.join();
+    }
+
+    REQUIRE(failures == 0);
+}
+
+TEST_CASE("JSON rewrite selected fields")
+{
+    schrott_id_encoder schrott_id(alphabets::base64, test_permutation, 3);
+    json_rewriter encode(schrott_id, json_rewriter::direction::encode);
+    json_rewriter decode(schrott_id, json_rewriter::direction::decode);
+
+    std::string json = R"({"id": 5, "user_id":12, "name": "x_id", "tags": ["id", 7], "count": 3,
+        "text": "say \"id\": 9", "nested": {"order_id" : 123456789012, "price_id": 1.5, "a_id": -1, "b_id": null}})";
+    std::string expected = R"({"id": ")" + schrott_id.encode(5) + R"(", "user_id":")" + schrott_id.encode(12)
+                           + R"(", "name": "x_id", "tags": ["id", 7], "count": 3,
+        "text": "say \"id\": 9", "nested": {"order_id" : ")" + schrott_id.encode(123456789012)
+                           + R"(", "price_id": 1.5, "a_id": -1, "b_id": null}})";
+
+    std::string out;
+    REQUIRE(encode.rewrite(json, out) == error::none);
+    REQUIRE(out == expected);
+
+    std::string back;
+    REQUIRE(decode.rewrite(out, back) == error::none);
+    REQUIRE(back == json);
+
+    // The output buffer is reused
+    REQUIRE(encode.rewrite(json, out) == error::none);
+    REQUIRE(out == expected);
+
+    // Long documents take the SIMD path between strings
+    std::string many = "[";
+    std::string many_expected = "[";
+    for (auto i = 0; i < 1000; ++i)
+    {
+        many += (i ? "," : "") + std::string(R"({"id":)") + std::to_string(i) + R"(,"padding":"0123456789abcdef"})";
+        many_expected += (i ? "," : "") + std::string(R"({"id":")") + schrott_id.encode(i)
+                         + R"(","padding":"0123456789abcdef"})";
+    }
+    many += "]";
+    many_expected += "]";
+
+    REQUIRE(encode.rewrite(many, out) == error::none);
+    REQUIRE(out == many_expected);
+}
+
+TEST_CASE("JSON rewrite custom fields and errors")
+{
+    schrott_id_encoder schrott_id(alphabets::base64, test_permutation, 3);
+    json_rewriter encode(schrott_id, json_rewriter::direction::encode, {"key", "*Id"});
+    json_rewriter decode(schrott_id, json_rewriter::direction::decode);
+
+    std::string out;
+    REQUIRE(encode.rewrite(R"({"key": 1, "userId": 2, "id": 3})", out) == error::none);
+    REQUIRE(out == R"({"key": ")" + schrott_id.encode(1) + R"(", "userId": ")" + schrott_id.encode(2)
+                   + R"(", "id": 3})");
+
+    REQUIRE(encode.rewrite(R"({"key": 18446744073709551616})", out) == error::range_overflow);
+    REQUIRE(encode.rewrite(R"({"key": "unterminated})", out) == error::invalid_json);
+    REQUIRE(decode.rewrite(R"({"id": "$%&"})", out) == error::invalid_character);
+
+    // JSON may escape the slash of Base64
+    auto id = schrott_id.encode(5);
+    REQUIRE(id.find('/') != std::string::npos);
+
+    std::string escaped;
+    for (auto c: id)
+    {
+        escaped += c == '/' ? std::string("\\/") : std::string(1, c);
+    }
+
+    REQUIRE(decode.rewrite(R"({"id": ")" + escaped + "\"}", out) == error::none);
+    REQUIRE(out == R"({"id": 5})");
+
+    // Or escape any character as \u with upper or lower case hex digits
+    std::string unicode;
+    for (auto c: id)
+    {
+        char u[7];
+        std::snprintf(u, sizeof(u), c == '/' ? "\\u002F" : "\\u%04x", c);
+        unicode += u;
+    }
+
+    REQUIRE(decode.rewrite(R"({"id": ")" + unicode + "\"}", out) == error::none);
+    REQUIRE(out == R"({"id": 5})");
+
+    REQUIRE(decode.rewrite(R"({"id": "\u00e4bc"})", out) == error::invalid_character);
+    REQUIRE(decode.rewrite(R"({"id": "\u00g1bc"})", out) == error::invalid_json);
+    REQUIRE(decode.rewrite(R"({"id": "ab\u00"})", out) == error::invalid_character);
+
+    REQUIRE_THROWS_AS(json_rewriter(schrott_id_encoder("AB\"", "AQIA", 3), json_rewriter::direction::encode),
+                      std::invalid_argument);
+}
+
+#ifdef SCHROTT_ID_METRICS
+
+TEST_CASE("Metrics histogram buckets")
+{
+    for (std::uint64_t ns: {0, 1, 3, 4, 7, 8, 100, 1000, 123456789})
+    {
+        auto b = metrics::bucket(ns);
+
+        REQUIRE(metrics::bucket_lower_bound(b) <= ns);
+        REQUIRE(metrics::bucket_lower_bound(b + 1) > ns);
+    }
+
+    REQUIRE(metrics::bucket(UINT64_MAX) == metrics::kBuckets - 1);
+
+    metrics::histogram h = {};
+    h.buckets[metrics::bucket(100)] = 99;
+    h.buckets[metrics::bucket(5000)] = 1;
+
+    REQUIRE(h.percentile(0.5) == metrics::bucket_lower_bound(metrics::bucket(100)));
+    REQUIRE(h.percentile(1.0) == metrics::bucket_lower_bound(metrics::bucket(5000)));
+}
+
+TEST_CASE("Metrics snapshot")
+{
+    const auto encode = static_cast<std::size_t>(metrics::operation::encode);
+    const auto decode = static_cast<std::size_t>(metrics::operation::decode);
+    const auto encode_batch = static_cast<std::size_t>(metrics::operation::encode_batch);
+
+    schrott_id_encoder schrott_id(alphabets::base64, test_permutation, 3, algorithm::feistel);
+    auto before = metrics::snapshot();
+
+    std::thread worker([&schrott_id]()
+                       {
+                           for (std::uint64_t i = 0; i < 100; ++i)
+                           {
+                               schrott_id.encode(i);
+                           }
+                       });
+    worker.join();
+
+    std::uint64_t value;
+    REQUIRE(schrott_id.try_decode("$%&", 3, value) == error::invalid_character);
+
+    // The single-ID encodes inside the batch count towards the batch only
+    std::uint64_t values[10] = {};
+    char chars[10 * 3];
+    std::size_t offsets[11];
+    schrott_id.encode_batch(values, 10, chars, sizeof(chars), offsets);
+
+    auto after = metrics::snapshot();
+
+    REQUIRE(after.calls[encode] - before.calls[encode] == 100);
+    REQUIRE(after.latency[encode].count() - before.latency[encode].count() == 100);
+    REQUIRE(after.encoded_lengths[3] - before.encoded_lengths[3] == 110);
+    REQUIRE(after.calls[decode] - before.calls[decode] == 1);
+    REQUIRE(after.decoded_lengths[3] - before.decoded_lengths[3] == 1);
+    REQUIRE(after.errors[static_cast<std::size_t>(error::invalid_character)]
+            - before.errors[static_cast<std::size_t>(error::invalid_character)] == 1);
+    REQUIRE(after.calls[encode_batch] - before.calls[encode_batch] == 1);
+    REQUIRE(after.ids[encode_batch] - before.ids[encode_batch] == 10);
+
+    schrott_id_cache cache(schrott_id, 64);
+    cache.encode(1);
+    cache.encode(1);
+
+    auto cached = metrics::snapshot();
+
+    REQUIRE(cached.cache_hits - after.cache_hits == 1);
+    REQUIRE(cached.cache_misses - after.cache_misses == 1);
+}
+
+#endif
+
+#if __cplusplus >= 202002L
+
+TEST_CASE("Probe return values")
+{
+    schrott_id_encoder schrott_id(alphabets::base64, test_permutation, 3);
+
+    // Without a tracer calls keep no record
+    {
+        probes::call untraced;
+        REQUIRE_FALSE(untraced.active());
+        REQUIRE(probes::current() == nullptr);
+
+        SCHROTT_ID_PROBE_IDS(8, 2);
+        REQUIRE(untraced.count == 0);
+    }
+
+    // Like a tracer attaching to a return probe
+    SCHROTT_ID_SEMAPHORE(decode__return) = 1;
+
+    {
+        probes::call outer;
+        REQUIRE(outer.active());
+        REQUIRE(probes::current() == &outer);
+
+        // Calls count their IDs and errors themselves
+        std::uint64_t value;
+        REQUIRE(schrott_id.try_decode("$%&", 3, value) == error::invalid_character);
+        REQUIRE(probes::current() == &outer);
+        REQUIRE(outer.count == 0);
+        REQUIRE(outer.code == 0);
+
+        SCHROTT_ID_PROBE_IDS(8, 2);
+        SCHROTT_ID_PROBE_ERROR(error::none);
+        SCHROTT_ID_PROBE_ERROR(error::invalid_character);
+        SCHROTT_ID_PROBE_ERROR(error::buffer_too_small);
+
+        REQUIRE(outer.length == 16);
+        REQUIRE(outer.count == 2);
+        REQUIRE(outer.code == static_cast<std::uint64_t>(error::invalid_character));
+    }
+
+    SCHROTT_ID_SEMAPHORE(decode__return) = 0;
+    REQUIRE(probes::current() == nullptr);
+}
+
+std::vector<benchmark::timing> synthetic_timings(std::size_t operations, double slowdown)
+{
+    // Runs of every operation vary by a few percent, like on an idle machine
+    std::vector<benchmark::timing> timings(operations);
+    std::mt19937_64 random(11);
+    std::uniform_real_distribution<double> jitter(1.0, 1.03);
+
+    for (std::size_t op = 0; op < operations; ++op)
+    {
+        auto ns = 10.0 + op;
+
+        for (auto run = 0; run < 5; ++run)
+        {
+            timings[op].before.push_back(ns * jitter(random));
+            timings[op].after.push_back(ns * slowdown * jitter(random));
+        }
+    }
+
+    return timings;
+}
+
+TEST_CASE("Benchmark compare unchanged")
+{
+    auto result = benchmark::compare(synthetic_timings(20, 1.0), 0.05);
+
+    REQUIRE(result.changes.size() == 20);
+    REQUIRE(result.regressions == 0);
+
+    for (auto& c: result.changes)
+    {
+        REQUIRE(c.verdict == benchmark::verdict::unchanged);
+        REQUIRE(c.margin >= benchmark::kNoiseFloor);
+    }
+}
+
+TEST_CASE("Benchmark compare uniform slowdown")
+{
+    // A slowdown of shared code hits all operations alike and must not pass for a slower machine
+    auto result = benchmark::compare(synthetic_timings(20, 1.3), 0.05);
+
+    REQUIRE(result.regressions == 20);
+
+    for (auto& c: result.changes)
+    {
+        REQUIRE(c.verdict == benchmark::verdict::regressed);
+        REQUIRE(std::abs(c.change - 0.3) < 0.05);
+    }
+}
+
+TEST_CASE("Benchmark compare verdicts")
+{
+    auto timings = synthetic_timings(20, 1.0);
+
+    for (auto& ns: timings[3].after)
+    {
+        ns *= 1.5;
+    }
+
+    for (auto& ns: timings[7].after)
+    {
+        ns /= 1.5;
+    }
+
+    auto result = benchmark::compare(timings, 0.05);
+
+    REQUIRE(result.regressions == 1);
+    REQUIRE(result.changes[3].verdict == benchmark::verdict::regressed);
+    REQUIRE(std::abs(result.changes[3].change - 0.5) < 0.05);
+    REQUIRE(result.changes[7].verdict == benchmark::verdict::improved);
+
+    // A slowdown within the threshold and the margin is not a regression
+    timings = synthetic_timings(20, 1.0);
+
+    for (auto& ns: timings[5].after)
+    {
+        ns *= 1.08;
+    }
+
+    result = benchmark::compare(timings, 0.05);
+
+    REQUIRE(result.regressions == 0);
+    REQUIRE(result.changes[5].verdict == benchmark::verdict::unchanged);
+}
+
+TEST_CASE("Benchmark compare noisy runs widen the margin")
+{
+    auto timings = synthetic_timings(20, 1.0);
+
+    // One slow run in the baseline makes the mean uncertain, but not the fastest run
+    timings[2].before = {10, 30, 10, 30, 10};
+    timings[2].after = {13, 13, 13, 13, 13};
+
+    auto result = benchmark::compare(timings, 0.05);
+
+    REQUIRE(result.changes[2].margin > 0.3);
+    REQUIRE(result.changes[2].verdict == benchmark::verdict::unchanged);
+    REQUIRE(result.regressions == 0);
+}
+
+TEST_CASE("Encode view")
+{
+    schrott_id_encoder schrott_id(alphabets::base64, test_permutation, 3);
+
+    std::vector<std::uint64_t> values;
+    for (std::uint64_t i = 0; i < 1000; ++i)
+    {
+        values.push_back(i * 0x9E3779B97F4A7C15ull);
+    }
+
+    std::size_t i = 0;
+    for (auto id: values | views::encode(schrott_id))
+    {
+        REQUIRE(id == schrott_id.encode(values[i++]));
+    }
+    REQUIRE(i == values.size());
+
+    i = 0;
+    for (auto id: std::views::iota(0u, 300u) | views::encode(schrott_id))
+    {
+        REQUIRE(id == schrott_id.encode(i++));
+    }
+    REQUIRE(i == 300);
+
+    std::vector<std::uint64_t> empty;
+    REQUIRE((empty | views::encode(schrott_id)).begin() == std::default_sentinel);
+}
+
+TEST_CASE("Decode view")
+{
+    schrott_id_encoder schrott_id(alphabets::base64, test_permutation, 3);
+
+    std::vector<std::string> ids;
+    for (std::uint64_t i = 0; i < 1000; ++i)
+    {
+        ids.push_back(schrott_id.encode(i * 0x9E3779B97F4A7C15ull));
+    }
+
+    std::uint64_t i = 0;
+    for (auto value: views::decode(ids, schrott_id))
+    {
+        REQUIRE(value == i++ * 0x9E3779B97F4A7C15ull);
+    }
+    REQUIRE(i == ids.size());
+
+    std::list<std::string> list(ids.begin(), ids.begin() + 10);
+    i = 0;
+    for (auto value: list | views::decode(schrott_id))
+    {
+        REQUIRE(value == i++ * 0x9E3779B97F4A7C15ull);
+    }
+    REQUIRE(i == 10);
+
+    std::vector<std::string> invalid{schrott_id.encode(1), "$%&"};
+    auto view = invalid | views::decode(schrott_id);
+    auto it = view.begin();
+
+    REQUIRE(*it == 1);
+    ++it;
+    REQUIRE_THROWS_WITH(*it, Contains("Character not in alphabet"));
+}
+
+TEST_CASE("Encode and decode views compose")
+{
+    schrott_id_encoder schrott_id(alphabets::base58, schrott_id_encoder::generate_permutation(alphabets::base58), 5);
+
+    std::vector<std::uint64_t> values(200);
+    std::iota(values.begin(), values.end(), 1000);
+
+    std::vector<std::string> ids;
+    for (auto id: values | views::encode(schrott_id))
+    {
+        ids.emplace_back(id);
+    }
+
+    std::vector<std::uint64_t> decoded;
+    for (auto value: ids | views::decode(schrott_id) | std::views::take(150))
+    {
+        decoded.push_back(value);
+    }
+
+    REQUIRE(std::equal(decoded.begin(), decoded.end(), values.begin()));
+    REQUIRE(decoded.size() == 150);
+}
+
+#endif
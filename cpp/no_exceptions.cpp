@@ -0,0 +1,119 @@
+/**
+ * Checks the error code paths of SchrottID encoders in a build with -fno-exceptions -fno-rtti
+ *
+ * https://github.com/lorisleitner/schrott-id
+ */
+
+#include <cstdio>
+
+#include "schrott_id.hpp"
+#include "schrott_id_cache.hpp"
+#include "schrott_id_ff1.hpp"
+#include "schrott_id_generator.hpp"
+#include "schrott_id_json.hpp"
+
+#if !defined(SCHROTT_ID_NO_EXCEPTIONS)
+#error "Build with -fno-exceptions"
+#endif
+
+using namespace schrott_id;
+
+namespace
+{
+    const char* const kPermutation =
+            "HwEMFAcAMAYEPxc4Dy4RAxAkEgstJggbGSMiKB0yHgk7OSsNMxoYKRMWNg49LzEFFTQKPDUhHAIsICclOio+Nw==";
+
+    int failures = 0;
+
+    void check(bool condition, const char* what)
+    {
+        if (!condition)
+        {
+            std::fprintf(stderr, "Failed: %s\n", what);
+            ++failures;
+        }
+    }
+
+    // Counter based generator for generate_permutation, any uniform random bit generator works
+    struct counter
+    {
+        using result_type = std::uint32_t;
+
+        std::uint64_t state = 1;
+
+        static constexpr result_type min()
+        {
+            return 0;
+        }
+
+        static constexpr result_type max()
+        {
+            return UINT32_MAX;
+        }
+
+        result_type operator()()
+        {
+            return static_cast<result_type>(detail::mix64(state++));
+        }
+    };
+}
+
+int main()
+{
+    check(schrott_id_encoder::create("A", kPermutation, 3).error() == error::invalid_alphabet_size, "alphabet size");
+    check(schrott_id_encoder::create("AAB", kPermutation, 3).error() == error::duplicate_character, "alphabet unique");
+    check(schrott_id_encoder::create(alphabets::base64, kPermutation, 0).error() == error::invalid_min_length,
+          "min length");
+    check(schrott_id_encoder::create(alphabets::base64, kPermutation, 3, round_schedule::constant(0)).error()
+          == error::invalid_schedule, "schedule");
+    check(schrott_id_encoder::create(alphabets::base64, "$$$$", 3).error() == error::invalid_base64, "Base64");
+    check(schrott_id_encoder::create(alphabets::base32, kPermutation, 3).error() == error::invalid_permutation_length,
+          "permutation length");
+
+    std::vector<byte> bytes;
+    check(base64::decode("QUJD", bytes) == error::none && bytes.size() == 3, "Base64 decode");
+    check(base64::decode("QUJ", bytes) == error::invalid_base64, "Base64 length");
+
+    auto created = schrott_id_encoder::create(alphabets::base64, kPermutation, 3);
+    check(created.has_value(), "create");
+
+    if (!created)
+    {
+        return 1;
+    }
+
+    const auto& encoder = *created;
+    check(encoder.encode(0) == "uzU" && encoder.encode(1) == "d3B", "control values");
+
+    std::uint64_t value = 0;
+    check(encoder.try_decode("d3B", 3, value) == error::none && value == 1, "try_decode");
+    check(encoder.try_decode("$%&", 3, value) == error::invalid_character, "try_decode invalid");
+
+    auto feistel = schrott_id_encoder::create(alphabets::base64, kPermutation, 3, algorithm::feistel);
+    check(feistel && feistel->decode(feistel->encode(12345)) == 12345, "Feistel");
+
+    counter random;
+    auto permutation = schrott_id_encoder::generate_permutation(alphabets::base58, random);
+    check(schrott_id_encoder::create(alphabets::base58, permutation, 1).has_value(), "generate_permutation");
+
+    fixed_length_encoder fixed(encoder, 999999);
+    check(fixed.try_decode(fixed.encode(999999).data(), fixed.length(), value) == error::none && value == 999999,
+          "fixed length");
+
+    check(tuple_layout::create({}).error() == error::invalid_tuple_layout, "tuple layout empty");
+    check(tuple_layout::create({8, 65}).error() == error::invalid_tuple_layout, "tuple layout width");
+
+    auto layout = tuple_layout::create({8, 8});
+    std::uint64_t fields[] = {256, 1};
+    char out[16];
+    std::size_t written;
+    check(layout && encoder.encode_tuple(*layout, fields, out, sizeof(out), written) == error::range_overflow,
+          "tuple field width");
+
+    if (failures == 0)
+    {
+        std::printf("All checks passed\n");
+    }
+
+    return failures == 0 ? 0 : 1;
+}
@@ -1,22 +1,281 @@
 /**
  * Single header implementation for generating SchrottIDs v3.0.0
  *
+ * Builds without exceptions, like -fno-exceptions, define SCHROTT_ID_NO_EXCEPTIONS, which is also set automatically.
+ * Fallible functions then have error code alternatives, like @see schrott_id_encoder::create and try_decode,
+ * and the throwing ones call SCHROTT_ID_THROW, which aborts unless it is defined otherwise. No RTTI is needed.
+ *
  * https://github.com/lorisleitner/schrott-id
  */
 
 #ifndef SCHROTT_ID_HPP
 #define SCHROTT_ID_HPP
 
+#include <algorithm>
 #include <cmath>
-#include <map>
-#include <random>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <new>
 #include <string>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
+#if !defined(SCHROTT_ID_NO_EXCEPTIONS) && !defined(__cpp_exceptions) && !defined(__EXCEPTIONS) && !defined(_CPPUNWIND)
+#define SCHROTT_ID_NO_EXCEPTIONS
+#endif
+
+#ifdef SCHROTT_ID_NO_EXCEPTIONS
+#include <cstdlib>
+#ifndef SCHROTT_ID_THROW
+#define SCHROTT_ID_THROW(exception, message) std::abort()
+#endif
+#else
+#include <random>
+#include <stdexcept>
+#define SCHROTT_ID_THROW(exception, message) throw exception(message)
+#endif
+
+#if __cplusplus >= 201703L
+#include <string_view>
+#endif
+
+#if __cplusplus >= 202002L
+#include <span>
+#endif
+
+#ifdef SCHROTT_ID_METRICS
+#include "schrott_id_metrics.hpp"
+#else
+#define SCHROTT_ID_METRICS_MEASURE(op) ((void) 0)
+#define SCHROTT_ID_METRICS_COUNT_IDS(length, count) ((void) 0)
+#define SCHROTT_ID_METRICS_COUNT_ERROR(e) ((void) 0)
+#define SCHROTT_ID_METRICS_COUNT_CACHE(hit) ((void) 0)
+#endif
+
+#ifdef SCHROTT_ID_USDT
+#include "schrott_id_probes.hpp"
+#else
+#define SCHROTT_ID_PROBE_MEASURE(op, arg) ((void) 0)
+#define SCHROTT_ID_PROBE_IDS(length, count) ((void) 0)
+#define SCHROTT_ID_PROBE_ERROR(e) ((void) 0)
+#endif
+
+// Hooks of the optional instrumentation. Each expands to statements and must stand in a block of its own.
+#define SCHROTT_ID_MEASURE(op, arg) SCHROTT_ID_METRICS_MEASURE(op); SCHROTT_ID_PROBE_MEASURE(op, arg)
+#define SCHROTT_ID_COUNT_IDS(length, count) \
+    SCHROTT_ID_METRICS_COUNT_IDS(length, count); SCHROTT_ID_PROBE_IDS(length, count)
+#define SCHROTT_ID_COUNT_ERROR(e) SCHROTT_ID_METRICS_COUNT_ERROR(e); SCHROTT_ID_PROBE_ERROR(e)
+#define SCHROTT_ID_COUNT_CACHE(hit) SCHROTT_ID_METRICS_COUNT_CACHE(hit)
+
 namespace schrott_id
 {
     using byte = std::uint8_t;
 
+    /**
+     * Error codes reported by the non-throwing functions
+     */
+    enum class error : std::uint8_t
+    {
+        none = 0,
+        invalid_character,
+        buffer_too_small,
+        range_overflow,
+        invalid_length,
+        invalid_prefix,
+        invalid_alphabet_size,
+        duplicate_character,
+        invalid_min_length,
+        invalid_schedule,
+        invalid_base64,
+        invalid_permutation_length,
+        duplicate_position,
+        invalid_permutation_index,
+        invalid_json,
+        invalid_tuple_layout
+    };
+
+    /**
+     * Returns a human readable description of an error code.
+     * @param e The error code
+     * @return Static, null-terminated message
+     */
+    inline const char* error_message(error e)
+    {
+        switch (e)
+        {
+            case error::none:
+                return "No error";
+            case error::invalid_character:
+                return "Character not in alphabet";
+            case error::buffer_too_small:
+                return "Output buffer too small";
+            case error::range_overflow:
+                return "Value exceeds the supported range";
+            case error::invalid_length:
+                return "Invalid length";
+            case error::invalid_prefix:
+                return "Invalid prefix";
+            case error::invalid_alphabet_size:
+                return "Alphabet must have 2 to 256 characters";
+            case error::duplicate_character:
+                return "Alphabet must have unique characters";
+            case error::invalid_min_length:
+                return "min_length must be greater than 0";
+            case error::invalid_schedule:
+                return "Round schedule must run at least one round";
+            case error::invalid_base64:
+                return "Invalid Base64";
+            case error::invalid_permutation_length:
+                return "Permutation length must be equal to alphabet length. "
+                       "Please make sure to use a valid permutation for this alphabet";
+            case error::duplicate_position:
+                return "Invalid permutation. All positions must be unique.";
+            case error::invalid_permutation_index:
+                return "Invalid permutation. Invalid indices for used alphabet.";
+            case error::invalid_json:
+                return "Invalid JSON";
+            case error::invalid_tuple_layout:
+                return "Tuple layout must have at least one field, each between 1 and 64 bits wide";
+        }
+
+        return "Unknown error";
+    }
+
+    /**
+     * Either a value or the error that prevented it, returned by the non-throwing factories like
+     * @see schrott_id_encoder::create
+     */
+    template<class T>
+    class result
+    {
+    private:
+        union
+        {
+            T value_;
+        };
+
+        schrott_id::error error_;
+
+    public:
+        result(T value)
+                : value_(std::move(value)),
+                  error_(schrott_id::error::none)
+        {
+        }
+
+        /**
+         * Creates a result without a value.
+         * @throws std::invalid_argument e is error::none, which would claim a value.
+         */
+        result(schrott_id::error e)
+                : error_(e)
+        {
+            if (e == schrott_id::error::none)
+            {
+                SCHROTT_ID_THROW(std::invalid_argument, "A result without a value needs an error");
+            }
+        }
+
+        result(const result& other)
+                : error_(other.error_)
+        {
+            if (has_value())
+            {
+                new(&value_) T(other.value_);
+            }
+        }
+
+        result(result&& other)
+                : error_(other.error_)
+        {
+            if (has_value())
+            {
+                new(&value_) T(std::move(other.value_));
+            }
+        }
+
+        result& operator=(const result&) = delete;
+
+        ~result()
+        {
+            if (has_value())
+            {
+                value_.~T();
+            }
+        }
+
+        bool has_value() const
+        {
+            return error_ == schrott_id::error::none;
+        }
+
+        explicit operator bool() const
+        {
+            return has_value();
+        }
+
+        /**
+         * Returns error::none if there is a value.
+         */
+        schrott_id::error error() const
+        {
+            return error_;
+        }
+
+        /**
+         * Returns the value.
+         * @throws std::invalid_argument There is no value, with the message of the error.
+         */
+        T& value() &
+        {
+            check();
+            return value_;
+        }
+
+        const T& value() const &
+        {
+            check();
+            return value_;
+        }
+
+        T&& value() &&
+        {
+            check();
+            return std::move(value_);
+        }
+
+        T& operator*()
+        {
+            return value_;
+        }
+
+        const T& operator*() const
+        {
+            return value_;
+        }
+
+        T* operator->()
+        {
+            return &value_;
+        }
+
+        const T* operator->() const
+        {
+            return &value_;
+        }
+
+    private:
+        void check() const
+        {
+            if (!has_value())
+            {
+                SCHROTT_ID_THROW(std::invalid_argument, error_message(error_));
+            }
+        }
+    };
+
     namespace base64
     {
         // https://vorbrodt.blog/2019/03/23/base64-encoding/
@@ -24,7 +283,7 @@ namespace schrott_id
         static const char kEncodeLookup[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
         static const char kPadCharacter = '=';
 
-        std::string encode(const std::vector<byte>& input)
+        inline std::string encode(const std::vector<byte>& input)
         {
             std::string encoded;
             encoded.reserve(((input.size() / 3) + (input.size() % 3 > 0)) * 4);
@@ -64,11 +323,19 @@ namespace schrott_id
             return encoded;
         }
 
-        std::vector<byte> decode(const std::string& input)
+        /**
+         * Decodes Base64 without throwing.
+         * @param input Base64 with padding
+         * @param decoded Receives the bytes
+         * @return error::none or error::invalid_base64 for a wrong length, padding or character
+         */
+        inline error decode(const std::string& input, std::vector<byte>& decoded)
         {
+            decoded.clear();
+
             if (input.length() % 4)
             {
-                throw std::invalid_argument("Invalid Base64 length");
+                return error::invalid_base64;
             }
 
             std::size_t padding{};
@@ -81,7 +348,6 @@ namespace schrott_id
                 { padding++; }
             }
 
-            std::vector<byte> decoded;
             decoded.reserve(((input.length() / 4) * 3) - padding);
 
             std::uint32_t temp{};
@@ -119,17 +385,17 @@ namespace schrott_id
                             case 1:
                                 decoded.push_back((temp >> 16) & 0x000000FF);
                                 decoded.push_back((temp >> 8) & 0x000000FF);
-                                return decoded;
+                                return error::none;
                             case 2:
                                 decoded.push_back((temp >> 10) & 0x000000FF);
-                                return decoded;
+                                return error::none;
                             default:
-                                throw std::invalid_argument("Invalid padding in Base64");
+                                return error::invalid_base64;
                         }
                     }
                     else
                     {
-                        throw std::invalid_argument("Invalid character in Base64");
+                        return error::invalid_base64;
                     }
 
                     ++it;
@@ -140,6 +406,22 @@ namespace schrott_id
                 decoded.push_back((temp) & 0x000000FF);
             }
 
+            return error::none;
+        }
+
+        /**
+         * @throws std::invalid_argument The input is not valid Base64.
+         */
+        inline std::vector<byte> decode(const std::string& input)
+        {
+            std::vector<byte> decoded;
+            auto e = decode(input, decoded);
+
+            if (e != error::none)
+            {
+                SCHROTT_ID_THROW(std::invalid_argument, error_message(e));
+            }
+
             return decoded;
         }
     }
@@ -147,7 +429,7 @@ namespace schrott_id
     namespace util
     {
         /**
-         * Tests whether a range of elements only contains unique elements.
+         * Tests whether a range of characters or bytes only contains unique elements.
          * @tparam It Iterator type
          * @param begin Range begin
          * @param end Range end
@@ -156,14 +438,18 @@ namespace schrott_id
         template<class It>
         bool is_unique(It begin, It end)
         {
-            std::set<typename It::value_type> set;
+            bool seen[256] = {};
 
             for (auto it = begin; it != end; ++it)
             {
-                if (!set.insert(*it).second)
+                auto& s = seen[static_cast<byte>(*it)];
+
+                if (s)
                 {
                     return false;
                 }
+
+                s = true;
             }
 
             return true;
@@ -172,297 +458,3247 @@ namespace schrott_id
 
     namespace alphabets
     {
-        const char* base64 = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
-        const char* base58 = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
-        const char* base36 = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
-        const char* base32 = "ABCDEFGHIJKLMNOPQRSTUVWXYZ234567";
+        const char* const base64 = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+        const char* const base58 = "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+        const char* const base36 = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+        const char* const base32 = "ABCDEFGHIJKLMNOPQRSTUVWXYZ234567";
     }
 
-    /**
-     * Provides encoding and decoding of SchrottIDs
-     */
-    class schrott_id_encoder
+    namespace detail
     {
-    private:
-        std::string alphabet_;
-        std::map<char, byte> inverse_alphabet_;
-
-        std::vector<byte> permutation_;
-        std::vector<byte> inverse_permutation_;
-
-        int min_length_;
-
-    public:
-
         /**
-         * Creates a new instance of the SchrottID encoder class.
-         *
-         * SchrottIDs can only be decoded if the parameters to this constructor are equal
-         * to the ones that were supplied to create the SchrottID.
-         *
-         * This constructor verifies parameters and creates internal structures.
-         * Instances should be reused as often as possible.
-         * @param alphabet The alphabet that the encoder and decoder will use.
-         * @param permutation The randomly generated permutation to use.
-         * Generate permutations using @see generate_permutation
-         * Permutations are dependent on the supplied alphabet.
-         * @param min_length The minimum length of the encoded ID that the @see encode method will produce.
-         * @throws std::invalid_argument A supplied parameter cannot be used to create an encoder.
+         * Finalizer of splitmix64, spreads every input bit over all output bits.
          */
-        schrott_id_encoder(
-                std::string alphabet,
-                const std::string& permutation,
-                int min_length)
-                : alphabet_(std::move(alphabet)),
-                  min_length_(min_length)
+        inline std::uint64_t mix64(std::uint64_t z)
         {
-            if (alphabet_.size() <= 1
-                || alphabet_.size() > 256)
-            {
-                throw std::invalid_argument("Alphabet must have 2 to 256 characters");
-            }
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            return z ^ (z >> 31);
+        }
 
-            if (!util::is_unique(alphabet_.begin(), alphabet_.end()))
-            {
-                throw std::invalid_argument("Alphabet must have unique characters");
-            }
+        /**
+         * Number of digits the reference implementation uses for a value, without the minimum length.
+         * The reference derives the length from floating point logarithms, which IDs depend on and must be kept.
+         * Where rounding would produce a buffer shorter than the value needs, the real digit count is used.
+         */
+        inline std::size_t reference_digits(std::uint64_t value, std::size_t base)
+        {
+            auto x = value == UINT64_MAX
+                     ? 18446744073709551616.0
+                     : static_cast<double>(value + 1);
+            auto digits = static_cast<std::size_t>(std::ceil(std::log(x) / std::log(base)));
 
-            if (min_length_ <= 0)
+            std::size_t real = 1;
+            for (auto v = value / base; v > 0; v /= base)
             {
-                throw std::invalid_argument("min_length must be greater than 0");
+                ++real;
             }
 
-            for (auto i = 0; i < alphabet_.size(); ++i)
-            {
-                inverse_alphabet_[alphabet_[i]] = i;
-            }
+            return std::max(digits, real);
+        }
 
-            permutation_ = base64::decode(permutation);
+        /**
+         * Divides a little-endian multi-word integer in place.
+         * @return The remainder
+         */
+        inline std::uint32_t div_rem(std::uint64_t* words, std::size_t count, std::uint32_t divisor)
+        {
+            std::uint64_t rem = 0;
 
-            if (permutation_.size() != alphabet_.size())
+            for (auto i = count; i-- > 0;)
             {
-                throw std::invalid_argument("Permutation length must be equal to alphabet length. "
-                                            "Please make sure to use a valid permutation for this alphabet");
-            }
+                auto hi = (rem << 32) | (words[i] >> 32);
+                rem = hi % divisor;
 
-            if (!util::is_unique(permutation_.begin(), permutation_.end()))
-            {
-                throw std::invalid_argument("Invalid permutation. All positions must be unique.");
-            }
+                auto lo = (rem << 32) | (words[i] & 0xFFFFFFFF);
+                rem = lo % divisor;
 
-            if (*std::min_element(permutation_.begin(), permutation_.end()) != 0
-                || *std::max_element(permutation_.begin(), permutation_.end()) != alphabet_.size() - 1)
-            {
-                throw std::invalid_argument("Invalid permutation. Invalid indices for used alphabet.");
+                words[i] = ((hi / divisor) << 32) | (lo / divisor);
             }
 
-            inverse_permutation_.resize(permutation_.size());
-            for (auto i = 0; i < permutation_.size(); ++i)
-            {
-                inverse_permutation_[permutation_[i]] = i;
-            }
+            return static_cast<std::uint32_t>(rem);
         }
 
         /**
-         * Generates a secure random permutation for the supplied alphabet.
-         * @param alphabet The alphabet
-         * @return A randomly generated permutation to use with the @see schrott_id_encoder class
-         * @throws std::invald_argument Alphabet is not between 2 and 256 chars long or chars are not unique.
+         * Copies count bits of a little-endian multi-word integer, starting at bit from, into (count + 63) / 64 words.
          */
-        static std::string generate_permutation(const std::string& alphabet)
+        inline void get_bits(const std::uint64_t* words, std::size_t size, unsigned from, unsigned count,
+                             std::uint64_t* out)
         {
-            if (alphabet.size() <= 1
-                || alphabet.size() > 256)
-            {
-                throw std::invalid_argument("Alphabet must have 2 to 256 characters");
-            }
+            const std::size_t out_words = (count + 63) / 64;
 
-            if (!util::is_unique(alphabet.begin(), alphabet.end()))
+            for (std::size_t i = 0; i < out_words; ++i)
             {
-                throw std::invalid_argument("Alphabet must have unique characters");
-            }
-
-            std::random_device rd;
-            std::uniform_int_distribution<int> distribution(0, alphabet.size() - 1);
+                auto word = (from + i * 64) / 64;
+                auto shift = (from + i * 64) % 64;
 
-            std::vector<byte> permutation(alphabet.size());
+                out[i] = word < size ? words[word] >> shift : 0;
 
-            for (auto i = 0; i < permutation.size(); ++i)
-            {
-                permutation[i] = i;
+                if (shift && word + 1 < size)
+                {
+                    out[i] |= words[word + 1] << (64 - shift);
+                }
             }
 
-            for (auto i = 0; i < permutation.size(); ++i)
+            if (count % 64)
             {
-                auto p = distribution(rd);
-                std::swap(permutation[i], permutation[p]);
+                out[out_words - 1] &= (std::uint64_t{1} << (count % 64)) - 1;
             }
-
-            return base64::encode(permutation);
         }
 
         /**
-         * Encodes an integer value to a SchrottID
-         * @param value The value to encode
-         * @return Encoded SchrottID
+         * Ors the count bits of bits into a little-endian multi-word integer, starting at bit from.
          */
-        std::string encode(std::uint64_t value) const
+        inline void put_bits(std::uint64_t* words, std::size_t size, unsigned from, unsigned count,
+                             const std::uint64_t* bits)
         {
-            auto buf = convert_to_base(value);
-
-            for (auto i = 0; i < buf.size() * 3; ++i)
+            for (std::size_t i = 0; i < (count + 63) / 64; ++i)
             {
-                rotate_left(buf);
-                permute_forward(buf);
-                rotate_left(buf);
-                cascade_forward(buf);
-                rotate_left(buf);
-            }
+                auto word = (from + i * 64) / 64;
+                auto shift = (from + i * 64) % 64;
+
+                words[word] |= bits[i] << shift;
 
-            return convert_to_string(buf);
+                if (shift && word + 1 < size)
+                {
+                    words[word + 1] |= bits[i] >> (64 - shift);
+                }
+            }
         }
 
         /**
-         * Decodes a SchrottID back to an integer value
-         * @param value The value to decode
-         * @return The decoded SchrottID
-         * @throws std::out_of_range The supplied value contains a character that is not present in the alphabet.
+         * Computes words = words * factor + addend in place on a little-endian multi-word integer.
+         * @return The carry out of the most significant word, non-zero if the result did not fit
          */
-        std::uint64_t decode(const std::string& value) const
+        inline std::uint64_t mul_add(std::uint64_t* words, std::size_t count, std::uint32_t factor, std::uint32_t addend)
         {
-            auto buf = convert_from_base(value);
+            std::uint64_t carry = addend;
 
-            for (auto i = 0; i < buf.size() * 3; ++i)
+            for (std::size_t i = 0; i < count; ++i)
             {
-                rotate_right(buf);
-                cascade_backward(buf);
-                rotate_right(buf);
-                permute_backward(buf);
-                rotate_right(buf);
-            }
+                auto lo = (words[i] & 0xFFFFFFFF) * factor + carry;
+                auto hi = (words[i] >> 32) * factor + (lo >> 32);
 
-            return convert_to_value(buf);
-        }
-
-    private:
-
-        std::vector<byte> convert_to_base(std::uint64_t value) const
-        {
-            auto len = std::max(
-                    static_cast<int>(std::ceil(
-                            (std::log(value + 1) / std::log(alphabet_.size())))),
-                    min_length_);
-
-            std::vector<byte> buf(len);
-
-            auto i = buf.size();
-            do
-            {
-                buf[--i] = value % alphabet_.size();
-                value = value / alphabet_.size();
-            } while (value > 0);
+                words[i] = (hi << 32) | (lo & 0xFFFFFFFF);
+                carry = hi >> 32;
+            }
 
-            return buf;
+            return carry;
         }
 
-        std::string convert_to_string(const std::vector<byte>& buf) const
+        /**
+         * Sorts keys and carries their indices along with a least significant digit radix sort on bytes.
+         * Byte positions in which all keys are equal are skipped, so small keys need few passes.
+         * Results end up in keys and indices, scratch_keys and scratch_indices must hold count elements.
+         */
+        inline void radix_sort(
+                std::uint64_t* keys,
+                std::size_t* indices,
+                std::uint64_t* scratch_keys,
+                std::size_t* scratch_indices,
+                std::size_t count)
         {
-            std::string s;
-            s.resize(buf.size());
+            std::vector<std::size_t> histograms(8 * 256);
 
-            for (auto i = 0; i < buf.size(); ++i)
+            for (std::size_t i = 0; i < count; ++i)
             {
-                s[i] = alphabet_[buf[i]];
+                for (auto b = 0; b < 8; ++b)
+                {
+                    ++histograms[b * 256 + ((keys[i] >> (b * 8)) & 0xFF)];
+                }
             }
 
-            return s;
-        }
-
-        std::vector<byte> convert_from_base(const std::string& value) const
-        {
-            std::vector<byte> buf(value.size());
+            auto in_keys = keys;
+            auto in_indices = indices;
+            auto out_keys = scratch_keys;
+            auto out_indices = scratch_indices;
 
-            for (auto i = 0; i < buf.size(); ++i)
+            for (auto b = 0; b < 8; ++b)
             {
-                auto elem = inverse_alphabet_.find(value[i]);
+                auto histogram = &histograms[b * 256];
 
-                if (elem != inverse_alphabet_.end())
+                if (count == 0 || histogram[(in_keys[0] >> (b * 8)) & 0xFF] == count)
                 {
-                    buf[i] = elem->second;
+                    continue;
                 }
-                else
+
+                std::size_t sum = 0;
+                for (auto i = 0; i < 256; ++i)
                 {
-                    throw std::out_of_range("Character not in alphabet");
+                    auto n = histogram[i];
+                    histogram[i] = sum;
+                    sum += n;
                 }
-            }
-
-            return buf;
-        }
-
-        std::uint64_t convert_to_value(const std::vector<byte>& buf) const
-        {
-            std::uint64_t value = 0;
 
-            for (auto i = 0; i < buf.size(); ++i)
-            {
-                if (i > 0)
+                for (std::size_t i = 0; i < count; ++i)
                 {
-                    value *= alphabet_.size();
+                    auto position = histogram[(in_keys[i] >> (b * 8)) & 0xFF]++;
+                    out_keys[position] = in_keys[i];
+                    out_indices[position] = in_indices[i];
                 }
 
-                value += buf[i];
+                std::swap(in_keys, out_keys);
+                std::swap(in_indices, out_indices);
             }
 
-            return value;
-        }
-
-        void permute_forward(std::vector<byte>& buf) const
-        {
-            for (auto i = 0; i < buf.size(); ++i)
+            if (in_keys != keys)
             {
-                buf[i] = permutation_[buf[i]];
+                std::copy(in_keys, in_keys + count, keys);
+                std::copy(in_indices, in_indices + count, indices);
             }
         }
 
-        void permute_backward(std::vector<byte>& buf) const
+        /**
+         * Hints the CPU to load the cache line of p, for inputs that are read a few iterations later.
+         */
+        inline void prefetch(const void* p)
         {
-            for (auto i = 0; i < buf.size(); ++i)
-            {
-                buf[i] = inverse_permutation_[buf[i]];
-            }
+#if defined(__GNUC__) || defined(__clang__)
+            __builtin_prefetch(p);
+#else
+            (void) p;
+#endif
         }
+    }
 
-        void rotate_left(std::vector<byte>& buf) const
+    /**
+     * Position reported by @see schrott_id_encoder::decode_batch_sorted_unique for SchrottIDs that failed to decode
+     */
+    const std::size_t npos = SIZE_MAX;
+
+    /**
+     * Bit layout of a composite key that is packed into a single SchrottID by
+     * @see schrott_id_encoder::encode_tuple. The first field takes the most significant bits.
+     */
+    class tuple_layout
+    {
+    private:
+        std::vector<unsigned> bit_widths_;
+        std::size_t total_bits_;
+
+        tuple_layout(std::vector<unsigned> bit_widths, std::size_t total_bits)
+                : bit_widths_(std::move(bit_widths)),
+                  total_bits_(total_bits)
         {
-            std::rotate(buf.begin(), buf.begin() + 1, buf.end());
         }
 
-        void rotate_right(std::vector<byte>& buf) const
+    public:
+
+        /**
+         * Creates a new tuple layout.
+         * @param bit_widths Number of bits of every field, each between 1 and 64
+         * @throws std::invalid_argument The layout has no fields or a bit width is out of range.
+         */
+        explicit tuple_layout(std::vector<unsigned> bit_widths)
+                : tuple_layout(create(std::move(bit_widths)).value())
         {
-            std::rotate(buf.rbegin(), buf.rbegin() + 1, buf.rend());
         }
 
-        void cascade_forward(std::vector<byte>& buf) const
+        /**
+         * Creates a layout like the constructor, but returns an invalid layout as an error instead of throwing.
+         * @return The layout or error::invalid_tuple_layout
+         */
+        static result<tuple_layout> create(std::vector<unsigned> bit_widths)
         {
-            byte last = 0;
-
-            for (auto& i: buf)
+            if (bit_widths.empty())
             {
-                i = (i + last) % alphabet_.size();
-                last = i;
+                return error::invalid_tuple_layout;
             }
-        }
 
-        void cascade_backward(std::vector<byte>& buf) const
+            std::size_t total_bits = 0;
+
+            for (auto width: bit_widths)
+            {
+                if (width == 0 || width > 64)
+                {
+                    return error::invalid_tuple_layout;
+                }
+
+                total_bits += width;
+            }
+
+            return tuple_layout(std::move(bit_widths), total_bits);
+        }
+
+        std::size_t size() const
+        {
+            return bit_widths_.size();
+        }
+
+        unsigned bit_width(std::size_t field) const
+        {
+            return bit_widths_[field];
+        }
+
+        std::size_t total_bits() const
+        {
+            return total_bits_;
+        }
+
+        std::size_t words() const
+        {
+            return (total_bits_ + 63) / 64;
+        }
+    };
+
+    /**
+     * Number of rounds an encoder runs over an ID of a given length: per_digit * length + fixed, none if it is empty.
+     *
+     * The default is the v3 schedule of 3 rounds per digit that control.txt is generated with.
+     * Fewer rounds encode faster but diffuse less, every other schedule is a separate version.
+     * IDs carry no mark of their schedule: an ID decoded with another schedule decodes without an error
+     * to a different value, so the schedule must be stored alongside alphabet and permutation.
+     */
+    struct round_schedule
+    {
+        std::uint32_t per_digit = 3;
+        std::uint32_t fixed = 0;
+
+        static round_schedule v3()
+        {
+            return round_schedule();
+        }
+
+        /**
+         * Schedule of rounds_per_digit rounds per digit, like length rounds with 1.
+         */
+        static round_schedule per_length(std::uint32_t rounds_per_digit)
+        {
+            round_schedule schedule;
+            schedule.per_digit = rounds_per_digit;
+            return schedule;
+        }
+
+        /**
+         * Schedule of the same number of rounds for every length.
+         */
+        static round_schedule constant(std::uint32_t rounds)
+        {
+            round_schedule schedule;
+            schedule.per_digit = 0;
+            schedule.fixed = rounds;
+            return schedule;
+        }
+
+        std::size_t rounds(std::size_t len) const
+        {
+            // An empty ID has no digits to run rounds on, fixed rounds would rotate it modulo its length of 0
+            return len == 0 ? 0 : per_digit * len + fixed;
+        }
+
+        bool is_v3() const
+        {
+            return per_digit == 3 && fixed == 0;
+        }
+
+        /**
+         * Returns the version tag of the schedule, "v3" or "v3-r" followed by the rounds, like v3-r1L or v3-r8.
+         * The tag is not part of the IDs, it names the schedule for the caller to store with them.
+         */
+        std::string version() const
+        {
+            if (is_v3())
+            {
+                return "v3";
+            }
+
+            std::string tag = "v3-r";
+
+            if (per_digit > 0)
+            {
+                tag += std::to_string(per_digit) + "L";
+            }
+
+            if (fixed > 0)
+            {
+                tag += (per_digit > 0 ? "+" : "") + std::to_string(fixed);
+            }
+
+            return tag;
+        }
+    };
+
+    /**
+     * How an encoder shuffles the digits of 64-bit values.
+     *
+     * cascade is the reference algorithm of control.txt, its cost grows with the square of the ID length.
+     * feistel is a keyed Feistel network over the values of the ID's length with cycle walking,
+     * its cost does not depend on the length. Both keep encoded lengths and are bijective, but their
+     * IDs are unrelated, so the algorithm must be stored alongside alphabet and permutation.
+     */
+    enum class algorithm : std::uint8_t
+    {
+        cascade = 0,
+        feistel
+    };
+
+    class fixed_length_encoder;
+    class prefixed_encoder;
+
+    /**
+     * Provides encoding and decoding of SchrottIDs
+     */
+    class schrott_id_encoder
+    {
+        friend class fixed_length_encoder;
+        friend class prefixed_encoder;
+
+    private:
+        static const std::size_t kStackDigits = 128;
+        static const std::size_t kLanes = 8;
+        static const std::size_t kFeistelRounds = 8;
+
+        // Values of IDs with a given length, [0, max] or, beyond 2^64, [0, limit] as little-endian words,
+        // split into two halves of bits for the Feistel network
+        struct feistel_domain
+        {
+            std::uint64_t max;
+            unsigned high_bits;
+            unsigned low_bits;
+            std::vector<std::uint64_t> limit;
+        };
+
+        std::string alphabet_;
+        std::int16_t inverse_alphabet_[256];
+
+        std::vector<byte> permutation_;
+        std::vector<byte> inverse_permutation_;
+
+        int min_length_;
+        round_schedule schedule_;
+        schrott_id::algorithm algorithm_;
+
+        // feistel_domains_[len] is the domain [0, base^len) of IDs with len digits, up to the longest ID
+        std::vector<feistel_domain> feistel_domains_;
+        std::uint64_t feistel_keys_[kFeistelRounds];
+
+        // length_thresholds_[k] is the smallest value that is encoded with at least k digits
+        std::vector<std::uint64_t> length_thresholds_;
+
+        // Largest power of the base below 2^32, multi-word conversions work in chunks of it
+        std::uint32_t chunk_divisor_;
+        std::size_t chunk_digits_;
+
+        // Bits per digit if the alphabet size is a power of two, 0 otherwise
+        std::size_t digit_bits_;
+
+        // Builds an encoder from parameters that were already validated
+        schrott_id_encoder(
+                std::string alphabet,
+                std::vector<byte> permutation,
+                int min_length,
+                round_schedule schedule,
+                schrott_id::algorithm algorithm)
+                : alphabet_(std::move(alphabet)),
+                  permutation_(std::move(permutation)),
+                  min_length_(min_length),
+                  schedule_(schedule),
+                  algorithm_(algorithm),
+                  feistel_keys_()
+        {
+            std::fill(std::begin(inverse_alphabet_), std::end(inverse_alphabet_), -1);
+            for (auto i = 0; i < alphabet_.size(); ++i)
+            {
+                inverse_alphabet_[static_cast<byte>(alphabet_[i])] = static_cast<std::int16_t>(i);
+            }
+
+            inverse_permutation_.resize(permutation_.size());
+            for (auto i = 0; i < permutation_.size(); ++i)
+            {
+                inverse_permutation_[permutation_[i]] = i;
+            }
+
+            build_length_thresholds();
+
+            chunk_divisor_ = 1;
+            chunk_digits_ = 0;
+            while (chunk_divisor_ <= UINT32_MAX / alphabet_.size())
+            {
+                chunk_divisor_ *= alphabet_.size();
+                ++chunk_digits_;
+            }
+
+            digit_bits_ = 0;
+            if ((alphabet_.size() & (alphabet_.size() - 1)) == 0)
+            {
+                while ((std::size_t{1} << digit_bits_) < alphabet_.size())
+                {
+                    ++digit_bits_;
+                }
+            }
+
+            if (algorithm_ == schrott_id::algorithm::feistel)
+            {
+                build_feistel();
+            }
+        }
+
+        static error validate_alphabet(const std::string& alphabet)
+        {
+            if (alphabet.size() <= 1
+                || alphabet.size() > 256)
+            {
+                return error::invalid_alphabet_size;
+            }
+
+            if (!util::is_unique(alphabet.begin(), alphabet.end()))
+            {
+                return error::duplicate_character;
+            }
+
+            return error::none;
+        }
+
+        static result<schrott_id_encoder> create(
+                std::string alphabet,
+                const std::string& permutation,
+                int min_length,
+                round_schedule schedule,
+                schrott_id::algorithm algorithm)
+        {
+            auto e = validate_alphabet(alphabet);
+
+            if (e == error::none && min_length <= 0)
+            {
+                e = error::invalid_min_length;
+            }
+
+            if (e == error::none && schedule.rounds(1) == 0)
+            {
+                e = error::invalid_schedule;
+            }
+
+            std::vector<byte> bytes;
+
+            if (e == error::none)
+            {
+                e = base64::decode(permutation, bytes);
+            }
+
+            if (e == error::none && bytes.size() != alphabet.size())
+            {
+                e = error::invalid_permutation_length;
+            }
+
+            if (e == error::none && !util::is_unique(bytes.begin(), bytes.end()))
+            {
+                e = error::duplicate_position;
+            }
+
+            if (e == error::none
+                && (*std::min_element(bytes.begin(), bytes.end()) != 0
+                    || *std::max_element(bytes.begin(), bytes.end()) != alphabet.size() - 1))
+            {
+                e = error::invalid_permutation_index;
+            }
+
+            if (e != error::none)
+            {
+                return e;
+            }
+
+            return schrott_id_encoder(std::move(alphabet), std::move(bytes), min_length, schedule, algorithm);
+        }
+
+    public:
+
+        /**
+         * Creates a new instance of the SchrottID encoder class.
+         *
+         * SchrottIDs can only be decoded if the parameters to this constructor are equal
+         * to the ones that were supplied to create the SchrottID.
+         *
+         * This constructor verifies parameters and creates internal structures.
+         * Instances should be reused as often as possible.
+         * @param alphabet The alphabet that the encoder and decoder will use.
+         * @param permutation The randomly generated permutation to use.
+         * Generate permutations using @see generate_permutation
+         * Permutations are dependent on the supplied alphabet.
+         * @param min_length The minimum length of the encoded ID that the @see encode method will produce.
+         * @param schedule Rounds per ID, @see round_schedule. Only v3 IDs match control.txt.
+         * @throws std::invalid_argument A supplied parameter cannot be used to create an encoder.
+         */
+        schrott_id_encoder(
+                std::string alphabet,
+                const std::string& permutation,
+                int min_length,
+                round_schedule schedule = round_schedule::v3())
+                : schrott_id_encoder(create(std::move(alphabet), permutation, min_length, schedule).value())
+        {
+        }
+
+        /**
+         * Creates a new instance of the SchrottID encoder class with a different algorithm than cascade.
+         *
+         * The Feistel network only encodes values of up to 64 bits. Its keys are derived from the permutation.
+         * IDs longer than 64-bit values need, because of a large minimum length, keep leading zero digits.
+         * @param algorithm The algorithm to encode with, @see algorithm
+         * @throws std::invalid_argument A supplied parameter cannot be used to create an encoder.
+         */
+        schrott_id_encoder(
+                std::string alphabet,
+                const std::string& permutation,
+                int min_length,
+                schrott_id::algorithm algorithm)
+                : schrott_id_encoder(create(std::move(alphabet), permutation, min_length, algorithm).value())
+        {
+        }
+
+        /**
+         * Creates an encoder like the constructor, but returns invalid parameters as an error instead of throwing.
+         * @return The encoder or one of the error codes from error::invalid_alphabet_size on
+         */
+        static result<schrott_id_encoder> create(
+                std::string alphabet,
+                const std::string& permutation,
+                int min_length,
+                round_schedule schedule = round_schedule::v3())
+        {
+            return create(std::move(alphabet), permutation, min_length, schedule, schrott_id::algorithm::cascade);
+        }
+
+        /**
+         * Creates an encoder with a different algorithm than cascade, returning invalid parameters as an error.
+         */
+        static result<schrott_id_encoder> create(
+                std::string alphabet,
+                const std::string& permutation,
+                int min_length,
+                schrott_id::algorithm algorithm)
+        {
+            return create(std::move(alphabet), permutation, min_length, round_schedule::v3(), algorithm);
+        }
+
+        /**
+         * Returns the alphabet this encoder was created with.
+         */
+        const std::string& alphabet() const
+        {
+            return alphabet_;
+        }
+
+        /**
+         * Returns the Base64 permutation this encoder was created with.
+         */
+        std::string permutation() const
+        {
+            return base64::encode(permutation_);
+        }
+
+        /**
+         * Returns the minimum length this encoder was created with.
+         */
+        int min_length() const
+        {
+            return min_length_;
+        }
+
+        /**
+         * Returns the round schedule this encoder was created with.
+         */
+        const round_schedule& schedule() const
+        {
+            return schedule_;
+        }
+
+        /**
+         * Returns the algorithm this encoder was created with.
+         */
+        schrott_id::algorithm algorithm() const
+        {
+            return algorithm_;
+        }
+
+        /**
+         * Returns the version tag of the IDs this encoder produces, like v3, v3-r1L or v3-feistel.
+         */
+        std::string version() const
+        {
+            return algorithm_ == schrott_id::algorithm::feistel ? "v3-feistel" : schedule_.version();
+        }
+
+#ifndef SCHROTT_ID_NO_EXCEPTIONS
+        /**
+         * Generates a secure random permutation for the supplied alphabet.
+         * @param alphabet The alphabet
+         * @return A randomly generated permutation to use with the @see schrott_id_encoder class
+         * @throws std::invald_argument Alphabet is not between 2 and 256 chars long or chars are not unique.
+         */
+        static std::string generate_permutation(const std::string& alphabet)
+        {
+            std::random_device random;
+            return generate_permutation(alphabet, random);
+        }
+#endif
+
+        /**
+         * Generates a random permutation for the supplied alphabet from a random source of the caller,
+         * which must be secure for the IDs to be hard to guess. Available without exceptions.
+         * @tparam Random Uniform random bit generator of at least 8 bits, like std::random_device
+         * @param alphabet The alphabet
+         * @return A randomly generated permutation to use with the @see schrott_id_encoder class
+         * @throws std::invald_argument Alphabet is not between 2 and 256 chars long or chars are not unique.
+         */
+        template<class Random>
+        static std::string generate_permutation(const std::string& alphabet, Random& random)
+        {
+            auto e = validate_alphabet(alphabet);
+
+            if (e != error::none)
+            {
+                SCHROTT_ID_THROW(std::invalid_argument, error_message(e));
+            }
+
+            std::vector<byte> permutation(alphabet.size());
+
+            for (auto i = 0; i < permutation.size(); ++i)
+            {
+                permutation[i] = i;
+            }
+
+            // Fisher-Yates, drawing indices by rejection so that every permutation is equally likely
+            const std::uint64_t range = static_cast<std::uint64_t>(Random::max() - Random::min());
+
+            for (auto i = permutation.size() - 1; i > 0; --i)
+            {
+                std::uint64_t bound = i + 1;
+                auto limit = range - (range % bound + 1) % bound;
+                std::uint64_t r;
+
+                do
+                {
+                    r = static_cast<std::uint64_t>(random() - Random::min());
+                } while (r > limit);
+
+                std::swap(permutation[i], permutation[r % bound]);
+            }
+
+            return base64::encode(permutation);
+        }
+
+        /**
+         * Returns the length of the SchrottID that @see encode produces for a value.
+         * @param value The value
+         * @return Length of the encoded SchrottID
+         */
+        std::size_t encoded_length(std::uint64_t value) const
+        {
+            std::size_t len = 1;
+
+            while (len + 1 < length_thresholds_.size()
+                   && value >= length_thresholds_[len + 1])
+            {
+                ++len;
+            }
+
+            return std::max(len, static_cast<std::size_t>(min_length_));
+        }
+
+        /**
+         * Returns the length of the longest SchrottID this encoder can produce.
+         * Buffers of count * max_encoded_length() characters can hold any batch of count IDs.
+         * @return Maximum length of an encoded SchrottID
+         */
+        std::size_t max_encoded_length() const
+        {
+            return encoded_length(UINT64_MAX);
+        }
+
+        /**
+         * Encodes an integer value to a SchrottID
+         * @param value The value to encode
+         * @return Encoded SchrottID
+         */
+        std::string encode(std::uint64_t value) const
+        {
+            std::string s(encoded_length(value), '\0');
+            encode_to(value, &s[0], s.size());
+            return s;
+        }
+
+        /**
+         * Encodes an integer value to a SchrottID into a caller-owned buffer.
+         * @param value The value to encode
+         * @param out Output buffer, not null-terminated
+         * @param out_size Size of the output buffer
+         * @return Number of characters written, 0 if the buffer is smaller than @see encoded_length
+         */
+        std::size_t encode_to(std::uint64_t value, char* out, std::size_t out_size) const
+        {
+            SCHROTT_ID_MEASURE(encode, value);
+
+            auto len = encoded_length(value);
+
+            if (len > out_size)
+            {
+                SCHROTT_ID_COUNT_ERROR(error::buffer_too_small);
+                return 0;
+            }
+
+            SCHROTT_ID_COUNT_IDS(len, 1);
+
+            auto buf = reinterpret_cast<byte*>(out);
+
+            if (algorithm_ == schrott_id::algorithm::feistel)
+            {
+                feistel_encode(value, buf, len);
+            }
+            else
+            {
+                convert_to_base(value, buf, len);
+                rounds_forward(buf, len);
+            }
+
+            convert_to_string(buf, len);
+
+            return len;
+        }
+
+        /**
+         * Decodes a SchrottID back to an integer value
+         * @param value The value to decode
+         * @return The decoded SchrottID
+         * @throws std::out_of_range The supplied value contains a character that is not present in the alphabet
+         * or, with the Feistel algorithm, does not stand for a 64-bit value.
+         */
+        std::uint64_t decode(const std::string& value) const
+        {
+            std::uint64_t result;
+            auto e = try_decode(value.data(), value.size(), result);
+
+            if (e != error::none)
+            {
+                SCHROTT_ID_THROW(std::out_of_range, error_message(e));
+            }
+
+            return result;
+        }
+
+#ifdef __SIZEOF_INT128__
+
+        /**
+         * Encodes a 128-bit integer value to a SchrottID.
+         * Values below 2^64 produce the same SchrottID as the 64-bit overload.
+         * @param value The value to encode
+         * @return Encoded SchrottID
+         */
+        template<class T, typename std::enable_if<std::is_same<T, unsigned __int128>::value, int>::type = 0>
+        std::string encode(T value) const
+        {
+            std::uint64_t words[] = {static_cast<std::uint64_t>(value), static_cast<std::uint64_t>(value >> 64)};
+            return encode_words(words, 2);
+        }
+
+        /**
+         * Decodes a SchrottID back to a 128-bit integer value
+         * @param value The value to decode
+         * @return The decoded SchrottID
+         * @throws std::out_of_range The supplied value contains a character that is not present in the alphabet
+         * or does not fit into 128 bits.
+         */
+        unsigned __int128 decode128(const std::string& value) const
+        {
+            std::uint64_t words[2];
+            auto e = decode_words(value.data(), value.size(), words, 2);
+
+            if (e != error::none)
+            {
+                SCHROTT_ID_THROW(std::out_of_range, error_message(e));
+            }
+
+            return (static_cast<unsigned __int128>(words[1]) << 64) | words[0];
+        }
+
+#endif
+
+        /**
+         * Encodes a fixed-width unsigned integer given as an array of 64-bit words to a SchrottID.
+         *
+         * Values below 2^64 produce the same SchrottID as @see encode, larger values use
+         * as many digits as the value needs, but at least the minimum length.
+         * @param words Words of the value, least significant first
+         * @param count Number of words
+         * @return Encoded SchrottID
+         * @throws std::invalid_argument The value needs more than 64 bits and the algorithm is feistel.
+         */
+        std::string encode_words(const std::uint64_t* words, std::size_t count) const
+        {
+            // Every word takes at most 64 digits of a base of 2 or more
+            std::string s(std::max(count * 64, static_cast<std::size_t>(min_length_)), '\0');
+            std::size_t written = 0;
+
+            if (encode_words(words, count, &s[0], s.size(), written) != error::none)
+            {
+                SCHROTT_ID_THROW(std::invalid_argument, "The Feistel algorithm only encodes values of up to 64 bits");
+            }
+
+            s.resize(written);
+            return s;
+        }
+
+        /**
+         * Encodes a fixed-width unsigned integer given as an array of 64-bit words into a buffer
+         * @see encode_words
+         * @param out Output buffer, not null-terminated
+         * @param out_size Size of the output buffer
+         * @param written Receives the number of characters written
+         * @return error::none, error::buffer_too_small or error::range_overflow if the value needs more than
+         * 64 bits and the algorithm is feistel
+         */
+        error encode_words(const std::uint64_t* words, std::size_t count, char* out, std::size_t out_size,
+                           std::size_t& written) const
+        {
+            written = 0;
+
+            auto n = count;
+            while (n > 0 && words[n - 1] == 0)
+            {
+                --n;
+            }
+
+            if (n <= 1)
+            {
+                written = encode_to(n ? words[0] : 0, out, out_size);
+                return written ? error::none : error::buffer_too_small;
+            }
+
+            if (algorithm_ == schrott_id::algorithm::feistel)
+            {
+                return error::range_overflow;
+            }
+
+            // Divide by the largest power of the base that fits into 32 bits and split each
+            // remainder into digits, least significant digit first
+            std::vector<std::uint64_t> value(words, words + n);
+            std::vector<byte> digits;
+            digits.reserve(n * 64);
+
+            while (n > 0)
+            {
+                auto rem = detail::div_rem(value.data(), n, chunk_divisor_);
+
+                while (n > 0 && value[n - 1] == 0)
+                {
+                    --n;
+                }
+
+                for (std::size_t k = 0; k < chunk_digits_ && (n > 0 || rem > 0); ++k)
+                {
+                    digits.push_back(rem % alphabet_.size());
+                    rem /= alphabet_.size();
+                }
+            }
+
+            auto len = std::max(digits.size(), static_cast<std::size_t>(min_length_));
+
+            if (len > out_size)
+            {
+                return error::buffer_too_small;
+            }
+
+            auto buf = reinterpret_cast<byte*>(out);
+
+            std::fill(buf, buf + len - digits.size(), 0);
+            std::reverse_copy(digits.begin(), digits.end(), buf + len - digits.size());
+            rounds_forward(buf, len);
+            convert_to_string(buf, len);
+
+            written = len;
+            return error::none;
+        }
+
+        /**
+         * Decodes a SchrottID back to a fixed-width unsigned integer given as an array of 64-bit words.
+         * @param data Characters of the SchrottID
+         * @param size Number of characters
+         * @param words Receives the words of the value, least significant first
+         * @param count Number of words
+         * @return error::none, error::invalid_character or error::range_overflow if the value does not fit
+         */
+        error decode_words(const char* data, std::size_t size, std::uint64_t* words, std::size_t count) const
+        {
+            if (algorithm_ == schrott_id::algorithm::feistel)
+            {
+                std::fill(words, words + count, 0);
+                return count ? try_decode(data, size, words[0]) : error::range_overflow;
+            }
+
+            std::vector<byte> buf(size);
+
+            if (!convert_from_base(data, size, buf.data()))
+            {
+                return error::invalid_character;
+            }
+
+            rounds_backward(buf.data(), size);
+
+            std::fill(words, words + count, 0);
+
+            // Fold digits in chunks, the first chunk takes the digits that do not fill a whole chunk
+            auto chunk = size % chunk_digits_ ? size % chunk_digits_ : chunk_digits_;
+
+            for (std::size_t i = 0; i < size; i += chunk, chunk = chunk_digits_)
+            {
+                std::uint32_t factor = 1;
+                std::uint32_t addend = 0;
+
+                for (std::size_t k = i; k < i + chunk; ++k)
+                {
+                    factor *= alphabet_.size();
+                    addend = addend * alphabet_.size() + buf[k];
+                }
+
+                if (detail::mul_add(words, count, factor, addend))
+                {
+                    return error::range_overflow;
+                }
+            }
+
+            return error::none;
+        }
+
+        /**
+         * Returns the length of the SchrottID that @see encode_bytes produces for a byte string.
+         * The length only depends on the number of bytes, the minimum length does not apply.
+         * @param size Number of bytes
+         * @return Length of the encoded SchrottID
+         */
+        std::size_t encoded_bytes_length(std::size_t size) const
+        {
+            if (digit_bits_)
+            {
+                return (size * 8 + digit_bits_ - 1) / digit_bits_;
+            }
+
+            // One digit more than 8 * size / log2(base) is always enough, since a power of
+            // this base is never a power of two. The bias keeps rounding errors on the safe side.
+            return static_cast<std::size_t>(std::floor(
+                    static_cast<double>(size) * 8 / std::log2(static_cast<double>(alphabet_.size())) + 1e-9)) + 1;
+        }
+
+        /**
+         * Encodes a byte string, such as a UUID or a hash, to a SchrottID.
+         * Leading zero bytes are kept, so @see decode_bytes restores the exact byte string.
+         * @param data Bytes to encode, most significant first
+         * @param size Number of bytes
+         * @return Encoded SchrottID
+         * @throws std::invalid_argument The algorithm is feistel, which does not encode byte strings.
+         */
+        std::string encode_bytes(const byte* data, std::size_t size) const
+        {
+            if (algorithm_ == schrott_id::algorithm::feistel)
+            {
+                SCHROTT_ID_THROW(std::invalid_argument, "The Feistel algorithm does not encode byte strings");
+            }
+
+            std::string s(encoded_bytes_length(size), '\0');
+            auto buf = reinterpret_cast<byte*>(&s[0]);
+
+            if (digit_bits_)
+            {
+                bytes_to_digits_sliced(data, size, buf, s.size());
+            }
+            else
+            {
+                bytes_to_digits_divided(data, size, buf, s.size());
+            }
+
+            rounds_forward(buf, s.size());
+            convert_to_string(buf, s.size());
+
+            return s;
+        }
+
+        /**
+         * Encodes a byte string to a SchrottID
+         * @see encode_bytes
+         */
+        std::string encode_bytes(const std::vector<byte>& bytes) const
+        {
+            return encode_bytes(bytes.data(), bytes.size());
+        }
+
+#if __cplusplus >= 202002L
+
+        /**
+         * Encodes a byte string to a SchrottID
+         * @see encode_bytes
+         */
+        std::string encode_bytes(std::span<const byte> bytes) const
+        {
+            return encode_bytes(bytes.data(), bytes.size());
+        }
+
+#endif
+
+        /**
+         * Decodes a SchrottID created by @see encode_bytes back to its byte string.
+         * @param data Characters of the SchrottID
+         * @param size Number of characters
+         * @param bytes Receives the decoded bytes
+         * @return error::none, error::invalid_character, error::invalid_length if no byte string
+         * encodes to this length or error::range_overflow if the value does not fit or the algorithm is feistel
+         */
+        error decode_bytes(const char* data, std::size_t size, std::vector<byte>& bytes) const
+        {
+            if (algorithm_ == schrott_id::algorithm::feistel)
+            {
+                return error::range_overflow;
+            }
+
+            // Byte count whose encoded length is size, lengths grow by at least one digit per byte
+            auto count = static_cast<std::size_t>(
+                    static_cast<double>(size) * std::log2(static_cast<double>(alphabet_.size())) / 8);
+
+            while (count > 0 && encoded_bytes_length(count) > size)
+            {
+                --count;
+            }
+
+            while (encoded_bytes_length(count) < size)
+            {
+                ++count;
+            }
+
+            if (encoded_bytes_length(count) != size)
+            {
+                return error::invalid_length;
+            }
+
+            std::vector<byte> buf(size);
+
+            if (!convert_from_base(data, size, buf.data()))
+            {
+                return error::invalid_character;
+            }
+
+            rounds_backward(buf.data(), size);
+
+            bytes.resize(count);
+
+            auto fits = digit_bits_
+                        ? digits_to_bytes_sliced(buf.data(), size, bytes.data(), count)
+                        : digits_to_bytes_multiplied(buf.data(), size, bytes.data(), count);
+
+            return fits ? error::none : error::range_overflow;
+        }
+
+        /**
+         * Decodes a SchrottID created by @see encode_bytes back to its byte string
+         * @param value The value to decode
+         * @return The decoded bytes
+         * @throws std::out_of_range The supplied value contains a character that is not present in the alphabet
+         * or is not a valid encoded byte string.
+         */
+        std::vector<byte> decode_bytes(const std::string& value) const
+        {
+            std::vector<byte> bytes;
+            auto e = decode_bytes(value.data(), value.size(), bytes);
+
+            if (e != error::none)
+            {
+                SCHROTT_ID_THROW(std::out_of_range, error_message(e));
+            }
+
+            return bytes;
+        }
+
+        /**
+         * Packs the fields of a composite key into one value and encodes it to a SchrottID.
+         *
+         * Layouts of up to 64 bits produce the same SchrottID as @see encode for the packed value,
+         * wider layouts the same as @see encode_words.
+         * @param layout Bit widths of the fields
+         * @param fields One value per field of the layout
+         * @return Encoded SchrottID
+         * @throws std::invalid_argument A field does not fit into its bit width.
+         */
+        std::string encode_tuple(const tuple_layout& layout, const std::uint64_t* fields) const
+        {
+            std::uint64_t stack[4] = {};
+            std::vector<std::uint64_t> heap;
+            auto words = tuple_words(layout, stack, heap);
+
+            if (!pack_tuple(layout, fields, words))
+            {
+                SCHROTT_ID_THROW(std::invalid_argument, "Field does not fit into its bit width");
+            }
+
+            return layout.words() == 1
+                   ? encode(words[0])
+                   : encode_words(words, layout.words());
+        }
+
+        /**
+         * Packs the fields of a composite key into one value and encodes it into a buffer
+         * @see encode_tuple
+         * @param out Output buffer, not null-terminated
+         * @param out_size Size of the output buffer
+         * @param written Receives the number of characters written
+         * @return error::none, error::buffer_too_small or error::range_overflow if a field does not fit into its
+         * bit width or the layout is wider than 64 bits and the algorithm is feistel
+         */
+        error encode_tuple(const tuple_layout& layout, const std::uint64_t* fields, char* out, std::size_t out_size,
+                           std::size_t& written) const
+        {
+            written = 0;
+
+            std::uint64_t stack[4] = {};
+            std::vector<std::uint64_t> heap;
+            auto words = tuple_words(layout, stack, heap);
+
+            if (!pack_tuple(layout, fields, words))
+            {
+                return error::range_overflow;
+            }
+
+            return encode_words(words, layout.words(), out, out_size, written);
+        }
+
+        /**
+         * Packs the fields of a composite key into one value and encodes it to a SchrottID
+         * @see encode_tuple
+         */
+        std::string encode_tuple(const tuple_layout& layout, std::initializer_list<std::uint64_t> fields) const
+        {
+            if (fields.size() != layout.size())
+            {
+                SCHROTT_ID_THROW(std::invalid_argument, "Number of fields must match the tuple layout");
+            }
+
+            return encode_tuple(layout, fields.begin());
+        }
+
+        /**
+         * Decodes a SchrottID created by @see encode_tuple back to the fields of the composite key.
+         * @param layout Bit widths of the fields, must be the layout used to encode
+         * @param data Characters of the SchrottID
+         * @param size Number of characters
+         * @param fields Receives one value per field of the layout
+         * @return error::none, error::invalid_character or error::range_overflow if the value is wider than the layout
+         */
+        error decode_tuple(const tuple_layout& layout, const char* data, std::size_t size, std::uint64_t* fields) const
+        {
+            std::uint64_t stack[4];
+            std::vector<std::uint64_t> heap;
+            auto words = stack;
+
+            if (layout.words() > 4)
+            {
+                heap.resize(layout.words());
+                words = heap.data();
+            }
+
+            auto e = layout.words() == 1
+                     ? try_decode_checked(data, size, words[0])
+                     : decode_words(data, size, words, layout.words());
+
+            if (e != error::none)
+            {
+                return e;
+            }
+
+            if (layout.total_bits() % 64
+                && words[layout.words() - 1] >> (layout.total_bits() % 64))
+            {
+                return error::range_overflow;
+            }
+
+            std::size_t position = 0;
+
+            for (auto i = layout.size(); i-- > 0;)
+            {
+                auto width = layout.bit_width(i);
+                auto shift = position % 64;
+                auto value = words[position / 64] >> shift;
+
+                if (shift + width > 64)
+                {
+                    value |= words[position / 64 + 1] << (64 - shift);
+                }
+
+                fields[i] = width < 64 ? value & ((std::uint64_t{1} << width) - 1) : value;
+                position += width;
+            }
+
+            return error::none;
+        }
+
+        /**
+         * Decodes a SchrottID created by @see encode_tuple back to the fields of the composite key
+         * @param layout Bit widths of the fields, must be the layout used to encode
+         * @param value The value to decode
+         * @return One value per field of the layout
+         * @throws std::out_of_range The supplied value contains a character that is not present in the alphabet
+         * or does not fit into the layout.
+         */
+        std::vector<std::uint64_t> decode_tuple(const tuple_layout& layout, const std::string& value) const
+        {
+            std::vector<std::uint64_t> fields(layout.size());
+            auto e = decode_tuple(layout, value.data(), value.size(), fields.data());
+
+            if (e != error::none)
+            {
+                SCHROTT_ID_THROW(std::out_of_range, error_message(e));
+            }
+
+            return fields;
+        }
+
+        /**
+         * Decodes a SchrottID back to an integer value without throwing on invalid input.
+         * @param data Characters of the SchrottID
+         * @param size Number of characters
+         * @param value Receives the decoded value on success
+         * @return error::none, error::invalid_character or, for the feistel algorithm, error::range_overflow
+         * if the SchrottID stands for a value beyond 64 bits
+         */
+        error try_decode(const char* data, std::size_t size, std::uint64_t& value) const
+        {
+            SCHROTT_ID_MEASURE(decode, size);
+            SCHROTT_ID_COUNT_IDS(size, 1);
+
+            auto e = algorithm_ == schrott_id::algorithm::feistel
+                     ? try_decode_feistel(data, size, value)
+                     : try_decode_cascade(data, size, value);
+
+            SCHROTT_ID_COUNT_ERROR(e);
+
+            return e;
+        }
+
+        /**
+         * Encodes a batch of values into a caller-owned character buffer.
+         *
+         * IDs are written back to back without separators. The i-th ID occupies
+         * out[offsets[i]] to out[offsets[i + 1]], so offsets must have room for count + 1 elements.
+         * A buffer of count * @see max_encoded_length characters is always large enough.
+         * @param values Values to encode
+         * @param count Number of values
+         * @param out Output character buffer
+         * @param out_size Size of the output buffer
+         * @param offsets Receives count + 1 offsets into out
+         * @return error::none or error::buffer_too_small, in which case out and offsets are incomplete
+         */
+        error encode_batch(
+                const std::uint64_t* values,
+                std::size_t count,
+                char* out,
+                std::size_t out_size,
+                std::size_t* offsets) const
+        {
+            SCHROTT_ID_MEASURE(encode_batch, count);
+
+            std::size_t pos = 0;
+            offsets[0] = 0;
+
+            if (algorithm_ == schrott_id::algorithm::feistel)
+            {
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    auto len = encode_to(values[i], out + pos, out_size - pos);
+
+                    if (len == 0)
+                    {
+                        SCHROTT_ID_COUNT_ERROR(error::buffer_too_small);
+                        return error::buffer_too_small;
+                    }
+
+                    SCHROTT_ID_COUNT_IDS(len, 1);
+
+                    pos += len;
+                    offsets[i + 1] = pos;
+                }
+
+                return error::none;
+            }
+
+            for (std::size_t i = 0; i < count;)
+            {
+                // Collect a run of IDs with the same length and encode them in one go
+                auto len = encoded_length(values[i]);
+                auto buf = reinterpret_cast<byte*>(out + pos);
+                std::size_t run = 0;
+
+                while (i + run < count
+                       && encoded_length(values[i + run]) == len)
+                {
+                    if (out_size - pos < len)
+                    {
+                        SCHROTT_ID_COUNT_ERROR(error::buffer_too_small);
+                        return error::buffer_too_small;
+                    }
+
+                    convert_to_base(values[i + run], buf + run * len, len);
+                    pos += len;
+                    offsets[i + run + 1] = pos;
+                    ++run;
+                }
+
+                SCHROTT_ID_COUNT_IDS(len, run);
+
+                rounds_forward_batch(buf, len, run);
+                convert_to_string(buf, run * len);
+
+                i += run;
+            }
+
+            return error::none;
+        }
+
+        /**
+         * Encodes the consecutive values start, start + 1, ..., start + count - 1.
+         *
+         * Produces the same output as @see encode_batch but increments the digits instead of
+         * converting every value, so base conversion drops out of the per-ID cost.
+         * @param start First value
+         * @param count Number of values
+         * @param out Output character buffer
+         * @param out_size Size of the output buffer
+         * @param offsets Receives count + 1 offsets into out
+         * @return error::none, error::buffer_too_small or error::range_overflow if the range exceeds the largest value
+         */
+        error encode_range(
+                std::uint64_t start,
+                std::size_t count,
+                char* out,
+                std::size_t out_size,
+                std::size_t* offsets) const
+        {
+            SCHROTT_ID_MEASURE(encode_batch, count);
+
+            offsets[0] = 0;
+
+            if (count == 0)
+            {
+                return error::none;
+            }
+
+            if (count - 1 > UINT64_MAX - start)
+            {
+                SCHROTT_ID_COUNT_ERROR(error::range_overflow);
+                return error::range_overflow;
+            }
+
+            if (algorithm_ == schrott_id::algorithm::feistel)
+            {
+                // Neighbouring values share no digits after the Feistel network, encode them one by one
+                std::size_t pos = 0;
+
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    auto len = encode_to(start + i, out + pos, out_size - pos);
+
+                    if (len == 0)
+                    {
+                        SCHROTT_ID_COUNT_ERROR(error::buffer_too_small);
+                        return error::buffer_too_small;
+                    }
+
+                    SCHROTT_ID_COUNT_IDS(len, 1);
+
+                    pos += len;
+                    offsets[i + 1] = pos;
+                }
+
+                return error::none;
+            }
+
+            // Digits are kept right-aligned in a buffer wide enough for every value, so
+            // growing the length only widens the window that is copied out.
+            auto width = max_encoded_length();
+            byte stack[kStackDigits];
+            std::vector<byte> heap;
+            auto digits = stack;
+
+            if (width > kStackDigits)
+            {
+                heap.resize(width);
+                digits = heap.data();
+            }
+
+            convert_to_base(start, digits, width);
+
+            std::size_t pos = 0;
+
+            for (std::size_t i = 0; i < count;)
+            {
+                auto value = start + i;
+                auto len = encoded_length(value);
+
+                // The run ends before the next length threshold, so all of its IDs have the same length
+                // and it fits into what is left of out
+                auto run = count - i;
+                if (len + 1 < length_thresholds_.size())
+                {
+                    run = std::min<std::uint64_t>(run, length_thresholds_[len + 1] - value);
+                }
+
+                run = std::min(run, (out_size - pos) / len);
+
+                if (run == 0)
+                {
+                    SCHROTT_ID_COUNT_ERROR(error::buffer_too_small);
+                    return error::buffer_too_small;
+                }
+
+                SCHROTT_ID_COUNT_IDS(len, run);
+
+                auto buf = reinterpret_cast<byte*>(out + pos);
+
+                for (std::size_t j = 0; j < run; ++j)
+                {
+                    std::copy(digits + width - len, digits + width, buf + j * len);
+                    pos += len;
+                    offsets[i + j + 1] = pos;
+
+                    if (i + j + 1 < count)
+                    {
+                        increment(digits, width);
+                    }
+                }
+
+                rounds_forward_batch(buf, len, run);
+                convert_to_string(buf, run * len);
+
+                i += run;
+            }
+
+            return error::none;
+        }
+
+        /**
+         * Decodes a batch of SchrottIDs stored back to back in a character buffer.
+         * @param chars Characters of all SchrottIDs
+         * @param offsets count + 1 offsets, the i-th ID occupies chars[offsets[i]] to chars[offsets[i + 1]]
+         * @param count Number of SchrottIDs
+         * @param values Receives the decoded values, 0 for IDs that failed to decode
+         * @param errors Receives an error code per ID, may be null
+         * @return Number of SchrottIDs that failed to decode
+         */
+        std::size_t decode_batch(
+                const char* chars,
+                const std::size_t* offsets,
+                std::size_t count,
+                std::uint64_t* values,
+                error* errors) const
+        {
+            SCHROTT_ID_MEASURE(decode_batch, count);
+
+            std::size_t failed = 0;
+            byte bufs[kStackDigits * kLanes];
+            std::size_t indices[kLanes];
+
+            for (std::size_t i = 0; i < count;)
+            {
+                auto len = offsets[i + 1] - offsets[i];
+
+                if (len == 0 || len > kStackDigits || algorithm_ == schrott_id::algorithm::feistel)
+                {
+                    failed += decode_one(chars + offsets[i], len, values[i], errors ? &errors[i] : nullptr);
+                    ++i;
+                    continue;
+                }
+
+                // Collect up to kLanes valid IDs of the same length and decode them in one go
+                std::size_t n = 0;
+
+                for (; i < count && n < kLanes && offsets[i + 1] - offsets[i] == len; ++i)
+                {
+                    SCHROTT_ID_COUNT_IDS(len, 1);
+
+                    if (convert_from_base(chars + offsets[i], len, bufs + n * len))
+                    {
+                        indices[n++] = i;
+                    }
+                    else
+                    {
+                        SCHROTT_ID_COUNT_ERROR(error::invalid_character);
+
+                        values[i] = 0;
+                        ++failed;
+
+                        if (errors)
+                        {
+                            errors[i] = error::invalid_character;
+                        }
+                    }
+                }
+
+                rounds_backward_batch(bufs, len, n);
+
+                for (std::size_t j = 0; j < n; ++j)
+                {
+                    values[indices[j]] = convert_to_value(bufs + j * len, len);
+
+                    if (errors)
+                    {
+                        errors[indices[j]] = error::none;
+                    }
+                }
+            }
+
+            return failed;
+        }
+
+#if __cplusplus >= 201703L
+
+        /**
+         * Decodes a batch of SchrottIDs scattered in memory, like parsed JSON strings or request parameters.
+         *
+         * Prefetches the characters of upcoming IDs and stages the IDs by length, so IDs of one length are
+         * decoded kLanes at a time like in @see decode_batch even if other lengths come between them.
+         * @param ids The SchrottIDs
+         * @param count Number of SchrottIDs
+         * @param values Receives the decoded values, 0 for IDs that failed to decode
+         * @param errors Receives an error code per ID, may be null
+         * @return Number of SchrottIDs that failed to decode
+         */
+        std::size_t decode_batch(
+                const std::string_view* ids,
+                std::size_t count,
+                std::uint64_t* values,
+                error* errors) const
+        {
+            SCHROTT_ID_MEASURE(decode_batch, count);
+
+            // Lengths staged at the same time and how many IDs ahead to prefetch
+            const std::size_t kGroups = 4;
+            const std::size_t kPrefetch = 8;
+
+            struct group
+            {
+                std::size_t len;
+                std::size_t n;
+                std::size_t indices[kLanes];
+            };
+
+            alignas(64) byte bufs[kGroups][kStackDigits * kLanes];
+            group groups[kGroups];
+            std::size_t open = 0;
+            std::size_t failed = 0;
+
+            auto flush = [&](std::size_t g)
+            {
+                auto& staged = groups[g];
+                rounds_backward_batch(bufs[g], staged.len, staged.n);
+
+                for (std::size_t j = 0; j < staged.n; ++j)
+                {
+                    values[staged.indices[j]] = convert_to_value(bufs[g] + j * staged.len, staged.len);
+
+                    if (errors)
+                    {
+                        errors[staged.indices[j]] = error::none;
+                    }
+                }
+
+                staged.n = 0;
+            };
+
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                if (i + kPrefetch < count)
+                {
+                    detail::prefetch(ids[i + kPrefetch].data());
+                }
+
+                auto id = ids[i];
+                auto len = id.size();
+
+                if (len == 0 || len > kStackDigits || algorithm_ == schrott_id::algorithm::feistel)
+                {
+                    failed += decode_one(id.data(), len, values[i], errors ? &errors[i] : nullptr);
+                    continue;
+                }
+
+                std::size_t g = 0;
+
+                while (g < open && groups[g].len != len)
+                {
+                    ++g;
+                }
+
+                // With all groups taken by other lengths, the fullest one is decoded and takes the new length
+                if (g == kGroups)
+                {
+                    g = 0;
+
+                    for (std::size_t k = 1; k < kGroups; ++k)
+                    {
+                        if (groups[k].n > groups[g].n)
+                        {
+                            g = k;
+                        }
+                    }
+
+                    flush(g);
+                    groups[g].len = len;
+                }
+                else if (g == open)
+                {
+                    groups[g].len = len;
+                    groups[g].n = 0;
+                    ++open;
+                }
+
+                SCHROTT_ID_COUNT_IDS(len, 1);
+
+                auto& staged = groups[g];
+
+                if (convert_from_base(id.data(), len, bufs[g] + staged.n * len))
+                {
+                    staged.indices[staged.n++] = i;
+
+                    if (staged.n == kLanes)
+                    {
+                        flush(g);
+                    }
+                }
+                else
+                {
+                    SCHROTT_ID_COUNT_ERROR(error::invalid_character);
+
+                    values[i] = 0;
+                    ++failed;
+
+                    if (errors)
+                    {
+                        errors[i] = error::invalid_character;
+                    }
+                }
+            }
+
+            for (std::size_t g = 0; g < open; ++g)
+            {
+                flush(g);
+            }
+
+            return failed;
+        }
+
+#endif
+
+        /**
+         * Decodes a batch of SchrottIDs into sorted, unique values, for example for database IN queries.
+         *
+         * Decodes like @see decode_batch, then radix sorts and deduplicates the values and records for
+         * every SchrottID where its value ended up, so responses can be put back into request order.
+         * @param chars Characters of all SchrottIDs
+         * @param offsets count + 1 offsets, the i-th ID occupies chars[offsets[i]] to chars[offsets[i + 1]]
+         * @param count Number of SchrottIDs
+         * @param values Receives the sorted, unique values, must have room for count elements
+         * @param positions Receives, for every SchrottID, the index of its value in values or @see npos if it failed
+         * @param errors Receives an error code per ID, may be null
+         * @return Number of unique values written to values
+         */
+        std::size_t decode_batch_sorted_unique(
+                const char* chars,
+                const std::size_t* offsets,
+                std::size_t count,
+                std::uint64_t* values,
+                std::size_t* positions,
+                error* errors) const
+        {
+            std::vector<error> own_errors(errors ? 0 : count);
+            if (!errors)
+            {
+                errors = own_errors.data();
+            }
+
+            decode_batch(chars, offsets, count, values, errors);
+
+            // Compact the decoded values together with the index of the SchrottID they came from
+            std::vector<std::size_t> indices(count);
+            std::size_t n = 0;
+
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                positions[i] = npos;
+
+                if (errors[i] == error::none)
+                {
+                    values[n] = values[i];
+                    indices[n++] = i;
+                }
+            }
+
+            std::vector<std::uint64_t> scratch_keys(n);
+            std::vector<std::size_t> scratch_indices(n);
+
+            detail::radix_sort(values, indices.data(), scratch_keys.data(), scratch_indices.data(), n);
+
+            std::size_t unique = 0;
+
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                if (unique == 0 || values[unique - 1] != values[i])
+                {
+                    values[unique++] = values[i];
+                }
+
+                positions[indices[i]] = unique - 1;
+            }
+
+            return unique;
+        }
+
+        /**
+         * Encodes a batch of values into fixed-width records, for example for columnar storage.
+         *
+         * Every ID takes width characters, shorter IDs are padded with NUL characters at the end.
+         * @param values Values to encode
+         * @param count Number of values
+         * @param out Output buffer of count * width characters
+         * @param width Characters per record, at least the length of the longest ID, like max_encoded_length()
+         * @return error::none or error::buffer_too_small if an ID is longer than width, out is then incomplete
+         */
+        error encode_records(const std::uint64_t* values, std::size_t count, char* out, std::size_t width) const
+        {
+            const std::size_t kChunk = 256;
+            std::vector<char> chars(kChunk * max_encoded_length());
+            std::size_t offsets[kChunk + 1];
+
+            for (std::size_t first = 0; first < count; first += kChunk)
+            {
+                auto n = std::min(kChunk, count - first);
+                encode_batch(values + first, n, chars.data(), chars.size(), offsets);
+
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    auto len = offsets[i + 1] - offsets[i];
+                    auto record = out + (first + i) * width;
+
+                    if (len > width)
+                    {
+                        return error::buffer_too_small;
+                    }
+
+                    std::memcpy(record, chars.data() + offsets[i], len);
+                    std::memset(record + len, 0, width - len);
+                }
+            }
+
+            return error::none;
+        }
+
+        /**
+         * Decodes fixed-width records written by @see encode_records. An ID ends at the first NUL character
+         * of its record or at the end of the record.
+         * @param records count * width characters
+         * @param count Number of records
+         * @param width Characters per record
+         * @param values Receives the decoded values, 0 for IDs that failed to decode
+         * @param errors Receives an error code per ID, may be null
+         * @return Number of SchrottIDs that failed to decode
+         */
+        std::size_t decode_records(
+                const char* records,
+                std::size_t count,
+                std::size_t width,
+                std::uint64_t* values,
+                error* errors) const
+        {
+            const std::size_t kChunk = 256;
+            std::vector<char> chars(kChunk * width);
+            std::size_t offsets[kChunk + 1];
+            std::size_t failed = 0;
+
+            for (std::size_t first = 0; first < count; first += kChunk)
+            {
+                auto n = std::min(kChunk, count - first);
+                offsets[0] = 0;
+
+                // Drop the padding so the IDs of the chunk lie back to back
+                for (std::size_t i = 0; i < n; ++i)
+                {
+                    auto record = records + (first + i) * width;
+                    auto nul = static_cast<const char*>(std::memchr(record, 0, width));
+                    auto len = nul ? static_cast<std::size_t>(nul - record) : width;
+
+                    std::memcpy(chars.data() + offsets[i], record, len);
+                    offsets[i + 1] = offsets[i] + len;
+                }
+
+                failed += decode_batch(chars.data(), offsets, n, values + first, errors ? errors + first : nullptr);
+            }
+
+            return failed;
+        }
+
+    private:
+
+        std::size_t decode_one(const char* data, std::size_t size, std::uint64_t& value, error* e) const
+        {
+            auto result = try_decode(data, size, value);
+
+            SCHROTT_ID_COUNT_IDS(size, 1);
+            SCHROTT_ID_COUNT_ERROR(result);
+
+            if (e)
+            {
+                *e = result;
+            }
+
+            if (result != error::none)
+            {
+                value = 0;
+                return 1;
+            }
+
+            return 0;
+        }
+
+        // Power of two bases: every digit takes the next digit_bits_ bits, after zero bits padding the front
+        void bytes_to_digits_sliced(const byte* data, std::size_t size, byte* buf, std::size_t len) const
+        {
+            const unsigned mask = (1u << digit_bits_) - 1;
+            unsigned acc = 0;
+            std::size_t bits = len * digit_bits_ - size * 8;
+            std::size_t out = 0;
+
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                acc = (acc << 8) | data[i];
+                bits += 8;
+
+                while (bits >= digit_bits_)
+                {
+                    bits -= digit_bits_;
+                    buf[out++] = (acc >> bits) & mask;
+                }
+
+                acc &= (1u << bits) - 1;
+            }
+        }
+
+        bool digits_to_bytes_sliced(const byte* buf, std::size_t len, byte* data, std::size_t size) const
+        {
+            unsigned acc = 0;
+            std::size_t bits = 0;
+            std::size_t padding = len * digit_bits_ - size * 8;
+            std::size_t out = 0;
+
+            for (std::size_t i = 0; i < len; ++i)
+            {
+                acc = (acc << digit_bits_) | buf[i];
+                bits += digit_bits_;
+
+                if (padding > 0)
+                {
+                    // Padding bits must be zero, otherwise the value is larger than size bytes
+                    auto n = std::min(padding, bits);
+                    bits -= n;
+                    padding -= n;
+
+                    if (acc >> bits)
+                    {
+                        return false;
+                    }
+                }
+
+                while (bits >= 8)
+                {
+                    bits -= 8;
+                    data[out++] = static_cast<byte>(acc >> bits);
+                }
+
+                acc &= (1u << bits) - 1;
+            }
+
+            return true;
+        }
+
+        // Other bases: convert through 64-bit words, like encode_words and decode_words
+        void bytes_to_digits_divided(const byte* data, std::size_t size, byte* buf, std::size_t len) const
+        {
+            std::vector<std::uint64_t> value((size + 7) / 8);
+
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                auto shift = (size - 1 - i) * 8;
+                value[shift / 64] |= static_cast<std::uint64_t>(data[i]) << (shift % 64);
+            }
+
+            auto n = value.size();
+            auto i = len;
+
+            while (i > 0)
+            {
+                while (n > 0 && value[n - 1] == 0)
+                {
+                    --n;
+                }
+
+                auto rem = n > 0 ? detail::div_rem(value.data(), n, chunk_divisor_) : 0;
+
+                for (std::size_t k = 0; k < chunk_digits_ && i > 0; ++k)
+                {
+                    buf[--i] = rem % alphabet_.size();
+                    rem /= alphabet_.size();
+                }
+            }
+        }
+
+        bool digits_to_bytes_multiplied(const byte* buf, std::size_t len, byte* data, std::size_t size) const
+        {
+            std::vector<std::uint64_t> value((size + 7) / 8 + 1);
+
+            auto chunk = len % chunk_digits_ ? len % chunk_digits_ : chunk_digits_;
+
+            for (std::size_t i = 0; i < len; i += chunk, chunk = chunk_digits_)
+            {
+                std::uint32_t factor = 1;
+                std::uint32_t addend = 0;
+
+                for (std::size_t k = i; k < i + chunk; ++k)
+                {
+                    factor *= alphabet_.size();
+                    addend = addend * alphabet_.size() + buf[k];
+                }
+
+                detail::mul_add(value.data(), value.size(), factor, addend);
+            }
+
+            // Every bit above size bytes must be zero
+            auto word = size / 8;
+            auto bit = (size % 8) * 8;
+
+            if (bit && value[word] >> bit)
+            {
+                return false;
+            }
+
+            for (auto i = bit ? word + 1 : word; i < value.size(); ++i)
+            {
+                if (value[i])
+                {
+                    return false;
+                }
+            }
+
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                auto shift = (size - 1 - i) * 8;
+                data[i] = static_cast<byte>(value[shift / 64] >> (shift % 64));
+            }
+
+            return true;
+        }
+
+        // Keys are derived from the alphabet size and permutation with the same FNV-1a and splitmix64
+        // steps as tweaked prefixes, so they are the same on every platform
+        void build_feistel()
+        {
+            std::uint64_t state = 0xCBF29CE484222325ull;
+            state = (state ^ alphabet_.size()) * 0x100000001B3ull;
+            for (auto p: permutation_)
+            {
+                state = (state ^ p) * 0x100000001B3ull;
+            }
+
+            for (auto& key: feistel_keys_)
+            {
+                state += 0x9E3779B97F4A7C15ull;
+                key = detail::mix64(state);
+            }
+
+            for (std::size_t len = 0; len <= max_encoded_length(); ++len)
+            {
+                feistel_domains_.push_back(make_domain(len));
+            }
+        }
+
+        feistel_domain make_domain(std::size_t len) const
+        {
+            // base^len - 1 as a multi-word integer
+            std::vector<std::uint64_t> limit(1, 1);
+
+            for (std::size_t i = 0; i < len; ++i)
+            {
+                auto carry = detail::mul_add(limit.data(), limit.size(), static_cast<std::uint32_t>(alphabet_.size()), 0);
+
+                if (carry)
+                {
+                    limit.push_back(carry);
+                }
+            }
+
+            for (auto& word: limit)
+            {
+                if (word-- != 0)
+                {
+                    break;
+                }
+            }
+
+            while (limit.size() > 1 && limit.back() == 0)
+            {
+                limit.pop_back();
+            }
+
+            if (limit.size() == 1)
+            {
+                unsigned bits = 2;
+                while (bits < 64 && (limit[0] >> bits) != 0)
+                {
+                    ++bits;
+                }
+
+                return feistel_domain{limit[0], bits / 2, bits - bits / 2, {}};
+            }
+
+            auto bits = static_cast<unsigned>(64 * (limit.size() - 1));
+            for (auto top = limit.back(); top != 0; top >>= 1)
+            {
+                ++bits;
+            }
+
+            return feistel_domain{UINT64_MAX, bits / 2, bits - bits / 2, std::move(limit)};
+        }
+
+        // Writes the len digits of the value's place in the domain of IDs with len digits
+        void feistel_encode(std::uint64_t value, byte* buf, std::size_t len) const
+        {
+            auto& d = feistel_domains_[len];
+
+            if (d.limit.empty())
+            {
+                convert_to_base(feistel_forward(value, d), buf, len);
+                return;
+            }
+
+            std::vector<std::uint64_t> words(d.limit.size(), 0);
+            words[0] = value;
+
+            do
+            {
+                feistel_pass_words(words.data(), d, false);
+            } while (above(words.data(), d.limit));
+
+            for (auto i = len; i > 0; --i)
+            {
+                buf[i - 1] = static_cast<byte>(
+                        detail::div_rem(words.data(), words.size(), static_cast<std::uint32_t>(alphabet_.size())));
+            }
+        }
+
+        static bool above(const std::uint64_t* words, const std::vector<std::uint64_t>& limit)
+        {
+            for (auto i = limit.size(); i > 0; --i)
+            {
+                if (words[i - 1] != limit[i - 1])
+                {
+                    return words[i - 1] > limit[i - 1];
+                }
+            }
+
+            return false;
+        }
+
+        // One pass through the network permutes [0, 2^bits), cycle walking repeats it until the
+        // result is inside the domain again. The domain covers more than half of [0, 2^bits), so
+        // fewer than two passes are needed on average.
+        std::uint64_t feistel_forward(std::uint64_t value, const feistel_domain& d) const
+        {
+            do
+            {
+                value = feistel_pass(value, d);
+            } while (value > d.max);
+
+            return value;
+        }
+
+        std::uint64_t feistel_backward(std::uint64_t value, const feistel_domain& d) const
+        {
+            do
+            {
+                value = feistel_pass_inverse(value, d);
+            } while (value > d.max);
+
+            return value;
+        }
+
+        // Rounds alternately add a keyed hash of one half to the other half, halves differ by at most one bit
+        std::uint64_t feistel_pass(std::uint64_t value, const feistel_domain& d) const
+        {
+            const auto high_mask = (std::uint64_t{1} << d.high_bits) - 1;
+            const auto low_mask = (std::uint64_t{1} << d.low_bits) - 1;
+            const auto tweak = (d.high_bits + d.low_bits) * 0x9E3779B97F4A7C15ull;
+
+            auto high = value >> d.low_bits;
+            auto low = value & low_mask;
+
+            for (std::size_t round = 0; round < kFeistelRounds; round += 2)
+            {
+                high = (high + detail::mix64(low ^ feistel_keys_[round] ^ tweak)) & high_mask;
+                low = (low + detail::mix64(high ^ feistel_keys_[round + 1] ^ tweak)) & low_mask;
+            }
+
+            return (high << d.low_bits) | low;
+        }
+
+        std::uint64_t feistel_pass_inverse(std::uint64_t value, const feistel_domain& d) const
+        {
+            const auto high_mask = (std::uint64_t{1} << d.high_bits) - 1;
+            const auto low_mask = (std::uint64_t{1} << d.low_bits) - 1;
+            const auto tweak = (d.high_bits + d.low_bits) * 0x9E3779B97F4A7C15ull;
+
+            auto high = value >> d.low_bits;
+            auto low = value & low_mask;
+
+            for (std::size_t round = kFeistelRounds; round > 0; round -= 2)
+            {
+                low = (low - detail::mix64(high ^ feistel_keys_[round - 1] ^ tweak)) & low_mask;
+                high = (high - detail::mix64(low ^ feistel_keys_[round - 2] ^ tweak)) & high_mask;
+            }
+
+            return (high << d.low_bits) | low;
+        }
+
+        // The same network for domains beyond 2^64, on halves of several words.
+        // Round keys hash all words of one half and are stretched over the words of the other half.
+        void feistel_pass_words(std::uint64_t* value, const feistel_domain& d, bool inverse) const
+        {
+            const auto tweak = (d.high_bits + d.low_bits) * 0x9E3779B97F4A7C15ull;
+            const std::size_t high_words = (d.high_bits + 63) / 64;
+            const std::size_t low_words = (d.low_bits + 63) / 64;
+            const auto size = d.limit.size();
+
+            std::vector<std::uint64_t> halves(high_words + low_words);
+            auto high = halves.data();
+            auto low = high + high_words;
+
+            detail::get_bits(value, size, d.low_bits, d.high_bits, high);
+            detail::get_bits(value, size, 0, d.low_bits, low);
+
+            if (!inverse)
+            {
+                for (std::size_t round = 0; round < kFeistelRounds; round += 2)
+                {
+                    add_round_key(high, d.high_bits, low, low_words, feistel_keys_[round] ^ tweak, false);
+                    add_round_key(low, d.low_bits, high, high_words, feistel_keys_[round + 1] ^ tweak, false);
+                }
+            }
+            else
+            {
+                for (std::size_t round = kFeistelRounds; round > 0; round -= 2)
+                {
+                    add_round_key(low, d.low_bits, high, high_words, feistel_keys_[round - 1] ^ tweak, true);
+                    add_round_key(high, d.high_bits, low, low_words, feistel_keys_[round - 2] ^ tweak, true);
+                }
+            }
+
+            std::fill(value, value + size, 0);
+            detail::put_bits(value, size, d.low_bits, d.high_bits, high);
+            detail::put_bits(value, size, 0, d.low_bits, low);
+        }
+
+        // Adds or subtracts a keyed hash of source to target modulo 2^bits
+        static void add_round_key(std::uint64_t* target, unsigned bits, const std::uint64_t* source,
+                                  std::size_t source_words, std::uint64_t key, bool subtract)
+        {
+            auto hash = key;
+            for (std::size_t i = 0; i < source_words; ++i)
+            {
+                hash = detail::mix64(hash ^ source[i]);
+            }
+
+            const std::size_t words = (bits + 63) / 64;
+            std::uint64_t carry = 0;
+
+            for (std::size_t i = 0; i < words; ++i)
+            {
+                auto k = detail::mix64(hash + i * 0x9E3779B97F4A7C15ull);
+
+                if (subtract)
+                {
+                    auto difference = target[i] - k;
+                    auto borrow = target[i] < k;
+                    target[i] = difference - carry;
+                    carry = borrow | (difference < carry);
+                }
+                else
+                {
+                    auto sum = target[i] + k;
+                    auto overflow = sum < k;
+                    target[i] = sum + carry;
+                    carry = overflow | (target[i] < carry);
+                }
+            }
+
+            if (bits % 64)
+            {
+                target[words - 1] &= (std::uint64_t{1} << (bits % 64)) - 1;
+            }
+        }
+
+        // Like try_decode, but IDs of cascade encoders that stand for values beyond 64 bits fail with
+        // error::range_overflow instead of wrapping, for callers that bound the values
+        error try_decode_checked(const char* data, std::size_t size, std::uint64_t& value) const
+        {
+            SCHROTT_ID_MEASURE(decode, size);
+            SCHROTT_ID_COUNT_IDS(size, 1);
+
+            auto e = algorithm_ == schrott_id::algorithm::feistel
+                     ? try_decode_feistel(data, size, value)
+                     : try_decode_cascade(data, size, value, true);
+
+            SCHROTT_ID_COUNT_ERROR(e);
+
+            return e;
+        }
+
+        error try_decode_cascade(const char* data, std::size_t size, std::uint64_t& value, bool checked = false) const
+        {
+            byte stack[kStackDigits];
+            std::vector<byte> heap;
+            auto buf = stack;
+
+            if (size > kStackDigits)
+            {
+                heap.resize(size);
+                buf = heap.data();
+            }
+
+            if (!convert_from_base(data, size, buf))
+            {
+                return error::invalid_character;
+            }
+
+            rounds_backward(buf, size);
+
+            if (checked)
+            {
+                return convert_to_value_checked(buf, size, value) ? error::none : error::range_overflow;
+            }
+
+            value = convert_to_value(buf, size);
+
+            return error::none;
+        }
+
+        error try_decode_feistel(const char* data, std::size_t size, std::uint64_t& value) const
+        {
+            // IDs longer than any encoded ID are decoded in a domain of their own
+            feistel_domain longer;
+            const feistel_domain* d = &longer;
+
+            if (size < feistel_domains_.size())
+            {
+                d = &feistel_domains_[size];
+            }
+            else
+            {
+                longer = make_domain(size);
+            }
+
+            if (!d->limit.empty())
+            {
+                return try_decode_feistel_words(data, size, *d, value);
+            }
+
+            std::uint64_t result = 0;
+
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                auto digit = inverse_alphabet_[static_cast<byte>(data[i])];
+
+                if (digit < 0)
+                {
+                    return error::invalid_character;
+                }
+
+                if (result > (UINT64_MAX - digit) / alphabet_.size())
+                {
+                    return error::range_overflow;
+                }
+
+                result = result * alphabet_.size() + digit;
+            }
+
+            value = feistel_backward(result, *d);
+
+            return error::none;
+        }
+
+        error try_decode_feistel_words(const char* data, std::size_t size, const feistel_domain& d,
+                                       std::uint64_t& value) const
+        {
+            std::vector<std::uint64_t> words(d.limit.size(), 0);
+
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                auto digit = inverse_alphabet_[static_cast<byte>(data[i])];
+
+                if (digit < 0)
+                {
+                    return error::invalid_character;
+                }
+
+                detail::mul_add(words.data(), words.size(), static_cast<std::uint32_t>(alphabet_.size()),
+                                static_cast<std::uint32_t>(digit));
+            }
+
+            do
+            {
+                feistel_pass_words(words.data(), d, true);
+            } while (above(words.data(), d.limit));
+
+            for (std::size_t i = 1; i < words.size(); ++i)
+            {
+                if (words[i] != 0)
+                {
+                    return error::range_overflow;
+                }
+            }
+
+            value = words[0];
+
+            return error::none;
+        }
+
+        void build_length_thresholds()
+        {
+            auto base = alphabet_.size();
+            auto max_digits = detail::reference_digits(UINT64_MAX, base);
+
+            length_thresholds_.assign(max_digits + 1, 0);
+
+            for (std::size_t k = 2; k <= max_digits; ++k)
+            {
+                std::uint64_t lo = length_thresholds_[k - 1];
+                std::uint64_t hi = UINT64_MAX;
+
+                while (lo < hi)
+                {
+                    auto mid = lo + (hi - lo) / 2;
+
+                    if (detail::reference_digits(mid, base) >= k)
+                    {
+                        hi = mid;
+                    }
+                    else
+                    {
+                        lo = mid + 1;
+                    }
+                }
+
+                length_thresholds_[k] = lo;
+            }
+        }
+
+        void convert_to_base(std::uint64_t value, byte* buf, std::size_t len) const
+        {
+            auto i = len;
+            do
+            {
+                buf[--i] = value % alphabet_.size();
+                value = value / alphabet_.size();
+            } while (value > 0);
+
+            std::fill(buf, buf + i, 0);
+        }
+
+        void convert_to_string(byte* buf, std::size_t len) const
+        {
+            auto s = reinterpret_cast<char*>(buf);
+
+            for (std::size_t i = 0; i < len; ++i)
+            {
+                s[i] = alphabet_[buf[i]];
+            }
+        }
+
+        bool convert_from_base(const char* value, std::size_t len, byte* buf) const
+        {
+            for (std::size_t i = 0; i < len; ++i)
+            {
+                auto digit = inverse_alphabet_[static_cast<byte>(value[i])];
+
+                if (digit < 0)
+                {
+                    return false;
+                }
+
+                buf[i] = static_cast<byte>(digit);
+            }
+
+            return true;
+        }
+
+        std::uint64_t convert_to_value(const byte* buf, std::size_t len) const
+        {
+            std::uint64_t value = 0;
+
+            for (std::size_t i = 0; i < len; ++i)
+            {
+                value = value * alphabet_.size() + buf[i];
+            }
+
+            return value;
+        }
+
+        // Returns false instead of wrapping if the digits stand for a value beyond 64 bits
+        bool convert_to_value_checked(const byte* buf, std::size_t len, std::uint64_t& value) const
+        {
+            const auto base = alphabet_.size();
+            std::uint64_t result = 0;
+
+            for (std::size_t i = 0; i < len; ++i)
+            {
+                if (result > (UINT64_MAX - buf[i]) / base)
+                {
+                    return false;
+                }
+
+                result = result * base + buf[i];
+            }
+
+            value = result;
+            return true;
+        }
+
+        // Zeroed words for the packed value of a layout, on the stack unless it is wider than 256 bits
+        static std::uint64_t* tuple_words(const tuple_layout& layout, std::uint64_t (&stack)[4],
+                                          std::vector<std::uint64_t>& heap)
+        {
+            if (layout.words() > 4)
+            {
+                heap.resize(layout.words());
+                return heap.data();
+            }
+
+            return stack;
+        }
+
+        // Packs the fields into the words, the first field into the most significant bits.
+        // Returns false if a field does not fit into its bit width.
+        static bool pack_tuple(const tuple_layout& layout, const std::uint64_t* fields, std::uint64_t* words)
+        {
+            std::size_t position = 0;
+
+            for (auto i = layout.size(); i-- > 0;)
+            {
+                auto width = layout.bit_width(i);
+                auto value = fields[i];
+
+                if (width < 64 && value >> width)
+                {
+                    return false;
+                }
+
+                auto shift = position % 64;
+                words[position / 64] |= value << shift;
+
+                if (shift + width > 64)
+                {
+                    words[position / 64 + 1] |= value >> (64 - shift);
+                }
+
+                position += width;
+            }
+
+            return true;
+        }
+
+        // A round is rotate left, permute, rotate left, cascade, rotate left.
+        // Rotations are tracked as an offset into buf instead of moving memory and the permutation is
+        // applied while cascading. Every round rotates by three, so after the v3 schedule of len * 3 rounds
+        // the offset is 0 again. Other schedules can end at any offset and rotate buf once at the end.
+
+        void rounds_forward(byte* buf, std::size_t len) const
+        {
+            const unsigned base = alphabet_.size();
+            const byte* permutation = permutation_.data();
+            std::size_t offset = 0;
+
+            const auto rounds = schedule_.rounds(len);
+
+            for (std::size_t round = 0; round < rounds; ++round)
+            {
+                offset = (offset + 2) % len;
+
+                unsigned last = 0;
+
+                for (std::size_t i = offset; i < len; ++i)
+                {
+                    last = cascade_add(permutation[buf[i]], last, base);
+                    buf[i] = last;
+                }
+
+                for (std::size_t i = 0; i < offset; ++i)
+                {
+                    last = cascade_add(permutation[buf[i]], last, base);
+                    buf[i] = last;
+                }
+
+                offset = (offset + 1) % len;
+            }
+
+            std::rotate(buf, buf + offset, buf + len);
+        }
+
+        // Same as rounds_forward for count buffers of len digits stored back to back.
+        // Lanes of buffers are transposed so digit i of every lane is adjacent and their
+        // independent cascades overlap in the pipeline.
+        void rounds_forward_batch(byte* bufs, std::size_t len, std::size_t count) const
+        {
+            std::size_t i = 0;
+
+            if (len <= kStackDigits)
+            {
+                for (; i + kLanes <= count; i += kLanes)
+                {
+                    rounds_forward_lanes(bufs + i * len, len);
+                }
+            }
+
+            for (; i < count; ++i)
+            {
+                rounds_forward(bufs + i * len, len);
+            }
+        }
+
+        void rounds_forward_lanes(byte* bufs, std::size_t len) const
+        {
+            const unsigned base = alphabet_.size();
+            const byte* permutation = permutation_.data();
+            byte lanes[kStackDigits * kLanes];
+
+            transpose_in(bufs, len, lanes);
+
+            std::size_t offset = 0;
+
+            const auto rounds = schedule_.rounds(len);
+
+            for (std::size_t round = 0; round < rounds; ++round)
+            {
+                offset = (offset + 2) % len;
+
+                unsigned last[kLanes] = {};
+
+                for (std::size_t n = 0; n < len; ++n)
+                {
+                    auto digits = lanes + (offset + n < len ? offset + n : offset + n - len) * kLanes;
+
+                    for (std::size_t lane = 0; lane < kLanes; ++lane)
+                    {
+                        last[lane] = cascade_add(permutation[digits[lane]], last[lane], base);
+                        digits[lane] = last[lane];
+                    }
+                }
+
+                offset = (offset + 1) % len;
+            }
+
+            std::rotate(lanes, lanes + offset * kLanes, lanes + len * kLanes);
+            transpose_out(lanes, len, bufs);
+        }
+
+        static void transpose_in(const byte* bufs, std::size_t len, byte* lanes)
+        {
+            for (std::size_t lane = 0; lane < kLanes; ++lane)
+            {
+                for (std::size_t i = 0; i < len; ++i)
+                {
+                    lanes[i * kLanes + lane] = bufs[lane * len + i];
+                }
+            }
+        }
+
+        static void transpose_out(const byte* lanes, std::size_t len, byte* bufs)
+        {
+            for (std::size_t lane = 0; lane < kLanes; ++lane)
+            {
+                for (std::size_t i = 0; i < len; ++i)
+                {
+                    bufs[lane * len + i] = lanes[i * kLanes + lane];
+                }
+            }
+        }
+
+        void increment(byte* digits, std::size_t width) const
+        {
+            auto i = width - 1;
+
+            while (digits[i] + 1u == alphabet_.size())
+            {
+                digits[i--] = 0;
+            }
+
+            ++digits[i];
+        }
+
+        void rounds_backward_batch(byte* bufs, std::size_t len, std::size_t count) const
+        {
+            std::size_t i = 0;
+
+            if (len <= kStackDigits)
+            {
+                for (; i + kLanes <= count; i += kLanes)
+                {
+                    rounds_backward_lanes(bufs + i * len, len);
+                }
+            }
+
+            for (; i < count; ++i)
+            {
+                rounds_backward(bufs + i * len, len);
+            }
+        }
+
+        void rounds_backward_lanes(byte* bufs, std::size_t len) const
+        {
+            const unsigned base = alphabet_.size();
+            const byte* inverse_permutation = inverse_permutation_.data();
+            byte lanes[kStackDigits * kLanes];
+
+            transpose_in(bufs, len, lanes);
+
+            std::size_t offset = 0;
+
+            const auto rounds = schedule_.rounds(len);
+
+            for (std::size_t round = 0; round < rounds; ++round)
+            {
+                offset = (offset + len - 1) % len;
+
+                unsigned last[kLanes] = {};
+
+                for (std::size_t n = 0; n < len; ++n)
+                {
+                    auto digits = lanes + (offset + n < len ? offset + n : offset + n - len) * kLanes;
+
+                    for (std::size_t lane = 0; lane < kLanes; ++lane)
+                    {
+                        unsigned t = digits[lane];
+                        digits[lane] = inverse_permutation[cascade_sub(t, last[lane], base)];
+                        last[lane] = t;
+                    }
+                }
+
+                offset = (offset + 2 * len - 2) % len;
+            }
+
+            std::rotate(lanes, lanes + offset * kLanes, lanes + len * kLanes);
+            transpose_out(lanes, len, bufs);
+        }
+
+        void rounds_backward(byte* buf, std::size_t len) const
+        {
+            const unsigned base = alphabet_.size();
+            const byte* inverse_permutation = inverse_permutation_.data();
+            std::size_t offset = 0;
+
+            const auto rounds = schedule_.rounds(len);
+
+            for (std::size_t round = 0; round < rounds; ++round)
+            {
+                offset = (offset + len - 1) % len;
+
+                unsigned last = 0;
+
+                for (std::size_t i = offset; i < len; ++i)
+                {
+                    unsigned t = buf[i];
+                    buf[i] = inverse_permutation[cascade_sub(t, last, base)];
+                    last = t;
+                }
+
+                for (std::size_t i = 0; i < offset; ++i)
+                {
+                    unsigned t = buf[i];
+                    buf[i] = inverse_permutation[cascade_sub(t, last, base)];
+                    last = t;
+                }
+
+                offset = (offset + 2 * len - 2) % len;
+            }
+
+            std::rotate(buf, buf + offset, buf + len);
+        }
+
+        static unsigned cascade_add(unsigned a, unsigned b, unsigned base)
+        {
+            auto sum = a + b;
+            return sum >= base ? sum - base : sum;
+        }
+
+        static unsigned cascade_sub(unsigned a, unsigned b, unsigned base)
+        {
+            return a >= b ? a - b : a + base - b;
+        }
+    };
+
+    /**
+     * Encodes and decodes SchrottIDs with a fixed type prefix, like ord_9TN.
+     *
+     * The prefix is written straight into the output buffer in front of the ID and verified
+     * with a single comparison before decoding, so no intermediate strings are created.
+     */
+    class prefixed_encoder
+    {
+    private:
+        std::string prefix_;
+        schrott_id_encoder encoder_;
+
+    public:
+
+        /**
+         * Creates a new prefixed encoder.
+         * @param encoder Encoder for the part after the prefix
+         * @param prefix Prefix of every SchrottID
+         * @param tweak If true, the permutation is derived from the encoder's permutation and the prefix,
+         * so the same value maps to unrelated IDs for different prefixes.
+         * Changing the prefix then changes the IDs after it.
+         */
+        prefixed_encoder(const schrott_id_encoder& encoder, std::string prefix, bool tweak = false)
+                : prefix_(std::move(prefix)),
+                  encoder_(tweak ? tweaked(encoder, prefix_) : encoder)
+        {
+        }
+
+        const std::string& prefix() const
+        {
+            return prefix_;
+        }
+
+        /**
+         * Returns the encoder used for the part after the prefix.
+         */
+        const schrott_id_encoder& encoder() const
+        {
+            return encoder_;
+        }
+
+        /**
+         * Returns the length of the prefixed SchrottID for a value.
+         */
+        std::size_t encoded_length(std::uint64_t value) const
+        {
+            return prefix_.size() + encoder_.encoded_length(value);
+        }
+
+        /**
+         * Encodes an integer value to a prefixed SchrottID
+         * @param value The value to encode
+         * @return Prefix followed by the encoded SchrottID
+         */
+        std::string encode(std::uint64_t value) const
+        {
+            std::string s(encoded_length(value), '\0');
+            encode_to(value, &s[0], s.size());
+            return s;
+        }
+
+        /**
+         * Encodes an integer value to a prefixed SchrottID into a caller-owned buffer.
+         * @return Number of characters written, 0 if the buffer is smaller than @see encoded_length
+         */
+        std::size_t encode_to(std::uint64_t value, char* out, std::size_t out_size) const
+        {
+            if (out_size < prefix_.size())
+            {
+                return 0;
+            }
+
+            auto len = encoder_.encode_to(value, out + prefix_.size(), out_size - prefix_.size());
+
+            if (len == 0)
+            {
+                return 0;
+            }
+
+            std::copy(prefix_.begin(), prefix_.end(), out);
+
+            return prefix_.size() + len;
+        }
+
+        /**
+         * Decodes a prefixed SchrottID back to an integer value
+         * @param value The value to decode
+         * @return The decoded SchrottID
+         * @throws std::out_of_range The supplied value does not start with the prefix or contains
+         * a character that is not present in the alphabet.
+         */
+        std::uint64_t decode(const std::string& value) const
+        {
+            std::uint64_t result;
+            auto e = try_decode(value.data(), value.size(), result);
+
+            if (e != error::none)
+            {
+                SCHROTT_ID_THROW(std::out_of_range, error_message(e));
+            }
+
+            return result;
+        }
+
+        /**
+         * Decodes a prefixed SchrottID back to an integer value without throwing on invalid input.
+         * @return error::none, error::invalid_prefix or error::invalid_character
+         */
+        error try_decode(const char* data, std::size_t size, std::uint64_t& value) const
+        {
+            SCHROTT_ID_MEASURE(decode, size);
+            SCHROTT_ID_COUNT_IDS(size, 1);
+
+            if (size < prefix_.size()
+                || std::memcmp(data, prefix_.data(), prefix_.size()) != 0)
+            {
+                SCHROTT_ID_COUNT_ERROR(error::invalid_prefix);
+                return error::invalid_prefix;
+            }
+
+            auto e = encoder_.try_decode(data + prefix_.size(), size - prefix_.size(), value);
+
+            SCHROTT_ID_COUNT_ERROR(e);
+
+            return e;
+        }
+
+    private:
+
+        // Shuffles the permutation with a generator seeded from the prefix. The generator is
+        // spelled out here instead of using <random> so tweaked IDs are the same on every platform.
+        static schrott_id_encoder tweaked(const schrott_id_encoder& encoder, const std::string& prefix)
+        {
+            auto permutation = encoder.permutation_;
+
+            std::uint64_t state = 0xCBF29CE484222325ull;
+            for (auto c: prefix)
+            {
+                state = (state ^ static_cast<byte>(c)) * 0x100000001B3ull;
+            }
+
+            for (auto i = permutation.size() - 1; i > 0; --i)
+            {
+                state += 0x9E3779B97F4A7C15ull;
+                auto z = detail::mix64(state);
+
+                std::swap(permutation[i], permutation[z % (i + 1)]);
+            }
+
+            return schrott_id_encoder(encoder.alphabet_, std::move(permutation), encoder.min_length_,
+                                      encoder.schedule_, encoder.algorithm_);
+        }
+    };
+
+    /**
+     * Encodes and decodes SchrottIDs of values up to a declared maximum, all with the same length.
+     *
+     * The length is the one the maximum value needs, but at least the minimum length of the encoder.
+     * Every ID takes the same path through the rounds, batches need no grouping by length and are stored
+     * as fixed-width records, and decoding rejects IDs of any other length with a single comparison.
+     * IDs equal those of an encoder with the fixed length as minimum length.
+     */
+    class fixed_length_encoder
+    {
+    private:
+        static const std::size_t kChunk = 256;
+
+        schrott_id_encoder encoder_;
+        std::uint64_t max_value_;
+        std::size_t length_;
+
+    public:
+
+        /**
+         * Creates a new fixed length encoder.
+         * @param encoder Encoder whose alphabet, permutation and algorithm to use
+         * @param max_value Largest value that can be encoded
+         */
+        fixed_length_encoder(const schrott_id_encoder& encoder, std::uint64_t max_value)
+                : encoder_(with_min_length(encoder, encoder.encoded_length(max_value))),
+                  max_value_(max_value),
+                  length_(encoder_.min_length())
+        {
+        }
+
+        /**
+         * Returns the encoder that produces the IDs, its minimum length is the fixed length.
+         */
+        const schrott_id_encoder& encoder() const
+        {
+            return encoder_;
+        }
+
+        /**
+         * Returns the largest value that can be encoded.
+         */
+        std::uint64_t max_value() const
+        {
+            return max_value_;
+        }
+
+        /**
+         * Returns the length of every SchrottID. A batch of count IDs takes count * length() characters.
+         */
+        std::size_t length() const
+        {
+            return length_;
+        }
+
+        /**
+         * Encodes an integer value to a SchrottID
+         * @param value The value to encode
+         * @return Encoded SchrottID of @see length characters
+         * @throws std::out_of_range The value is larger than the maximum value.
+         */
+        std::string encode(std::uint64_t value) const
         {
-            byte last = 0;
+            if (value > max_value_)
+            {
+                SCHROTT_ID_THROW(std::out_of_range, error_message(error::range_overflow));
+            }
+
+            std::string s(length_, '\0');
+            encoder_.encode_to(value, &s[0], s.size());
+            return s;
+        }
+
+        /**
+         * Encodes an integer value to a SchrottID into a caller-owned buffer.
+         * @return Number of characters written, 0 if the buffer is smaller than @see length
+         * or the value is larger than the maximum value
+         */
+        std::size_t encode_to(std::uint64_t value, char* out, std::size_t out_size) const
+        {
+            SCHROTT_ID_MEASURE(encode, value);
+
+            if (value > max_value_)
+            {
+                SCHROTT_ID_COUNT_ERROR(error::range_overflow);
+                return 0;
+            }
+
+            SCHROTT_ID_COUNT_IDS(length_, 1);
+
+            return encoder_.encode_to(value, out, out_size);
+        }
+
+        /**
+         * Decodes a SchrottID back to an integer value
+         * @param value The value to decode
+         * @return The decoded SchrottID
+         * @throws std::out_of_range The supplied value has the wrong length, contains a character
+         * that is not present in the alphabet or stands for a value larger than the maximum value.
+         */
+        std::uint64_t decode(const std::string& value) const
+        {
+            std::uint64_t result;
+            auto e = try_decode(value.data(), value.size(), result);
+
+            if (e != error::none)
+            {
+                SCHROTT_ID_THROW(std::out_of_range, error_message(e));
+            }
+
+            return result;
+        }
+
+        /**
+         * Decodes a SchrottID back to an integer value without throwing on invalid input.
+         * @return error::none, error::invalid_length, error::invalid_character or error::range_overflow
+         * if the value is larger than the maximum value
+         */
+        error try_decode(const char* data, std::size_t size, std::uint64_t& value) const
+        {
+            SCHROTT_ID_MEASURE(decode, size);
+            SCHROTT_ID_COUNT_IDS(size, 1);
+
+            if (size != length_)
+            {
+                SCHROTT_ID_COUNT_ERROR(error::invalid_length);
+                return error::invalid_length;
+            }
+
+            std::uint64_t result;
+            auto e = encoder_.try_decode_checked(data, size, result);
+
+            if (e == error::none && result > max_value_)
+            {
+                e = error::range_overflow;
+            }
+
+            if (e != error::none)
+            {
+                SCHROTT_ID_COUNT_ERROR(e);
+                return e;
+            }
+
+            value = result;
+            return error::none;
+        }
+
+        /**
+         * Encodes a batch of values into fixed-width records of @see length characters without separators.
+         * @param values Values to encode
+         * @param count Number of values
+         * @param out Output character buffer
+         * @param out_size Size of the output buffer, at least count * length() characters
+         * @return error::none, error::buffer_too_small or error::range_overflow if a value is larger than
+         * the maximum value, in both cases nothing is written
+         */
+        error encode_batch(const std::uint64_t* values, std::size_t count, char* out, std::size_t out_size) const
+        {
+            SCHROTT_ID_MEASURE(encode_batch, count);
+
+            if (out_size / length_ < count)
+            {
+                SCHROTT_ID_COUNT_ERROR(error::buffer_too_small);
+                return error::buffer_too_small;
+            }
+
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                if (values[i] > max_value_)
+                {
+                    SCHROTT_ID_COUNT_ERROR(error::range_overflow);
+                    return error::range_overflow;
+                }
+            }
+
+            SCHROTT_ID_COUNT_IDS(length_, count);
+
+            if (encoder_.algorithm_ == algorithm::feistel)
+            {
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    encoder_.encode_to(values[i], out + i * length_, length_);
+                }
+
+                return error::none;
+            }
+
+            // Chunks keep the digits in cache between conversion and rounds
+            for (std::size_t i = 0; i < count; i += kChunk)
+            {
+                auto n = count - i < kChunk ? count - i : kChunk;
+                auto buf = reinterpret_cast<byte*>(out + i * length_);
+
+                for (std::size_t j = 0; j < n; ++j)
+                {
+                    encoder_.convert_to_base(values[i + j], buf + j * length_, length_);
+                }
+
+                encoder_.rounds_forward_batch(buf, length_, n);
+                encoder_.convert_to_string(buf, n * length_);
+            }
+
+            return error::none;
+        }
+
+        /**
+         * Decodes a batch of fixed-width records of @see length characters.
+         * @param chars count * length() characters
+         * @param count Number of SchrottIDs
+         * @param values Receives the decoded values, 0 for IDs that failed to decode
+         * @param errors Receives an error code per ID, may be null
+         * @return Number of SchrottIDs that failed to decode
+         */
+        std::size_t decode_batch(const char* chars, std::size_t count, std::uint64_t* values, error* errors) const
+        {
+            SCHROTT_ID_MEASURE(decode_batch, count);
+            SCHROTT_ID_COUNT_IDS(length_, count);
+
+            const auto kLanes = schrott_id_encoder::kLanes;
+            std::size_t failed = 0;
+
+            if (encoder_.algorithm_ == algorithm::feistel || length_ > schrott_id_encoder::kStackDigits)
+            {
+                for (std::size_t i = 0; i < count; ++i)
+                {
+                    failed += decode_one(chars + i * length_, values[i], errors ? &errors[i] : nullptr);
+                }
+
+                return failed;
+            }
+
+            byte bufs[schrott_id_encoder::kStackDigits * kLanes];
+            std::size_t indices[kLanes];
+
+            for (std::size_t i = 0; i < count;)
+            {
+                std::size_t n = 0;
+
+                for (; i < count && n < kLanes; ++i)
+                {
+                    if (encoder_.convert_from_base(chars + i * length_, length_, bufs + n * length_))
+                    {
+                        indices[n++] = i;
+                    }
+                    else
+                    {
+                        failed += fail(i, error::invalid_character, values, errors);
+                    }
+                }
+
+                encoder_.rounds_backward_batch(bufs, length_, n);
+
+                for (std::size_t j = 0; j < n; ++j)
+                {
+                    std::uint64_t value;
+
+                    if (!encoder_.convert_to_value_checked(bufs + j * length_, length_, value) || value > max_value_)
+                    {
+                        failed += fail(indices[j], error::range_overflow, values, errors);
+                        continue;
+                    }
+
+                    values[indices[j]] = value;
+
+                    if (errors)
+                    {
+                        errors[indices[j]] = error::none;
+                    }
+                }
+            }
+
+            return failed;
+        }
+
+    private:
+
+        std::size_t decode_one(const char* data, std::uint64_t& value, error* e) const
+        {
+            auto result = try_decode(data, length_, value);
 
-            for (auto i = 0; i < buf.size(); ++i)
+            SCHROTT_ID_COUNT_ERROR(result);
+
+            if (e)
+            {
+                *e = result;
+            }
+
+            if (result != error::none)
+            {
+                value = 0;
+                return 1;
+            }
+
+            return 0;
+        }
+
+        static std::size_t fail(std::size_t i, error e, std::uint64_t* values, error* errors)
+        {
+            SCHROTT_ID_COUNT_ERROR(e);
+
+            values[i] = 0;
+
+            if (errors)
             {
-                auto t = buf[i];
-                buf[i] = (buf[i] + alphabet_.size() - last) % alphabet_.size();
-                last = t;
+                errors[i] = e;
             }
+
+            return 1;
+        }
+
+        static schrott_id_encoder with_min_length(const schrott_id_encoder& encoder, std::size_t length)
+        {
+            return schrott_id_encoder(encoder.alphabet_, encoder.permutation_, static_cast<int>(length),
+                                      encoder.schedule_, encoder.algorithm_);
         }
     };
 }
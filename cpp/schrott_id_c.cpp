@@ -0,0 +1,367 @@
+#include "schrott_id_c.h"
+
+#include <cstring>
+#include <new>
+
+#include "schrott_id.hpp"
+
+struct schrott_id_handle
+{
+    schrott_id::schrott_id_encoder encoder;
+};
+
+namespace
+{
+    schrott_id_status to_status(schrott_id::error e)
+    {
+        switch (e)
+        {
+            case schrott_id::error::none:
+                return SCHROTT_ID_OK;
+            case schrott_id::error::invalid_character:
+                return SCHROTT_ID_ERROR_INVALID_CHARACTER;
+            case schrott_id::error::buffer_too_small:
+                return SCHROTT_ID_ERROR_BUFFER_TOO_SMALL;
+            case schrott_id::error::range_overflow:
+                return SCHROTT_ID_ERROR_OUT_OF_RANGE;
+            case schrott_id::error::invalid_length:
+                return SCHROTT_ID_ERROR_INVALID_LENGTH;
+            case schrott_id::error::invalid_prefix:
+                return SCHROTT_ID_ERROR_INVALID_PREFIX;
+            case schrott_id::error::invalid_alphabet_size:
+            case schrott_id::error::duplicate_character:
+            case schrott_id::error::invalid_min_length:
+            case schrott_id::error::invalid_schedule:
+            case schrott_id::error::invalid_base64:
+            case schrott_id::error::invalid_permutation_length:
+            case schrott_id::error::duplicate_position:
+            case schrott_id::error::invalid_permutation_index:
+            case schrott_id::error::invalid_json:
+            case schrott_id::error::invalid_tuple_layout:
+                return SCHROTT_ID_ERROR_INVALID_ARGUMENT;
+        }
+
+        return SCHROTT_ID_ERROR_UNKNOWN;
+    }
+}
+
+extern "C" {
+
+uint32_t schrott_id_abi_version(void)
+{
+    return SCHROTT_ID_C_ABI_VERSION;
+}
+
+const char* schrott_id_status_message(schrott_id_status status)
+{
+    switch (status)
+    {
+        case SCHROTT_ID_OK:
+            return "No error";
+        case SCHROTT_ID_ERROR_INVALID_ARGUMENT:
+            return "Invalid argument";
+        case SCHROTT_ID_ERROR_INVALID_CHARACTER:
+            return "Character not in alphabet";
+        case SCHROTT_ID_ERROR_BUFFER_TOO_SMALL:
+            return "Output buffer too small";
+        case SCHROTT_ID_ERROR_OUT_OF_MEMORY:
+            return "Out of memory";
+        case SCHROTT_ID_ERROR_OUT_OF_RANGE:
+            return "Value out of range";
+        case SCHROTT_ID_ERROR_INVALID_LENGTH:
+            return "Invalid length";
+        case SCHROTT_ID_ERROR_INVALID_PREFIX:
+            return "Invalid prefix";
+        default:
+            return "Unknown error";
+    }
+}
+
+schrott_id_status schrott_id_create(
+        const char* alphabet,
+        size_t alphabet_length,
+        const char* permutation,
+        int32_t min_length,
+        schrott_id_handle** handle)
+{
+    return schrott_id_create_with_rounds(alphabet, alphabet_length, permutation, min_length, 3, 0, handle);
+}
+
+schrott_id_status schrott_id_create_with_rounds(
+        const char* alphabet,
+        size_t alphabet_length,
+        const char* permutation,
+        int32_t min_length,
+        uint32_t rounds_per_digit,
+        uint32_t fixed_rounds,
+        schrott_id_handle** handle)
+{
+    if (!alphabet || !permutation || !handle)
+    {
+        return SCHROTT_ID_ERROR_INVALID_ARGUMENT;
+    }
+
+    try
+    {
+        schrott_id::round_schedule schedule;
+        schedule.per_digit = rounds_per_digit;
+        schedule.fixed = fixed_rounds;
+
+        *handle = new schrott_id_handle{
+                schrott_id::schrott_id_encoder(std::string(alphabet, alphabet_length), permutation, min_length,
+                                               schedule)};
+        return SCHROTT_ID_OK;
+    }
+    catch (const std::invalid_argument&)
+    {
+        return SCHROTT_ID_ERROR_INVALID_ARGUMENT;
+    }
+    catch (const std::bad_alloc&)
+    {
+        return SCHROTT_ID_ERROR_OUT_OF_MEMORY;
+    }
+    catch (...)
+    {
+        return SCHROTT_ID_ERROR_UNKNOWN;
+    }
+}
+
+schrott_id_status schrott_id_create_with_algorithm(
+        const char* alphabet,
+        size_t alphabet_length,
+        const char* permutation,
+        int32_t min_length,
+        int32_t algorithm,
+        schrott_id_handle** handle)
+{
+    if (!alphabet || !permutation || !handle
+        || (algorithm != SCHROTT_ID_ALGORITHM_CASCADE && algorithm != SCHROTT_ID_ALGORITHM_FEISTEL))
+    {
+        return SCHROTT_ID_ERROR_INVALID_ARGUMENT;
+    }
+
+    try
+    {
+        *handle = new schrott_id_handle{
+                schrott_id::schrott_id_encoder(std::string(alphabet, alphabet_length), permutation, min_length,
+                                               static_cast<schrott_id::algorithm>(algorithm))};
+        return SCHROTT_ID_OK;
+    }
+    catch (const std::invalid_argument&)
+    {
+        return SCHROTT_ID_ERROR_INVALID_ARGUMENT;
+    }
+    catch (const std::bad_alloc&)
+    {
+        return SCHROTT_ID_ERROR_OUT_OF_MEMORY;
+    }
+    catch (...)
+    {
+        return SCHROTT_ID_ERROR_UNKNOWN;
+    }
+}
+
+void schrott_id_destroy(schrott_id_handle* handle)
+{
+    delete handle;
+}
+
+schrott_id_status schrott_id_generate_permutation(
+        const char* alphabet,
+        size_t alphabet_length,
+        char* out,
+        size_t out_size)
+{
+    if (!alphabet || !out)
+    {
+        return SCHROTT_ID_ERROR_INVALID_ARGUMENT;
+    }
+
+    try
+    {
+        auto permutation = schrott_id::schrott_id_encoder::generate_permutation(
+                std::string(alphabet, alphabet_length));
+
+        if (permutation.size() >= out_size)
+        {
+            return SCHROTT_ID_ERROR_BUFFER_TOO_SMALL;
+        }
+
+        std::memcpy(out, permutation.c_str(), permutation.size() + 1);
+        return SCHROTT_ID_OK;
+    }
+    catch (const std::invalid_argument&)
+    {
+        return SCHROTT_ID_ERROR_INVALID_ARGUMENT;
+    }
+    catch (const std::bad_alloc&)
+    {
+        return SCHROTT_ID_ERROR_OUT_OF_MEMORY;
+    }
+    catch (...)
+    {
+        return SCHROTT_ID_ERROR_UNKNOWN;
+    }
+}
+
+size_t schrott_id_max_encoded_length(const schrott_id_handle* handle)
+{
+    return handle->encoder.max_encoded_length();
+}
+
+schrott_id_status schrott_id_encode(
+        const schrott_id_handle* handle,
+        uint64_t value,
+        char* out,
+        size_t out_size,
+        size_t* written)
+{
+    try
+    {
+        auto n = handle->encoder.encode_to(value, out, out_size);
+
+        if (written)
+        {
+            *written = n;
+        }
+
+        return n ? SCHROTT_ID_OK : SCHROTT_ID_ERROR_BUFFER_TOO_SMALL;
+    }
+    catch (const std::bad_alloc&)
+    {
+        return SCHROTT_ID_ERROR_OUT_OF_MEMORY;
+    }
+}
+
+schrott_id_status schrott_id_decode(
+        const schrott_id_handle* handle,
+        const char* id,
+        size_t length,
+        uint64_t* value)
+{
+    try
+    {
+        return to_status(handle->encoder.try_decode(id, length, *value));
+    }
+    catch (const std::bad_alloc&)
+    {
+        return SCHROTT_ID_ERROR_OUT_OF_MEMORY;
+    }
+}
+
+schrott_id_status schrott_id_encode_batch(
+        const schrott_id_handle* handle,
+        const uint64_t* values,
+        size_t count,
+        char* out,
+        size_t out_size,
+        size_t* offsets)
+{
+    try
+    {
+        return to_status(handle->encoder.encode_batch(values, count, out, out_size, offsets));
+    }
+    catch (const std::bad_alloc&)
+    {
+        return SCHROTT_ID_ERROR_OUT_OF_MEMORY;
+    }
+}
+
+schrott_id_status schrott_id_encode_range(
+        const schrott_id_handle* handle,
+        uint64_t start,
+        size_t count,
+        char* out,
+        size_t out_size,
+        size_t* offsets)
+{
+    try
+    {
+        return to_status(handle->encoder.encode_range(start, count, out, out_size, offsets));
+    }
+    catch (const std::bad_alloc&)
+    {
+        return SCHROTT_ID_ERROR_OUT_OF_MEMORY;
+    }
+}
+
+size_t schrott_id_decode_batch(
+        const schrott_id_handle* handle,
+        const char* chars,
+        const size_t* offsets,
+        size_t count,
+        uint64_t* values,
+        schrott_id_status* statuses)
+{
+    // Decode in chunks so per-ID errors can be translated without allocating
+    const std::size_t kChunk = 256;
+    schrott_id::error errors[kChunk];
+    std::size_t failed = 0;
+
+    for (std::size_t pos = 0; pos < count; pos += kChunk)
+    {
+        auto n = std::min(kChunk, count - pos);
+
+        try
+        {
+            failed += handle->encoder.decode_batch(chars, offsets + pos, n, values + pos, errors);
+        }
+        catch (const std::bad_alloc&)
+        {
+            std::fill(values + pos, values + pos + n, 0);
+            failed += n;
+
+            if (statuses)
+            {
+                std::fill(statuses + pos, statuses + pos + n, SCHROTT_ID_ERROR_OUT_OF_MEMORY);
+            }
+
+            continue;
+        }
+
+        if (statuses)
+        {
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                statuses[pos + i] = to_status(errors[i]);
+            }
+        }
+    }
+
+    return failed;
+}
+
+schrott_id_status schrott_id_decode_batch_sorted_unique(
+        const schrott_id_handle* handle,
+        const char* chars,
+        const size_t* offsets,
+        size_t count,
+        uint64_t* values,
+        size_t* positions,
+        schrott_id_status* statuses,
+        size_t* unique)
+{
+    try
+    {
+        std::vector<schrott_id::error> errors(count);
+
+        *unique = handle->encoder.decode_batch_sorted_unique(
+                chars, offsets, count, values, positions, errors.data());
+
+        if (statuses)
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                statuses[i] = to_status(errors[i]);
+            }
+        }
+
+        return SCHROTT_ID_OK;
+    }
+    catch (const std::bad_alloc&)
+    {
+        return SCHROTT_ID_ERROR_OUT_OF_MEMORY;
+    }
+}
+
+}
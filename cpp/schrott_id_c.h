@@ -0,0 +1,221 @@
+/**
+ * C interface for generating SchrottIDs
+ *
+ * Wraps schrott_id.hpp behind an opaque handle and status codes so it can be called through FFI.
+ * Batch functions work on caller-owned arrays and buffers. Encoding and decoding use stack buffers, except for
+ * IDs longer than 128 characters, Feistel encoders whose domain exceeds 64 bits and
+ * schrott_id_decode_batch_sorted_unique, which allocate. No function lets an exception escape, failed
+ * allocations are reported as SCHROTT_ID_ERROR_OUT_OF_MEMORY.
+ *
+ * https://github.com/lorisleitner/schrott-id
+ */
+
+#ifndef SCHROTT_ID_C_H
+#define SCHROTT_ID_C_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#if defined(SCHROTT_ID_C_BUILD)
+#define SCHROTT_ID_C_API __declspec(dllexport)
+#else
+#define SCHROTT_ID_C_API __declspec(dllimport)
+#endif
+#else
+#define SCHROTT_ID_C_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Incremented whenever a function signature or the meaning of a status code changes */
+#define SCHROTT_ID_C_ABI_VERSION 1
+
+typedef int32_t schrott_id_status;
+
+#define SCHROTT_ID_OK 0
+#define SCHROTT_ID_ERROR_INVALID_ARGUMENT 1
+#define SCHROTT_ID_ERROR_INVALID_CHARACTER 2
+#define SCHROTT_ID_ERROR_BUFFER_TOO_SMALL 3
+#define SCHROTT_ID_ERROR_OUT_OF_MEMORY 4
+#define SCHROTT_ID_ERROR_OUT_OF_RANGE 5
+#define SCHROTT_ID_ERROR_INVALID_LENGTH 6
+#define SCHROTT_ID_ERROR_INVALID_PREFIX 7
+#define SCHROTT_ID_ERROR_UNKNOWN 255
+
+/** Algorithms of schrott_id_create_with_algorithm, see schrott_id::algorithm */
+#define SCHROTT_ID_ALGORITHM_CASCADE 0
+#define SCHROTT_ID_ALGORITHM_FEISTEL 1
+
+typedef struct schrott_id_handle schrott_id_handle;
+
+/**
+ * Returns SCHROTT_ID_C_ABI_VERSION of the loaded library.
+ */
+SCHROTT_ID_C_API uint32_t schrott_id_abi_version(void);
+
+/**
+ * Returns a static, null-terminated description of a status code.
+ */
+SCHROTT_ID_C_API const char* schrott_id_status_message(schrott_id_status status);
+
+/**
+ * Creates an encoder. Parameters are the same as for the C++ schrott_id_encoder constructor.
+ * @param alphabet Alphabet characters, not null-terminated
+ * @param alphabet_length Number of alphabet characters
+ * @param permutation Null-terminated Base64 permutation
+ * @param min_length Minimum length of encoded IDs
+ * @param handle Receives the encoder, release with schrott_id_destroy
+ * @return SCHROTT_ID_OK, SCHROTT_ID_ERROR_INVALID_ARGUMENT if a parameter cannot be used,
+ * SCHROTT_ID_ERROR_OUT_OF_MEMORY or SCHROTT_ID_ERROR_UNKNOWN
+ */
+SCHROTT_ID_C_API schrott_id_status schrott_id_create(
+        const char* alphabet,
+        size_t alphabet_length,
+        const char* permutation,
+        int32_t min_length,
+        schrott_id_handle** handle);
+
+/**
+ * Creates an encoder with a round schedule other than v3, see schrott_id::round_schedule.
+ * IDs of such encoders cannot be decoded by encoders with a different schedule.
+ * @param rounds_per_digit Rounds per digit of the ID, 3 for v3
+ * @param fixed_rounds Rounds added independently of the length, 0 for v3
+ * @return Same as schrott_id_create
+ */
+SCHROTT_ID_C_API schrott_id_status schrott_id_create_with_rounds(
+        const char* alphabet,
+        size_t alphabet_length,
+        const char* permutation,
+        int32_t min_length,
+        uint32_t rounds_per_digit,
+        uint32_t fixed_rounds,
+        schrott_id_handle** handle);
+
+/**
+ * Creates an encoder with an algorithm other than cascade, see schrott_id::algorithm.
+ * @param algorithm SCHROTT_ID_ALGORITHM_CASCADE or SCHROTT_ID_ALGORITHM_FEISTEL
+ * @return Same as schrott_id_create
+ */
+SCHROTT_ID_C_API schrott_id_status schrott_id_create_with_algorithm(
+        const char* alphabet,
+        size_t alphabet_length,
+        const char* permutation,
+        int32_t min_length,
+        int32_t algorithm,
+        schrott_id_handle** handle);
+
+/**
+ * Releases an encoder. Passing null is allowed.
+ */
+SCHROTT_ID_C_API void schrott_id_destroy(schrott_id_handle* handle);
+
+/**
+ * Generates a secure random permutation for an alphabet.
+ * @param out Receives the null-terminated Base64 permutation, 345 bytes are always enough
+ * @param out_size Size of out
+ * @return SCHROTT_ID_OK, SCHROTT_ID_ERROR_INVALID_ARGUMENT, SCHROTT_ID_ERROR_BUFFER_TOO_SMALL,
+ * SCHROTT_ID_ERROR_OUT_OF_MEMORY or SCHROTT_ID_ERROR_UNKNOWN
+ */
+SCHROTT_ID_C_API schrott_id_status schrott_id_generate_permutation(
+        const char* alphabet,
+        size_t alphabet_length,
+        char* out,
+        size_t out_size);
+
+/**
+ * Returns the length of the longest ID the encoder can produce.
+ * A buffer of count * schrott_id_max_encoded_length characters can hold any batch of count IDs.
+ */
+SCHROTT_ID_C_API size_t schrott_id_max_encoded_length(const schrott_id_handle* handle);
+
+/**
+ * Encodes a value.
+ * @param out Receives the ID, not null-terminated
+ * @param written Receives the number of characters written
+ * @return SCHROTT_ID_OK, SCHROTT_ID_ERROR_BUFFER_TOO_SMALL or SCHROTT_ID_ERROR_OUT_OF_MEMORY
+ */
+SCHROTT_ID_C_API schrott_id_status schrott_id_encode(
+        const schrott_id_handle* handle,
+        uint64_t value,
+        char* out,
+        size_t out_size,
+        size_t* written);
+
+/**
+ * Decodes an ID.
+ * @return SCHROTT_ID_OK, SCHROTT_ID_ERROR_INVALID_CHARACTER, SCHROTT_ID_ERROR_OUT_OF_RANGE if a Feistel encoder
+ * decodes the ID to a value beyond 64 bits, or SCHROTT_ID_ERROR_OUT_OF_MEMORY
+ */
+SCHROTT_ID_C_API schrott_id_status schrott_id_decode(
+        const schrott_id_handle* handle,
+        const char* id,
+        size_t length,
+        uint64_t* value);
+
+/**
+ * Encodes count values into out, back to back.
+ * The i-th ID occupies out[offsets[i]] to out[offsets[i + 1]], offsets must have room for count + 1 elements.
+ * @return SCHROTT_ID_OK, SCHROTT_ID_ERROR_BUFFER_TOO_SMALL or SCHROTT_ID_ERROR_OUT_OF_MEMORY
+ */
+SCHROTT_ID_C_API schrott_id_status schrott_id_encode_batch(
+        const schrott_id_handle* handle,
+        const uint64_t* values,
+        size_t count,
+        char* out,
+        size_t out_size,
+        size_t* offsets);
+
+/**
+ * Encodes the consecutive values start to start + count - 1, same layout as schrott_id_encode_batch.
+ * @return SCHROTT_ID_OK, SCHROTT_ID_ERROR_BUFFER_TOO_SMALL, SCHROTT_ID_ERROR_OUT_OF_RANGE
+ * if the range exceeds the largest 64-bit value, or SCHROTT_ID_ERROR_OUT_OF_MEMORY
+ */
+SCHROTT_ID_C_API schrott_id_status schrott_id_encode_range(
+        const schrott_id_handle* handle,
+        uint64_t start,
+        size_t count,
+        char* out,
+        size_t out_size,
+        size_t* offsets);
+
+/**
+ * Decodes count IDs stored back to back in chars, delimited by count + 1 offsets.
+ * @param values Receives the decoded values, 0 for IDs that failed to decode
+ * @param statuses Receives a status per ID, may be null: the statuses of schrott_id_decode
+ * @return Number of IDs that failed to decode
+ */
+SCHROTT_ID_C_API size_t schrott_id_decode_batch(
+        const schrott_id_handle* handle,
+        const char* chars,
+        const size_t* offsets,
+        size_t count,
+        uint64_t* values,
+        schrott_id_status* statuses);
+
+/**
+ * Decodes count IDs like schrott_id_decode_batch, then sorts and deduplicates the values.
+ * @param values Receives the sorted, unique values, must have room for count elements
+ * @param positions Receives, for every ID, the index of its value in values or SIZE_MAX if it failed
+ * @param statuses Receives a status per ID, may be null: SCHROTT_ID_OK, SCHROTT_ID_ERROR_INVALID_CHARACTER
+ * or SCHROTT_ID_ERROR_OUT_OF_RANGE
+ * @param unique Receives the number of unique values
+ * @return SCHROTT_ID_OK or SCHROTT_ID_ERROR_OUT_OF_MEMORY, failed IDs are only reported through statuses
+ */
+SCHROTT_ID_C_API schrott_id_status schrott_id_decode_batch_sorted_unique(
+        const schrott_id_handle* handle,
+        const char* chars,
+        const size_t* offsets,
+        size_t count,
+        uint64_t* values,
+        size_t* positions,
+        schrott_id_status* statuses,
+        size_t* unique);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SCHROTT_ID_C_H
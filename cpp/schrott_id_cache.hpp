@@ -0,0 +1,497 @@
+/**
+ * Concurrent bounded cache for SchrottID encoders
+ *
+ * https://github.com/lorisleitner/schrott-id
+ */
+
+#ifndef SCHROTT_ID_CACHE_HPP
+#define SCHROTT_ID_CACHE_HPP
+
+#include <atomic>
+#include <cstring>
+#include <memory>
+
+#include "schrott_id.hpp"
+
+namespace schrott_id
+{
+    /**
+     * Hit and miss counters of a @see schrott_id_cache
+     */
+    struct cache_stats
+    {
+        std::uint64_t encode_hits;
+        std::uint64_t encode_misses;
+        std::uint64_t decode_hits;
+        std::uint64_t decode_misses;
+    };
+
+    namespace detail
+    {
+        /**
+         * Returns a small per-thread index used to spread counters over cache lines.
+         */
+        inline std::size_t thread_stripe()
+        {
+            static std::atomic<std::size_t> next{0};
+            thread_local std::size_t stripe = next.fetch_add(1, std::memory_order_relaxed);
+            return stripe;
+        }
+    }
+
+    /**
+     * Caches encode and decode results of a @see schrott_id_encoder.
+     *
+     * The cache is a fixed-capacity, set-associative table with CLOCK eviction per set.
+     * Each slot is guarded by a sequence lock, so lookups never block, never allocate
+     * and only write shared memory when a slot's reference bit has to be set.
+     * Inserts are best effort and are skipped when another thread is writing the same slot.
+     * IDs longer than @see kMaxIdLength characters are never cached.
+     *
+     * All member functions are safe to call concurrently.
+     */
+    class schrott_id_cache
+    {
+    public:
+        static const std::size_t kMaxIdLength = 24;
+        static const std::size_t kWays = 8;
+
+    private:
+        static const std::size_t kIdWords = kMaxIdLength / 8;
+        static const std::size_t kStripes = 64;
+
+        struct slot
+        {
+            std::atomic<std::uint32_t> sequence;
+            std::atomic<std::uint8_t> length;
+            std::atomic<std::uint8_t> referenced;
+            std::atomic<std::uint64_t> value;
+            std::atomic<std::uint64_t> id[kIdWords];
+
+            slot()
+                    : sequence(0),
+                      length(0),
+                      referenced(0),
+                      value(0)
+            {
+                for (auto& word: id)
+                {
+                    word.store(0, std::memory_order_relaxed);
+                }
+            }
+        };
+
+        struct table
+        {
+            std::unique_ptr<slot[]> slots;
+            std::unique_ptr<std::atomic<std::uint8_t>[]> hands;
+            std::size_t set_mask;
+
+            explicit table(std::size_t sets)
+                    : slots(new slot[sets * kWays]),
+                      hands(new std::atomic<std::uint8_t>[sets]),
+                      set_mask(sets - 1)
+            {
+                for (std::size_t i = 0; i < sets; ++i)
+                {
+                    hands[i].store(0, std::memory_order_relaxed);
+                }
+            }
+        };
+
+        // Padded to a cache line so threads counting at the same time do not share lines
+        struct stripe
+        {
+            std::atomic<std::uint64_t> counters[4];
+            char padding[64 - 4 * sizeof(std::atomic<std::uint64_t>)];
+
+            stripe()
+            {
+                for (auto& counter: counters)
+                {
+                    counter.store(0, std::memory_order_relaxed);
+                }
+            }
+        };
+
+        enum counter
+        {
+            encode_hit = 0,
+            encode_miss,
+            decode_hit,
+            decode_miss
+        };
+
+        schrott_id_encoder encoder_;
+        table encode_table_;
+        table decode_table_;
+        std::unique_ptr<stripe[]> stripes_;
+
+    public:
+
+        /**
+         * Creates a new cache around an encoder.
+         * @param encoder The encoder whose results are cached
+         * @param capacity Number of entries per direction, rounded up to a power of two multiple of @see kWays
+         */
+        schrott_id_cache(schrott_id_encoder encoder, std::size_t capacity)
+                : encoder_(std::move(encoder)),
+                  encode_table_(set_count(capacity)),
+                  decode_table_(set_count(capacity)),
+                  stripes_(new stripe[kStripes])
+        {
+        }
+
+        /**
+         * Returns the cached encoder.
+         */
+        const schrott_id_encoder& encoder() const
+        {
+            return encoder_;
+        }
+
+        /**
+         * Encodes an integer value to a SchrottID
+         * @see schrott_id_encoder::encode
+         */
+        std::string encode(std::uint64_t value) const
+        {
+            char buf[kMaxIdLength];
+
+            if (auto len = find_encoded(value, buf))
+            {
+                count(encode_hit);
+                return std::string(buf, len);
+            }
+
+            count(encode_miss);
+
+            auto s = encoder_.encode(value);
+            insert(encode_table_, hash_value(value), value, s.data(), s.size());
+
+            return s;
+        }
+
+        /**
+         * Encodes an integer value to a SchrottID into a caller-owned buffer
+         * @see schrott_id_encoder::encode_to
+         */
+        std::size_t encode_to(std::uint64_t value, char* out, std::size_t out_size) const
+        {
+            char buf[kMaxIdLength];
+
+            if (auto len = find_encoded(value, buf))
+            {
+                count(encode_hit);
+
+                if (len > out_size)
+                {
+                    return 0;
+                }
+
+                std::memcpy(out, buf, len);
+                return len;
+            }
+
+            count(encode_miss);
+
+            auto len = encoder_.encode_to(value, out, out_size);
+
+            if (len)
+            {
+                insert(encode_table_, hash_value(value), value, out, len);
+            }
+
+            return len;
+        }
+
+        /**
+         * Decodes a SchrottID back to an integer value
+         * @see schrott_id_encoder::decode
+         */
+        std::uint64_t decode(const std::string& value) const
+        {
+            std::uint64_t result;
+            auto e = try_decode(value.data(), value.size(), result);
+
+            if (e != error::none)
+            {
+                SCHROTT_ID_THROW(std::out_of_range, error_message(e));
+            }
+
+            return result;
+        }
+
+        /**
+         * Decodes a SchrottID back to an integer value without throwing on invalid input
+         * @see schrott_id_encoder::try_decode
+         */
+        error try_decode(const char* data, std::size_t size, std::uint64_t& value) const
+        {
+            if (size > 0 && size <= kMaxIdLength)
+            {
+                std::uint64_t words[kIdWords];
+                pack(data, size, words);
+
+                auto hash = hash_id(words);
+
+                if (find_decoded(hash, words, size, value))
+                {
+                    count(decode_hit);
+                    return error::none;
+                }
+
+                count(decode_miss);
+
+                auto e = encoder_.try_decode(data, size, value);
+
+                if (e == error::none)
+                {
+                    insert(decode_table_, hash, value, data, size);
+                }
+
+                return e;
+            }
+
+            count(decode_miss);
+            return encoder_.try_decode(data, size, value);
+        }
+
+        /**
+         * Returns the hit and miss counters accumulated since construction or the last @see reset_stats.
+         * Counters are read without stopping other threads and may be slightly behind.
+         */
+        cache_stats stats() const
+        {
+            std::uint64_t totals[4] = {};
+
+            for (std::size_t i = 0; i < kStripes; ++i)
+            {
+                for (auto c = 0; c < 4; ++c)
+                {
+                    totals[c] += stripes_[i].counters[c].load(std::memory_order_relaxed);
+                }
+            }
+
+            return cache_stats{totals[encode_hit], totals[encode_miss], totals[decode_hit], totals[decode_miss]};
+        }
+
+        /**
+         * Sets all hit and miss counters to 0.
+         */
+        void reset_stats()
+        {
+            for (std::size_t i = 0; i < kStripes; ++i)
+            {
+                for (auto& counter: stripes_[i].counters)
+                {
+                    counter.store(0, std::memory_order_relaxed);
+                }
+            }
+        }
+
+    private:
+
+        static std::size_t set_count(std::size_t capacity)
+        {
+            std::size_t sets = 1;
+
+            while (sets * kWays < capacity)
+            {
+                sets *= 2;
+            }
+
+            return sets;
+        }
+
+        static std::uint64_t mix(std::uint64_t x)
+        {
+            x ^= x >> 33;
+            x *= 0xFF51AFD7ED558CCDull;
+            x ^= x >> 33;
+            x *= 0xC4CEB9FE1A85EC53ull;
+            x ^= x >> 33;
+            return x;
+        }
+
+        static std::uint64_t hash_value(std::uint64_t value)
+        {
+            return mix(value);
+        }
+
+        static std::uint64_t hash_id(const std::uint64_t* words)
+        {
+            std::uint64_t hash = 0;
+
+            for (std::size_t i = 0; i < kIdWords; ++i)
+            {
+                hash = mix(hash ^ words[i]);
+            }
+
+            return hash;
+        }
+
+        static void pack(const char* data, std::size_t size, std::uint64_t* words)
+        {
+            std::memset(words, 0, kIdWords * sizeof(std::uint64_t));
+            std::memcpy(words, data, size);
+        }
+
+        void count(counter c) const
+        {
+            SCHROTT_ID_COUNT_CACHE(c == encode_hit || c == decode_hit);
+
+            stripes_[detail::thread_stripe() % kStripes].counters[c].fetch_add(1, std::memory_order_relaxed);
+        }
+
+        std::size_t find_encoded(std::uint64_t value, char* out) const
+        {
+            auto set = &encode_table_.slots[(hash_value(value) & encode_table_.set_mask) * kWays];
+
+            for (std::size_t way = 0; way < kWays; ++way)
+            {
+                auto& s = set[way];
+                auto sequence = s.sequence.load(std::memory_order_acquire);
+
+                if (sequence == 0
+                    || (sequence & 1)
+                    || s.value.load(std::memory_order_relaxed) != value)
+                {
+                    continue;
+                }
+
+                std::uint64_t words[kIdWords];
+                for (std::size_t i = 0; i < kIdWords; ++i)
+                {
+                    words[i] = s.id[i].load(std::memory_order_relaxed);
+                }
+                std::size_t len = s.length.load(std::memory_order_relaxed);
+
+                std::atomic_thread_fence(std::memory_order_acquire);
+
+                if (s.sequence.load(std::memory_order_relaxed) != sequence)
+                {
+                    continue;
+                }
+
+                touch(s);
+                std::memcpy(out, words, len);
+
+                return len;
+            }
+
+            return 0;
+        }
+
+        bool find_decoded(std::uint64_t hash, const std::uint64_t* words, std::size_t size, std::uint64_t& value) const
+        {
+            auto set = &decode_table_.slots[(hash & decode_table_.set_mask) * kWays];
+
+            for (std::size_t way = 0; way < kWays; ++way)
+            {
+                auto& s = set[way];
+                auto sequence = s.sequence.load(std::memory_order_acquire);
+
+                if (sequence == 0
+                    || (sequence & 1)
+                    || s.length.load(std::memory_order_relaxed) != size)
+                {
+                    continue;
+                }
+
+                auto match = true;
+                for (std::size_t i = 0; i < kIdWords; ++i)
+                {
+                    match &= s.id[i].load(std::memory_order_relaxed) == words[i];
+                }
+                auto result = s.value.load(std::memory_order_relaxed);
+
+                std::atomic_thread_fence(std::memory_order_acquire);
+
+                if (!match || s.sequence.load(std::memory_order_relaxed) != sequence)
+                {
+                    continue;
+                }
+
+                touch(s);
+                value = result;
+
+                return true;
+            }
+
+            return false;
+        }
+
+        static void touch(slot& s)
+        {
+            // Only write when the bit changes so hot entries do not bounce between cores
+            if (!s.referenced.load(std::memory_order_relaxed))
+            {
+                s.referenced.store(1, std::memory_order_relaxed);
+            }
+        }
+
+        void insert(
+                const table& t,
+                std::uint64_t hash,
+                std::uint64_t value,
+                const char* id,
+                std::size_t length) const
+        {
+            if (length == 0 || length > kMaxIdLength)
+            {
+                return;
+            }
+
+            auto set_index = hash & t.set_mask;
+            auto set = &t.slots[set_index * kWays];
+            auto& hand = t.hands[set_index];
+
+            // CLOCK: clear reference bits until an unreferenced slot comes up
+            slot* victim = nullptr;
+            for (std::size_t i = 0; i < 2 * kWays && !victim; ++i)
+            {
+                auto& s = set[hand.fetch_add(1, std::memory_order_relaxed) % kWays];
+
+                if (s.referenced.load(std::memory_order_relaxed))
+                {
+                    s.referenced.store(0, std::memory_order_relaxed);
+                }
+                else
+                {
+                    victim = &s;
+                }
+            }
+
+            if (!victim)
+            {
+                return;
+            }
+
+            auto sequence = victim->sequence.load(std::memory_order_relaxed);
+
+            if ((sequence & 1)
+                || !victim->sequence.compare_exchange_strong(sequence, sequence + 1, std::memory_order_acquire))
+            {
+                return;
+            }
+
+            std::atomic_thread_fence(std::memory_order_release);
+
+            std::uint64_t words[kIdWords];
+            pack(id, length, words);
+
+            victim->value.store(value, std::memory_order_relaxed);
+            victim->length.store(static_cast<std::uint8_t>(length), std::memory_order_relaxed);
+            for (std::size_t i = 0; i < kIdWords; ++i)
+            {
+                victim->id[i].store(words[i], std::memory_order_relaxed);
+            }
+            victim->referenced.store(0, std::memory_order_relaxed);
+
+            victim->sequence.store(sequence + 2, std::memory_order_release);
+        }
+    };
+}
+
+#endif // SCHROTT_ID_CACHE_HPP
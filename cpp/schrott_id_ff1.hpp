@@ -0,0 +1,1108 @@
+/**
+ * Format-preserving encryption of SchrottIDs with FF1 (NIST SP 800-38G)
+ *
+ * https://github.com/lorisleitner/schrott-id
+ */
+
+#ifndef SCHROTT_ID_FF1_HPP
+#define SCHROTT_ID_FF1_HPP
+
+#include "schrott_id.hpp"
+
+#if !defined(SCHROTT_ID_NO_AESNI) \
+    && (defined(__x86_64__) || defined(__i386__)) \
+    && (defined(__GNUC__) || defined(__clang__))
+#define SCHROTT_ID_AESNI 1
+#include <wmmintrin.h>
+#endif
+
+namespace schrott_id
+{
+    namespace detail
+    {
+        /**
+         * Constant-time software AES, four blocks at a time.
+         *
+         * The 64 bytes of four blocks are bitsliced into eight words, word k holding bit k of every byte,
+         * so SubBytes is computed with logic operations on the words instead of secret-dependent table
+         * lookups. The S-box is the inverse x^254 in GF(2^8) followed by the affine transformation.
+         */
+        namespace aes_portable
+        {
+            typedef std::uint64_t planes[8];
+
+            inline void pack(const byte* bytes, planes p)
+            {
+                for (std::size_t k = 0; k < 8; ++k)
+                {
+                    std::uint64_t word = 0;
+
+                    for (std::size_t j = 0; j < 64; ++j)
+                    {
+                        word |= static_cast<std::uint64_t>((bytes[j] >> k) & 1) << j;
+                    }
+
+                    p[k] = word;
+                }
+            }
+
+            inline void unpack(const planes p, byte* bytes)
+            {
+                for (std::size_t j = 0; j < 64; ++j)
+                {
+                    unsigned b = 0;
+
+                    for (std::size_t k = 0; k < 8; ++k)
+                    {
+                        b |= static_cast<unsigned>((p[k] >> j) & 1) << k;
+                    }
+
+                    bytes[j] = static_cast<byte>(b);
+                }
+            }
+
+            // Reduces a product of up to 15 bit planes modulo x^8 + x^4 + x^3 + x + 1
+            inline void reduce(std::uint64_t* t, planes out)
+            {
+                for (std::size_t k = 14; k >= 8; --k)
+                {
+                    t[k - 4] ^= t[k];
+                    t[k - 5] ^= t[k];
+                    t[k - 7] ^= t[k];
+                    t[k - 8] ^= t[k];
+                }
+
+                for (std::size_t k = 0; k < 8; ++k)
+                {
+                    out[k] = t[k];
+                }
+            }
+
+            inline void multiply(const planes a, const planes b, planes out)
+            {
+                std::uint64_t t[15] = {};
+
+                for (std::size_t i = 0; i < 8; ++i)
+                {
+                    for (std::size_t j = 0; j < 8; ++j)
+                    {
+                        t[i + j] ^= a[i] & b[j];
+                    }
+                }
+
+                reduce(t, out);
+            }
+
+            inline void square(const planes a, planes out)
+            {
+                std::uint64_t t[15] = {};
+
+                for (std::size_t i = 0; i < 8; ++i)
+                {
+                    t[2 * i] = a[i];
+                }
+
+                reduce(t, out);
+            }
+
+            inline void sub_bytes(planes x)
+            {
+                planes x2, x3, x12, t;
+
+                square(x, x2);
+                multiply(x2, x, x3);
+                square(x3, t);
+                square(t, x12);
+                multiply(x12, x3, t);   // x^15
+                square(t, t);
+                square(t, t);
+                square(t, t);
+                square(t, t);           // x^240
+                multiply(t, x12, t);    // x^252
+                multiply(t, x2, t);     // x^254
+
+                for (std::size_t i = 0; i < 8; ++i)
+                {
+                    x[i] = t[i] ^ t[(i + 4) % 8] ^ t[(i + 5) % 8] ^ t[(i + 6) % 8] ^ t[(i + 7) % 8]
+                           ^ ((0x63 >> i) & 1 ? ~std::uint64_t{0} : 0);
+                }
+            }
+
+            // Byte p of a block is row p % 4 of column p / 4. Row r moves left by r columns, which within
+            // each 16-bit block lane takes bit p from bit p + 4r.
+            inline void shift_rows(planes x)
+            {
+                const std::uint64_t kLanes = 0x0001000100010001ull;
+
+                for (std::size_t k = 0; k < 8; ++k)
+                {
+                    auto word = x[k];
+
+                    for (unsigned r = 1; r < 4; ++r)
+                    {
+                        auto row = 0x1111111111111111ull << r;
+                        auto low = ((1ull << (16 - 4 * r)) - 1) * kLanes;
+                        auto t = word & row;
+
+                        word = (word & ~row) | ((t >> (4 * r)) & low) | ((t << (16 - 4 * r)) & ~low);
+                    }
+
+                    x[k] = word;
+                }
+            }
+
+            // Rotates the rows of every column up by n, so row r takes row r + n
+            inline std::uint64_t rotate_rows(std::uint64_t x, unsigned n)
+            {
+                const std::uint64_t kNibble = 0x1111111111111111ull;
+                auto keep = ((1ull << (4 - n)) - 1) * kNibble;
+
+                return ((x >> n) & keep) | ((x << (4 - n)) & ~keep);
+            }
+
+            // b[r] = 2 * (a[r] + a[r + 1]) + a[r + 1] + a[r + 2] + a[r + 3] in GF(2^8)
+            inline void mix_columns(planes x)
+            {
+                planes s, rest;
+
+                for (std::size_t k = 0; k < 8; ++k)
+                {
+                    auto r1 = rotate_rows(x[k], 1);
+                    s[k] = x[k] ^ r1;
+                    rest[k] = r1 ^ rotate_rows(x[k], 2) ^ rotate_rows(x[k], 3);
+                }
+
+                x[0] = s[7] ^ rest[0];
+                x[1] = s[0] ^ s[7] ^ rest[1];
+                x[2] = s[1] ^ rest[2];
+                x[3] = s[2] ^ s[7] ^ rest[3];
+                x[4] = s[3] ^ s[7] ^ rest[4];
+                x[5] = s[4] ^ rest[5];
+                x[6] = s[5] ^ rest[6];
+                x[7] = s[6] ^ rest[7];
+            }
+
+            /**
+             * Encrypts four blocks stored back to back in place.
+             * @param round_keys rounds + 1 round keys, each repeated for four blocks and bitsliced
+             */
+            inline void encrypt4(const planes* round_keys, unsigned rounds, byte* blocks)
+            {
+                planes x;
+                pack(blocks, x);
+
+                for (std::size_t k = 0; k < 8; ++k)
+                {
+                    x[k] ^= round_keys[0][k];
+                }
+
+                for (unsigned round = 1; round <= rounds; ++round)
+                {
+                    sub_bytes(x);
+                    shift_rows(x);
+
+                    if (round < rounds)
+                    {
+                        mix_columns(x);
+                    }
+
+                    for (std::size_t k = 0; k < 8; ++k)
+                    {
+                        x[k] ^= round_keys[round][k];
+                    }
+                }
+
+                unpack(x, blocks);
+            }
+        }
+
+#if SCHROTT_ID_AESNI
+
+        __attribute__((target("aes,sse2")))
+        inline void encrypt_aesni(const byte* round_keys, unsigned rounds, byte* blocks, std::size_t count)
+        {
+            // Eight independent blocks keep the AES unit busy while each one waits for its previous round
+            const std::size_t kPipeline = 8;
+
+            __m128i keys[15];
+            for (unsigned r = 0; r <= rounds; ++r)
+            {
+                keys[r] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(round_keys + 16 * r));
+            }
+
+            std::size_t i = 0;
+
+            for (; i + kPipeline <= count; i += kPipeline)
+            {
+                __m128i b[kPipeline];
+                auto p = reinterpret_cast<__m128i*>(blocks + 16 * i);
+
+                for (std::size_t j = 0; j < kPipeline; ++j)
+                {
+                    b[j] = _mm_xor_si128(_mm_loadu_si128(p + j), keys[0]);
+                }
+
+                for (unsigned r = 1; r < rounds; ++r)
+                {
+                    for (std::size_t j = 0; j < kPipeline; ++j)
+                    {
+                        b[j] = _mm_aesenc_si128(b[j], keys[r]);
+                    }
+                }
+
+                for (std::size_t j = 0; j < kPipeline; ++j)
+                {
+                    _mm_storeu_si128(p + j, _mm_aesenclast_si128(b[j], keys[rounds]));
+                }
+            }
+
+            for (; i < count; ++i)
+            {
+                auto p = reinterpret_cast<__m128i*>(blocks + 16 * i);
+                auto b = _mm_xor_si128(_mm_loadu_si128(p), keys[0]);
+
+                for (unsigned r = 1; r < rounds; ++r)
+                {
+                    b = _mm_aesenc_si128(b, keys[r]);
+                }
+
+                _mm_storeu_si128(p, _mm_aesenclast_si128(b, keys[rounds]));
+            }
+        }
+
+        inline bool cpu_has_aesni()
+        {
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("aes");
+        }
+
+#endif
+
+        /**
+         * AES encryption with 128, 192 or 256-bit keys, which is all FF1 needs.
+         * Uses AES-NI when the CPU has it, the constant-time software implementation otherwise.
+         */
+        class aes
+        {
+        private:
+            byte round_keys_[15 * 16];
+            aes_portable::planes round_planes_[15];
+            unsigned rounds_;
+            bool hardware_;
+
+        public:
+
+            /**
+             * Expands a key.
+             * @param key Key bytes
+             * @param size 16, 24 or 32
+             * @param hardware If false, never use AES-NI
+             * @throws std::invalid_argument The key size is not supported.
+             */
+            aes(const byte* key, std::size_t size, bool hardware = true)
+            {
+                if (size != 16 && size != 24 && size != 32)
+                {
+                    SCHROTT_ID_THROW(std::invalid_argument, "AES key must have 16, 24 or 32 bytes");
+                }
+
+                const auto nk = size / 4;
+                rounds_ = static_cast<unsigned>(nk + 6);
+
+                std::memcpy(round_keys_, key, size);
+
+                byte rcon = 1;
+
+                for (auto i = nk; i < 4 * (rounds_ + 1); ++i)
+                {
+                    byte t[4];
+                    std::memcpy(t, round_keys_ + 4 * (i - 1), 4);
+
+                    if (i % nk == 0)
+                    {
+                        byte rotated[4] = {t[1], t[2], t[3], t[0]};
+                        sub_word(rotated, t);
+                        t[0] ^= rcon;
+                        rcon = static_cast<byte>((rcon << 1) ^ (rcon & 0x80 ? 0x1B : 0));
+                    }
+                    else if (nk > 6 && i % nk == 4)
+                    {
+                        byte word[4] = {t[0], t[1], t[2], t[3]};
+                        sub_word(word, t);
+                    }
+
+                    for (std::size_t j = 0; j < 4; ++j)
+                    {
+                        round_keys_[4 * i + j] = round_keys_[4 * (i - nk) + j] ^ t[j];
+                    }
+                }
+
+                for (unsigned r = 0; r <= rounds_; ++r)
+                {
+                    byte repeated[64];
+                    for (std::size_t j = 0; j < 64; ++j)
+                    {
+                        repeated[j] = round_keys_[16 * r + j % 16];
+                    }
+
+                    aes_portable::pack(repeated, round_planes_[r]);
+                }
+
+#if SCHROTT_ID_AESNI
+                hardware_ = hardware && cpu_has_aesni();
+#else
+                (void) hardware;
+                hardware_ = false;
+#endif
+            }
+
+            unsigned rounds() const
+            {
+                return rounds_;
+            }
+
+            /**
+             * Returns true if blocks are encrypted with AES-NI.
+             */
+            bool hardware() const
+            {
+                return hardware_;
+            }
+
+            /**
+             * Encrypts count blocks of 16 bytes stored back to back in place.
+             * Independent blocks are processed together, so passing many at once is faster.
+             */
+            void encrypt(byte* blocks, std::size_t count) const
+            {
+#if SCHROTT_ID_AESNI
+                if (hardware_)
+                {
+                    encrypt_aesni(round_keys_, rounds_, blocks, count);
+                    return;
+                }
+#endif
+
+                for (std::size_t i = 0; i < count; i += 4)
+                {
+                    byte four[64] = {};
+                    auto n = std::min<std::size_t>(4, count - i);
+
+                    std::memcpy(four, blocks + 16 * i, 16 * n);
+                    aes_portable::encrypt4(round_planes_, rounds_, four);
+                    std::memcpy(blocks + 16 * i, four, 16 * n);
+                }
+            }
+
+        private:
+
+            static void sub_word(const byte* in, byte* out)
+            {
+                byte bytes[64] = {};
+                aes_portable::planes x;
+
+                std::memcpy(bytes, in, 4);
+                aes_portable::pack(bytes, x);
+                aes_portable::sub_bytes(x);
+                aes_portable::unpack(x, bytes);
+                std::memcpy(out, bytes, 4);
+            }
+        };
+    }
+
+    /**
+     * Encodes and decodes SchrottIDs with FF1 format-preserving encryption (NIST SP 800-38G).
+     *
+     * Values are written as digits of the alphabet like @see schrott_id_encoder does and the digits
+     * are encrypted with FF1 under an AES key instead of the cascade rounds. IDs have the same lengths
+     * as v3 IDs, but at least the FF1 minimum of alphabet_size^length >= 1,000,000 and are unrelated
+     * to v3 IDs of the same value.
+     *
+     * Batch functions run FF1 on up to eight IDs of the same length in lockstep, so their AES blocks
+     * are independent and overlap in the pipeline.
+     */
+    class ff1_encoder
+    {
+    private:
+        static const std::size_t kMaxDigits = 128;
+        static const std::size_t kMaxTweak = 256;
+        static const std::size_t kLanes = 8;
+        static const std::size_t kRounds = 10;
+
+        // Q is the tweak, padding, the round number and NUM(B) of up to 64 bytes
+        static const std::size_t kMaxQ = (kMaxTweak + 1 + kMaxDigits / 2 + 15) / 16 * 16;
+
+        // S holds d = 4 * ceil(b / 4) + 4 <= 68 bytes
+        static const std::size_t kMaxSBlocks = 5;
+        static const std::size_t kWords = 9;
+
+        struct length_parameters
+        {
+            std::size_t b;
+            std::size_t d;
+
+            // Encrypted first block of the PRF input, which only depends on the length
+            byte p[16];
+        };
+
+        std::string alphabet_;
+        std::int16_t inverse_alphabet_[256];
+        int min_length_;
+        std::vector<byte> tweak_;
+        std::size_t key_bits_;
+        detail::aes cipher_;
+        std::vector<length_parameters> lengths_;
+
+    public:
+
+        /**
+         * Creates a new FF1 encoder.
+         * @param alphabet The alphabet of the IDs, 2 to 256 unique characters
+         * @param key AES key of 16, 24 or 32 bytes. Keep it secret, it is all that protects the values.
+         * @param min_length The minimum length of encoded IDs, raised to the FF1 minimum for the alphabet
+         * @param tweak FF1 tweak of up to 256 bytes, IDs of different tweaks are unrelated
+         * @param hardware_aes If false, always use the portable constant-time AES
+         * @throws std::invalid_argument A supplied parameter cannot be used to create an encoder.
+         */
+        ff1_encoder(
+                std::string alphabet,
+                const std::vector<byte>& key,
+                int min_length,
+                const std::vector<byte>& tweak = std::vector<byte>(),
+                bool hardware_aes = true)
+                : alphabet_(std::move(alphabet)),
+                  min_length_(min_length),
+                  tweak_(tweak),
+                  key_bits_(key.size() * 8),
+                  cipher_(key.data(), key.size(), hardware_aes)
+        {
+            if (alphabet_.size() <= 1
+                || alphabet_.size() > 256)
+            {
+                SCHROTT_ID_THROW(std::invalid_argument, "Alphabet must have 2 to 256 characters");
+            }
+
+            if (!util::is_unique(alphabet_.begin(), alphabet_.end()))
+            {
+                SCHROTT_ID_THROW(std::invalid_argument, "Alphabet must have unique characters");
+            }
+
+            if (min_length_ <= 0 || min_length_ > static_cast<int>(kMaxDigits))
+            {
+                SCHROTT_ID_THROW(std::invalid_argument, "min_length must be between 1 and 128");
+            }
+
+            if (tweak_.size() > kMaxTweak)
+            {
+                SCHROTT_ID_THROW(std::invalid_argument, "Tweak must have at most 256 bytes");
+            }
+
+            std::fill(std::begin(inverse_alphabet_), std::end(inverse_alphabet_), -1);
+            for (std::size_t i = 0; i < alphabet_.size(); ++i)
+            {
+                inverse_alphabet_[static_cast<byte>(alphabet_[i])] = static_cast<std::int16_t>(i);
+            }
+
+            // FF1 needs at least a million possible numeral strings
+            std::uint64_t domain = 1;
+            auto ff1_min_length = 0;
+            while (domain < 1000000 || ff1_min_length < 2)
+            {
+                domain *= alphabet_.size();
+                ++ff1_min_length;
+            }
+
+            min_length_ = std::max(min_length_, ff1_min_length);
+
+            build_lengths();
+        }
+
+        const std::string& alphabet() const
+        {
+            return alphabet_;
+        }
+
+        /**
+         * Returns the minimum length of encoded IDs, at least the FF1 minimum for the alphabet.
+         */
+        int min_length() const
+        {
+            return min_length_;
+        }
+
+        /**
+         * Returns true if AES runs on AES-NI instructions.
+         */
+        bool hardware_aes() const
+        {
+            return cipher_.hardware();
+        }
+
+        /**
+         * Returns the version tag of the IDs this encoder produces, like ff1-aes128.
+         */
+        std::string version() const
+        {
+            return "ff1-aes" + std::to_string(key_bits_);
+        }
+
+        /**
+         * Returns the length of the SchrottID for a value.
+         */
+        std::size_t encoded_length(std::uint64_t value) const
+        {
+            return std::max(detail::reference_digits(value, alphabet_.size()), static_cast<std::size_t>(min_length_));
+        }
+
+        /**
+         * Returns the length of the longest SchrottID this encoder can produce.
+         */
+        std::size_t max_encoded_length() const
+        {
+            return encoded_length(UINT64_MAX);
+        }
+
+        /**
+         * Encodes an integer value to a SchrottID
+         * @param value The value to encode
+         * @return Encoded SchrottID
+         */
+        std::string encode(std::uint64_t value) const
+        {
+            std::string s(encoded_length(value), '\0');
+            encode_to(value, &s[0], s.size());
+            return s;
+        }
+
+        /**
+         * Encodes an integer value to a SchrottID into a caller-owned buffer.
+         * @return Number of characters written, 0 if the buffer is smaller than @see encoded_length
+         */
+        std::size_t encode_to(std::uint64_t value, char* out, std::size_t out_size) const
+        {
+            SCHROTT_ID_MEASURE(encode, value);
+
+            auto len = encoded_length(value);
+
+            if (len > out_size)
+            {
+                SCHROTT_ID_COUNT_ERROR(error::buffer_too_small);
+                return 0;
+            }
+
+            SCHROTT_ID_COUNT_IDS(len, 1);
+
+            auto buf = reinterpret_cast<byte*>(out);
+
+            to_digits(value, buf, len);
+            ff1(buf, len, 1, false);
+            to_chars(buf, len);
+
+            return len;
+        }
+
+        /**
+         * Decodes a SchrottID back to an integer value
+         * @param value The value to decode
+         * @return The decoded value
+         * @throws std::out_of_range The supplied value is not a valid SchrottID of this encoder.
+         */
+        std::uint64_t decode(const std::string& value) const
+        {
+            std::uint64_t result;
+            auto e = try_decode(value.data(), value.size(), result);
+
+            if (e != error::none)
+            {
+                SCHROTT_ID_THROW(std::out_of_range, error_message(e));
+            }
+
+            return result;
+        }
+
+        /**
+         * Decodes a SchrottID back to an integer value without throwing on invalid input.
+         * @return error::none, error::invalid_character, error::invalid_length if the SchrottID is shorter
+         * than the minimum length or error::range_overflow if it stands for a value beyond 64 bits
+         */
+        error try_decode(const char* data, std::size_t size, std::uint64_t& value) const
+        {
+            SCHROTT_ID_MEASURE(decode, size);
+            SCHROTT_ID_COUNT_IDS(size, 1);
+
+            byte buf[kMaxDigits];
+            auto e = error::none;
+
+            if (size < static_cast<std::size_t>(min_length_) || size > kMaxDigits)
+            {
+                e = error::invalid_length;
+            }
+            else if (!from_chars(data, size, buf))
+            {
+                e = error::invalid_character;
+            }
+            else
+            {
+                ff1(buf, size, 1, true);
+
+                if (!to_value(buf, size, value))
+                {
+                    e = error::range_overflow;
+                }
+            }
+
+            SCHROTT_ID_COUNT_ERROR(e);
+
+            return e;
+        }
+
+        /**
+         * Encodes a batch of values into a caller-owned character buffer
+         * @see schrott_id_encoder::encode_batch
+         */
+        error encode_batch(
+                const std::uint64_t* values,
+                std::size_t count,
+                char* out,
+                std::size_t out_size,
+                std::size_t* offsets) const
+        {
+            SCHROTT_ID_MEASURE(encode_batch, count);
+
+            std::size_t pos = 0;
+            offsets[0] = 0;
+
+            for (std::size_t i = 0; i < count;)
+            {
+                // Collect up to kLanes IDs with the same length and encrypt them in lockstep
+                auto len = encoded_length(values[i]);
+                auto buf = reinterpret_cast<byte*>(out + pos);
+                std::size_t run = 0;
+
+                while (i + run < count
+                       && run < kLanes
+                       && encoded_length(values[i + run]) == len)
+                {
+                    if (out_size - pos < len)
+                    {
+                        SCHROTT_ID_COUNT_ERROR(error::buffer_too_small);
+                        return error::buffer_too_small;
+                    }
+
+                    to_digits(values[i + run], buf + run * len, len);
+                    pos += len;
+                    offsets[i + run + 1] = pos;
+                    ++run;
+                }
+
+                SCHROTT_ID_COUNT_IDS(len, run);
+
+                ff1(buf, len, run, false);
+                to_chars(buf, run * len);
+
+                i += run;
+            }
+
+            return error::none;
+        }
+
+        /**
+         * Decodes a batch of SchrottIDs stored back to back in a character buffer
+         * @see schrott_id_encoder::decode_batch
+         */
+        std::size_t decode_batch(
+                const char* chars,
+                const std::size_t* offsets,
+                std::size_t count,
+                std::uint64_t* values,
+                error* errors) const
+        {
+            SCHROTT_ID_MEASURE(decode_batch, count);
+
+            std::size_t failed = 0;
+            byte bufs[kMaxDigits * kLanes];
+            std::size_t indices[kLanes];
+
+            for (std::size_t i = 0; i < count;)
+            {
+                auto len = offsets[i + 1] - offsets[i];
+                std::size_t n = 0;
+
+                for (; i < count && n < kLanes && offsets[i + 1] - offsets[i] == len; ++i)
+                {
+                    SCHROTT_ID_COUNT_IDS(len, 1);
+
+                    auto e = error::none;
+
+                    if (len < static_cast<std::size_t>(min_length_) || len > kMaxDigits)
+                    {
+                        e = error::invalid_length;
+                    }
+                    else if (!from_chars(chars + offsets[i], len, bufs + n * len))
+                    {
+                        e = error::invalid_character;
+                    }
+                    else
+                    {
+                        indices[n++] = i;
+                    }
+
+                    if (e != error::none)
+                    {
+                        SCHROTT_ID_COUNT_ERROR(e);
+
+                        values[i] = 0;
+                        ++failed;
+
+                        if (errors)
+                        {
+                            errors[i] = e;
+                        }
+                    }
+                }
+
+                if (n > 0)
+                {
+                    ff1(bufs, len, n, true);
+                }
+
+                for (std::size_t j = 0; j < n; ++j)
+                {
+                    auto fits = to_value(bufs + j * len, len, values[indices[j]]);
+
+                    if (!fits)
+                    {
+                        SCHROTT_ID_COUNT_ERROR(error::range_overflow);
+
+                        values[indices[j]] = 0;
+                        ++failed;
+                    }
+
+                    if (errors)
+                    {
+                        errors[indices[j]] = fits ? error::none : error::range_overflow;
+                    }
+                }
+            }
+
+            return failed;
+        }
+
+        /**
+         * Encrypts a numeral string with FF1, without any conversion from or to values.
+         * Digits are the positions of the characters in the alphabet, like in the NIST examples.
+         * @param numerals Characters of the alphabet, at least @see min_length and at most 128
+         * @return The encrypted numeral string
+         * @throws std::invalid_argument The length is not supported.
+         * @throws std::out_of_range A character is not in the alphabet.
+         */
+        std::string encrypt(const std::string& numerals) const
+        {
+            return crypt(numerals, false);
+        }
+
+        /**
+         * Decrypts a numeral string encrypted with @see encrypt.
+         */
+        std::string decrypt(const std::string& numerals) const
+        {
+            return crypt(numerals, true);
+        }
+
+    private:
+
+        std::string crypt(const std::string& numerals, bool decrypting) const
+        {
+            // The NIST minimum only depends on the alphabet, the minimum length may be higher
+            auto ff1_min = 2;
+            for (std::uint64_t domain = alphabet_.size() * alphabet_.size(); domain < 1000000; domain *= alphabet_.size())
+            {
+                ++ff1_min;
+            }
+
+            if (numerals.size() < static_cast<std::size_t>(ff1_min) || numerals.size() > kMaxDigits)
+            {
+                SCHROTT_ID_THROW(std::invalid_argument, "Numeral string length not supported");
+            }
+
+            std::string s = numerals;
+            auto buf = reinterpret_cast<byte*>(&s[0]);
+
+            if (!from_chars(numerals.data(), numerals.size(), buf))
+            {
+                SCHROTT_ID_THROW(std::out_of_range, "Character not in alphabet");
+            }
+
+            ff1(buf, s.size(), 1, decrypting);
+            to_chars(buf, s.size());
+
+            return s;
+        }
+
+        void build_lengths()
+        {
+            const auto radix = static_cast<std::uint32_t>(alphabet_.size());
+            const auto t = tweak_.size();
+
+            lengths_.resize(kMaxDigits + 1);
+
+            for (std::size_t n = 2; n <= kMaxDigits; ++n)
+            {
+                auto& l = lengths_[n];
+                auto u = n / 2;
+                auto v = n - u;
+
+                // b = ceil(ceil(v * log2(radix)) / 8), where ceil(v * log2(radix)) is the bit length of radix^v - 1
+                std::uint64_t power[kWords] = {1};
+                for (std::size_t i = 0; i < v; ++i)
+                {
+                    detail::mul_add(power, kWords, radix, 0);
+                }
+
+                for (auto& word: power)
+                {
+                    if (word-- != 0)
+                    {
+                        break;
+                    }
+                }
+
+                std::size_t bits = 0;
+                for (std::size_t w = kWords; w-- > 0 && bits == 0;)
+                {
+                    for (auto x = power[w]; x; x >>= 1)
+                    {
+                        ++bits;
+                    }
+
+                    if (bits)
+                    {
+                        bits += 64 * w;
+                    }
+                }
+
+                l.b = (bits + 7) / 8;
+                l.d = 4 * ((l.b + 3) / 4) + 4;
+
+                byte p[16] = {1, 2, 1,
+                              static_cast<byte>(radix >> 16), static_cast<byte>(radix >> 8), static_cast<byte>(radix),
+                              10, static_cast<byte>(u),
+                              static_cast<byte>(n >> 24), static_cast<byte>(n >> 16),
+                              static_cast<byte>(n >> 8), static_cast<byte>(n),
+                              static_cast<byte>(t >> 24), static_cast<byte>(t >> 16),
+                              static_cast<byte>(t >> 8), static_cast<byte>(t)};
+
+                cipher_.encrypt(p, 1);
+                std::memcpy(l.p, p, 16);
+            }
+        }
+
+        // Runs FF1 on count numeral strings of n digits stored back to back, all in lockstep.
+        // Each string is kept as A || B. Encrypting, A has m digits and becomes B || (A + y);
+        // decrypting, B has m digits and becomes (B - y) || A.
+        void ff1(byte* digits, std::size_t n, std::size_t count, bool decrypting) const
+        {
+            const auto& l = lengths_[n];
+            const auto u = n / 2;
+            const auto v = n - u;
+            const auto q_size = (tweak_.size() + 1 + l.b + 15) / 16 * 16;
+            const auto s_blocks = (l.d + 15) / 16;
+
+            byte q[kLanes * kMaxQ];
+            byte y[kLanes * 16];
+            byte s[kLanes * kMaxSBlocks * 16];
+
+            // Tweak and padding are the same for every round
+            for (std::size_t lane = 0; lane < count; ++lane)
+            {
+                auto lane_q = q + lane * q_size;
+                std::memcpy(lane_q, tweak_.data(), tweak_.size());
+                std::memset(lane_q + tweak_.size(), 0, q_size - tweak_.size());
+            }
+
+            for (std::size_t round = 0; round < kRounds; ++round)
+            {
+                const auto i = decrypting ? kRounds - 1 - round : round;
+                const auto m = i % 2 == 0 ? u : v;
+
+                for (std::size_t lane = 0; lane < count; ++lane)
+                {
+                    auto x = digits + lane * n;
+                    auto lane_q = q + lane * q_size;
+
+                    lane_q[q_size - l.b - 1] = static_cast<byte>(i);
+                    num_to_bytes(decrypting ? x : x + m, n - m, lane_q + q_size - l.b, l.b);
+
+                    std::memcpy(y + lane * 16, l.p, 16);
+                }
+
+                // CBC-MAC over Q, one block of every lane at a time
+                for (std::size_t block = 0; block < q_size / 16; ++block)
+                {
+                    for (std::size_t lane = 0; lane < count; ++lane)
+                    {
+                        for (std::size_t j = 0; j < 16; ++j)
+                        {
+                            y[lane * 16 + j] ^= q[lane * q_size + block * 16 + j];
+                        }
+                    }
+
+                    cipher_.encrypt(y, count);
+                }
+
+                // S = R || CIPH(R xor [1]) || CIPH(R xor [2]) || ...
+                for (std::size_t lane = 0; lane < count; ++lane)
+                {
+                    for (std::size_t block = 0; block < s_blocks; ++block)
+                    {
+                        auto out = s + (lane * kMaxSBlocks + block) * 16;
+                        std::memcpy(out, y + lane * 16, 16);
+                        out[15] ^= static_cast<byte>(block);
+                    }
+                }
+
+                if (s_blocks > 1)
+                {
+                    for (std::size_t lane = 0; lane < count; ++lane)
+                    {
+                        cipher_.encrypt(s + (lane * kMaxSBlocks + 1) * 16, s_blocks - 1);
+                    }
+                }
+
+                for (std::size_t lane = 0; lane < count; ++lane)
+                {
+                    auto x = digits + lane * n;
+                    byte c[kMaxDigits / 2 + 1];
+
+                    bytes_to_digits(s + lane * kMaxSBlocks * 16, l.d, c, m);
+
+                    if (decrypting)
+                    {
+                        subtract(x + n - m, c, m);
+                        std::memmove(x + m, x, n - m);
+                    }
+                    else
+                    {
+                        add(x, c, m);
+                        std::memmove(x, x + m, n - m);
+                    }
+
+                    std::memcpy(decrypting ? x : x + n - m, c, m);
+                }
+            }
+        }
+
+        // Writes NUM_radix(digits) as size big-endian bytes
+        void num_to_bytes(const byte* digits, std::size_t len, byte* out, std::size_t size) const
+        {
+            std::uint64_t words[kWords] = {};
+
+            for (std::size_t i = 0; i < len; ++i)
+            {
+                detail::mul_add(words, kWords, static_cast<std::uint32_t>(alphabet_.size()), digits[i]);
+            }
+
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                out[size - 1 - i] = static_cast<byte>(words[i / 8] >> (8 * (i % 8)));
+            }
+        }
+
+        // Writes NUM(bytes) mod radix^m as m digits
+        void bytes_to_digits(const byte* bytes, std::size_t size, byte* digits, std::size_t m) const
+        {
+            std::uint64_t words[kWords] = {};
+
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                words[i / 8] |= static_cast<std::uint64_t>(bytes[size - 1 - i]) << (8 * (i % 8));
+            }
+
+            for (std::size_t i = m; i-- > 0;)
+            {
+                digits[i] = static_cast<byte>(
+                        detail::div_rem(words, (size + 7) / 8, static_cast<std::uint32_t>(alphabet_.size())));
+            }
+        }
+
+        // c = (a + c) mod radix^m, digits most significant first
+        void add(const byte* a, byte* c, std::size_t m) const
+        {
+            unsigned carry = 0;
+
+            for (std::size_t i = m; i-- > 0;)
+            {
+                auto sum = a[i] + c[i] + carry;
+                carry = sum >= alphabet_.size();
+                c[i] = static_cast<byte>(carry ? sum - alphabet_.size() : sum);
+            }
+        }
+
+        // c = (b - c) mod radix^m
+        void subtract(const byte* b, byte* c, std::size_t m) const
+        {
+            unsigned borrow = 0;
+
+            for (std::size_t i = m; i-- > 0;)
+            {
+                auto subtrahend = c[i] + borrow;
+                borrow = b[i] < subtrahend;
+                c[i] = static_cast<byte>(borrow ? b[i] + alphabet_.size() - subtrahend : b[i] - subtrahend);
+            }
+        }
+
+        void to_digits(std::uint64_t value, byte* buf, std::size_t len) const
+        {
+            for (std::size_t i = len; i-- > 0;)
+            {
+                buf[i] = static_cast<byte>(value % alphabet_.size());
+                value /= alphabet_.size();
+            }
+        }
+
+        bool to_value(const byte* buf, std::size_t len, std::uint64_t& value) const
+        {
+            std::uint64_t result = 0;
+
+            for (std::size_t i = 0; i < len; ++i)
+            {
+                if (result > (UINT64_MAX - buf[i]) / alphabet_.size())
+                {
+                    return false;
+                }
+
+                result = result * alphabet_.size() + buf[i];
+            }
+
+            value = result;
+            return true;
+        }
+
+        void to_chars(byte* buf, std::size_t len) const
+        {
+            for (std::size_t i = 0; i < len; ++i)
+            {
+                buf[i] = static_cast<byte>(alphabet_[buf[i]]);
+            }
+        }
+
+        bool from_chars(const char* data, std::size_t len, byte* buf) const
+        {
+            for (std::size_t i = 0; i < len; ++i)
+            {
+                auto digit = inverse_alphabet_[static_cast<byte>(data[i])];
+
+                if (digit < 0)
+                {
+                    return false;
+                }
+
+                buf[i] = static_cast<byte>(digit);
+            }
+
+            return true;
+        }
+    };
+}
+
+#endif // SCHROTT_ID_FF1_HPP
@@ -0,0 +1,256 @@
+/**
+ * Unique ID generator that emits SchrottIDs
+ *
+ * https://github.com/lorisleitner/schrott-id
+ */
+
+#ifndef SCHROTT_ID_GENERATOR_HPP
+#define SCHROTT_ID_GENERATOR_HPP
+
+#include <atomic>
+#include <chrono>
+
+#include "schrott_id.hpp"
+
+namespace schrott_id
+{
+    /**
+     * Bit layout of generated IDs: time, then node, then sequence, from most to least significant bits.
+     */
+    struct generator_layout
+    {
+        unsigned time_bits = 41;
+        unsigned node_bits = 10;
+        unsigned sequence_bits = 12;
+
+        // Milliseconds since the Unix epoch that time 0 stands for
+        std::uint64_t epoch_ms = 1577836800000; // 2020-01-01
+
+        // Sequence numbers a worker claims at once, at most 2^sequence_bits
+        std::uint32_t block_size = 64;
+    };
+
+    /**
+     * A generated ID together with its SchrottID
+     */
+    struct generated_id
+    {
+        std::uint64_t value;
+        std::string id;
+    };
+
+    /**
+     * Generates unique 64-bit IDs from time, node and sequence, and encodes them to SchrottIDs.
+     *
+     * Each thread generates through its own @see id_generator::worker. Workers claim blocks of
+     * sequence numbers from the generator and hand them out locally, so the shared state is only
+     * touched once per block. A block keeps the millisecond it was claimed in. When all sequence
+     * numbers of the current millisecond are taken, claims move on to the next millisecond instead
+     * of waiting, so bursts above the layout's capacity run slightly ahead of the clock.
+     *
+     * The generator must outlive its workers. IDs are unique per generator as long as no two
+     * generators share a node number.
+     */
+    class id_generator
+    {
+    public:
+        using clock_function = std::uint64_t (*)();
+
+        /**
+         * Generates IDs on one thread. Not safe for concurrent use, create one per thread.
+         */
+        class worker
+        {
+        private:
+            id_generator* generator_;
+            std::uint64_t time_ = 0;
+            std::uint32_t next_ = 0;
+            std::uint32_t end_ = 0;
+
+        public:
+            explicit worker(id_generator& generator)
+                    : generator_(&generator)
+            {
+            }
+
+            /**
+             * Returns the next unique ID.
+             * @throws std::overflow_error The time no longer fits into the layout's time bits.
+             */
+            std::uint64_t next()
+            {
+                if (next_ == end_)
+                {
+                    generator_->claim(time_, next_, end_);
+                }
+
+                return generator_->compose(time_, next_++);
+            }
+
+            /**
+             * Returns the next unique ID and writes its SchrottID into a caller-owned buffer.
+             * @param out Output buffer, @see schrott_id_encoder::max_encoded_length characters are always enough
+             * @param out_size Size of the output buffer
+             * @param value Receives the generated ID
+             * @return Number of characters written, 0 if the buffer is too small. The ID is consumed either way.
+             */
+            std::size_t next_encoded(char* out, std::size_t out_size, std::uint64_t& value)
+            {
+                value = next();
+                return generator_->encoder_.encode_to(value, out, out_size);
+            }
+
+            /**
+             * Returns the next unique ID together with its SchrottID.
+             */
+            generated_id next_encoded()
+            {
+                auto value = next();
+                return generated_id{value, generator_->encoder_.encode(value)};
+            }
+        };
+
+    private:
+        schrott_id_encoder encoder_;
+        generator_layout layout_;
+        std::uint64_t node_;
+        clock_function clock_;
+
+        // Kept on its own cache line, it is the only state shared between workers
+        char padding_before_[64];
+        std::atomic<std::uint64_t> claimed_;
+        char padding_after_[64];
+
+    public:
+
+        /**
+         * Creates a new generator.
+         * @param encoder Encoder for the generated IDs
+         * @param layout Bit layout of the generated IDs
+         * @param node Number of this node, taken from local configuration
+         * @param clock Returns milliseconds since the Unix epoch, the system clock if null
+         * @throws std::invalid_argument The layout is invalid or the node does not fit into its bits.
+         */
+        id_generator(
+                schrott_id_encoder encoder,
+                generator_layout layout,
+                std::uint64_t node,
+                clock_function clock = nullptr)
+                : encoder_(std::move(encoder)),
+                  layout_(layout),
+                  node_(node),
+                  clock_(clock ? clock : &system_clock_ms),
+                  claimed_(0)
+        {
+            if (layout_.time_bits == 0
+                || layout_.sequence_bits == 0
+                || layout_.sequence_bits > 31
+                || layout_.time_bits + layout_.node_bits + layout_.sequence_bits > 64)
+            {
+                SCHROTT_ID_THROW(std::invalid_argument,
+                                 "Layout must have time and sequence bits and at most 64 bits in total");
+            }
+
+            if (layout_.node_bits < 64 && node_ >> layout_.node_bits)
+            {
+                SCHROTT_ID_THROW(std::invalid_argument, "Node does not fit into the layout's node bits");
+            }
+
+            if (layout_.block_size == 0
+                || layout_.block_size > (std::uint32_t{1} << layout_.sequence_bits))
+            {
+                SCHROTT_ID_THROW(std::invalid_argument, "Block size must be between 1 and 2^sequence_bits");
+            }
+        }
+
+        const schrott_id_encoder& encoder() const
+        {
+            return encoder_;
+        }
+
+        const generator_layout& layout() const
+        {
+            return layout_;
+        }
+
+        /**
+         * Splits a generated ID into milliseconds since the Unix epoch, node and sequence number.
+         */
+        void split(std::uint64_t id, std::uint64_t& time_ms, std::uint64_t& node, std::uint64_t& sequence) const
+        {
+            sequence = id & mask(layout_.sequence_bits);
+            node = (id >> layout_.sequence_bits) & mask(layout_.node_bits);
+            time_ms = (id >> (layout_.sequence_bits + layout_.node_bits)) + layout_.epoch_ms;
+        }
+
+    private:
+
+        static std::uint64_t system_clock_ms()
+        {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+
+        static std::uint64_t mask(unsigned bits)
+        {
+            return bits < 64 ? (std::uint64_t{1} << bits) - 1 : ~std::uint64_t{0};
+        }
+
+        std::uint64_t now() const
+        {
+            auto ms = clock_();
+            return ms > layout_.epoch_ms ? ms - layout_.epoch_ms : 0;
+        }
+
+        // claimed_ holds the millisecond of the last claim above the sequence number it continues at
+        void claim(std::uint64_t& time, std::uint32_t& next, std::uint32_t& end)
+        {
+            const auto sequences = std::uint64_t{1} << layout_.sequence_bits;
+            auto current = now();
+            auto claimed = claimed_.load(std::memory_order_relaxed);
+            std::uint64_t desired;
+
+            do
+            {
+                time = claimed >> layout_.sequence_bits;
+                std::uint64_t first = claimed & (sequences - 1);
+
+                if (current > time)
+                {
+                    time = current;
+                    first = 0;
+                }
+                else if (first + layout_.block_size > sequences)
+                {
+                    ++time;
+                    first = 0;
+                }
+
+                next = static_cast<std::uint32_t>(first);
+                end = static_cast<std::uint32_t>(first + layout_.block_size);
+                desired = (time << layout_.sequence_bits) | (end & (sequences - 1));
+
+                if (end == sequences)
+                {
+                    // The millisecond is used up, the next claim starts a new one
+                    desired = (time + 1) << layout_.sequence_bits;
+                }
+            } while (!claimed_.compare_exchange_weak(claimed, desired, std::memory_order_relaxed));
+
+            if (layout_.time_bits < 64 && time >> layout_.time_bits)
+            {
+                end = next;
+                SCHROTT_ID_THROW(std::overflow_error, "Generator time exceeds the layout's time bits");
+            }
+        }
+
+        std::uint64_t compose(std::uint64_t time, std::uint32_t sequence) const
+        {
+            return (time << (layout_.node_bits + layout_.sequence_bits))
+                   | (node_ << layout_.sequence_bits)
+                   | sequence;
+        }
+    };
+}
+
+#endif // SCHROTT_ID_GENERATOR_HPP
@@ -0,0 +1,424 @@
+/**
+ * Streaming rewriter of SchrottIDs in JSON documents
+ *
+ * https://github.com/lorisleitner/schrott-id
+ */
+
+#ifndef SCHROTT_ID_JSON_HPP
+#define SCHROTT_ID_JSON_HPP
+
+#include <cstring>
+
+#include "schrott_id.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define SCHROTT_ID_JSON_SSE2 1
+#endif
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+
+namespace schrott_id
+{
+    namespace detail
+    {
+        inline unsigned lowest_bit(unsigned mask)
+        {
+#if defined(_MSC_VER) && !defined(__clang__)
+            unsigned long index;
+            _BitScanForward(&index, mask);
+            return static_cast<unsigned>(index);
+#else
+            return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+        }
+
+        /**
+         * Returns the first quote at or after p, or with escapes also the first backslash, end if there is none.
+         * Compares 16 bytes at a time with SSE2 where available.
+         */
+        inline const char* find_quote(const char* p, const char* end, bool escapes)
+        {
+#ifdef SCHROTT_ID_JSON_SSE2
+            const auto quote = _mm_set1_epi8('"');
+            const auto backslash = _mm_set1_epi8(escapes ? '\\' : '"');
+
+            for (; end - p >= 16; p += 16)
+            {
+                auto chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                auto hits = _mm_or_si128(_mm_cmpeq_epi8(chunk, quote), _mm_cmpeq_epi8(chunk, backslash));
+                auto mask = static_cast<unsigned>(_mm_movemask_epi8(hits));
+
+                if (mask)
+                {
+                    return p + lowest_bit(mask);
+                }
+            }
+#endif
+
+            for (; p < end; ++p)
+            {
+                if (*p == '"' || (escapes && *p == '\\'))
+                {
+                    return p;
+                }
+            }
+
+            return end;
+        }
+
+        /**
+         * Returns the closing quote of a string whose contents start at p, nullptr if it is not terminated.
+         */
+        inline const char* string_end(const char* p, const char* end)
+        {
+            for (;;)
+            {
+                p = find_quote(p, end, true);
+
+                if (p == end)
+                {
+                    return nullptr;
+                }
+
+                if (*p == '"')
+                {
+                    return p;
+                }
+
+                // Skip the backslash and the character it escapes
+                if (end - p < 2)
+                {
+                    return nullptr;
+                }
+
+                p += 2;
+            }
+        }
+
+        inline const char* skip_space(const char* p, const char* end)
+        {
+            while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t'))
+            {
+                ++p;
+            }
+
+            return p;
+        }
+    }
+
+    /**
+     * Rewrites integer IDs in JSON documents to SchrottIDs, for example in responses, or back, for example in requests.
+     *
+     * Fields are selected by key at any depth, by default "id" and every key ending in "_id".
+     * Encoding replaces non-negative integer values of selected fields with SchrottID strings,
+     * decoding replaces SchrottID strings of selected fields with integers. Values of other types,
+     * like null, negative or fractional numbers, and all other fields are copied unchanged.
+     *
+     * The document is scanned once without building a tree: strings are found with SIMD
+     * and everything between the rewritten values is copied in bulk.
+     * Rewriting does not validate the document beyond what it needs to find strings and values.
+     */
+    class json_rewriter
+    {
+    public:
+        enum class direction : std::uint8_t
+        {
+            encode = 0,
+            decode
+        };
+
+    private:
+        schrott_id_encoder encoder_;
+        direction direction_;
+        std::size_t max_length_;
+        std::vector<std::string> names_;
+        std::vector<std::string> suffixes_;
+
+    public:
+
+        /**
+         * Creates a new JSON rewriter.
+         * @param encoder The encoder of the IDs
+         * @param dir Whether to encode integers or decode SchrottIDs
+         * @param fields Keys of the fields to rewrite, a key starting with * selects every key ending in the rest
+         * @throws std::invalid_argument The alphabet has characters that must be escaped in JSON strings.
+         */
+        json_rewriter(const schrott_id_encoder& encoder, direction dir,
+                      const std::vector<std::string>& fields = {"id", "*_id"})
+                : encoder_(encoder),
+                  direction_(dir),
+                  max_length_(encoder.max_encoded_length())
+        {
+            for (auto c: encoder_.alphabet())
+            {
+                if (c == '"' || c == '\\' || static_cast<byte>(c) < 0x20)
+                {
+                    SCHROTT_ID_THROW(std::invalid_argument, "Alphabet must not have characters escaped in JSON");
+                }
+            }
+
+            for (auto& field: fields)
+            {
+                if (!field.empty() && field[0] == '*')
+                {
+                    suffixes_.push_back(field.substr(1));
+                }
+                else
+                {
+                    names_.push_back(field);
+                }
+            }
+        }
+
+        const schrott_id_encoder& encoder() const
+        {
+            return encoder_;
+        }
+
+        /**
+         * Tests whether a key, as it appears between its quotes, selects its field.
+         */
+        bool selects(const char* key, std::size_t size) const
+        {
+            for (auto& name: names_)
+            {
+                if (name.size() == size && std::memcmp(name.data(), key, size) == 0)
+                {
+                    return true;
+                }
+            }
+
+            for (auto& suffix: suffixes_)
+            {
+                if (suffix.size() <= size && std::memcmp(suffix.data(), key + size - suffix.size(), suffix.size()) == 0)
+                {
+                    return true;
+                }
+            }
+
+            return false;
+        }
+
+        /**
+         * Rewrites a JSON document.
+         * @param json The document
+         * @param size Size of the document
+         * @param out Receives the rewritten document, its capacity is kept across calls
+         * @return error::none, error::invalid_json for an unterminated string, error::range_overflow for an
+         * integer above 2^64 - 1 or the error of a SchrottID that failed to decode. out is incomplete on errors.
+         */
+        error rewrite(const char* json, std::size_t size, std::string& out) const
+        {
+            out.clear();
+
+            if (out.capacity() < size + size / 8)
+            {
+                out.reserve(size + size / 8);
+            }
+
+            const auto end = json + size;
+            auto copied = json;
+            auto p = json;
+
+            for (;;)
+            {
+                p = detail::find_quote(p, end, false);
+
+                if (p == end)
+                {
+                    break;
+                }
+
+                auto key = p + 1;
+                auto key_end = detail::string_end(key, end);
+
+                if (!key_end)
+                {
+                    return error::invalid_json;
+                }
+
+                p = detail::skip_space(key_end + 1, end);
+
+                // A string is a key if a colon follows it
+                if (p == end || *p != ':' || !selects(key, key_end - key))
+                {
+                    continue;
+                }
+
+                auto value = detail::skip_space(p + 1, end);
+                const char* value_end = nullptr;
+                auto e = direction_ == direction::encode
+                         ? encode_value(value, end, value_end, out, copied)
+                         : decode_value(value, end, value_end, out, copied);
+
+                if (e != error::none)
+                {
+                    return e;
+                }
+
+                p = value_end ? value_end : value;
+
+                if (value_end)
+                {
+                    copied = value_end;
+                }
+            }
+
+            out.append(copied, end);
+
+            return error::none;
+        }
+
+        error rewrite(const std::string& json, std::string& out) const
+        {
+            return rewrite(json.data(), json.size(), out);
+        }
+
+    private:
+
+        // Writes everything up to value and the SchrottID of an integer value, sets value_end behind the integer.
+        // Leaves value_end null for values that are not non-negative integers.
+        error encode_value(const char* value, const char* end, const char*& value_end, std::string& out,
+                           const char* copied) const
+        {
+            std::uint64_t n = 0;
+            auto p = value;
+
+            for (; p < end && *p >= '0' && *p <= '9'; ++p)
+            {
+                auto digit = static_cast<std::uint64_t>(*p - '0');
+
+                if (n > (UINT64_MAX - digit) / 10)
+                {
+                    return error::range_overflow;
+                }
+
+                n = n * 10 + digit;
+            }
+
+            if (p == value || (p < end && (*p == '.' || *p == 'e' || *p == 'E')))
+            {
+                return error::none;
+            }
+
+            out.append(copied, value);
+            out += '"';
+
+            auto pos = out.size();
+            out.resize(pos + max_length_);
+            out.resize(pos + encoder_.encode_to(n, &out[pos], max_length_));
+
+            out += '"';
+            value_end = p;
+
+            return error::none;
+        }
+
+        // Writes everything up to value and the integer of a SchrottID string, sets value_end behind the string.
+        // Leaves value_end null for values that are not strings.
+        error decode_value(const char* value, const char* end, const char*& value_end, std::string& out,
+                           const char* copied) const
+        {
+            if (value == end || *value != '"')
+            {
+                return error::none;
+            }
+
+            auto id = value + 1;
+            auto id_end = detail::string_end(id, end);
+
+            if (!id_end)
+            {
+                return error::invalid_json;
+            }
+
+            std::uint64_t n;
+            auto e = std::memchr(id, '\\', id_end - id)
+                     ? decode_escaped(id, id_end, n)
+                     : encoder_.try_decode(id, id_end - id, n);
+
+            if (e != error::none)
+            {
+                return e;
+            }
+
+            char digits[20];
+            auto length = 0;
+
+            do
+            {
+                digits[length++] = static_cast<char>('0' + n % 10);
+                n /= 10;
+            } while (n > 0);
+
+            out.append(copied, value);
+
+            while (length > 0)
+            {
+                out += digits[--length];
+            }
+
+            value_end = id_end + 1;
+
+            return error::none;
+        }
+
+        // JSON may escape any character of a SchrottID, like the slash of Base64 as \/ or \u002F.
+        // Alphabets are ASCII, so \u escapes of other characters and the escapes of control characters are invalid.
+        error decode_escaped(const char* id, const char* id_end, std::uint64_t& n) const
+        {
+            std::string unescaped;
+
+            for (auto p = id; p < id_end; ++p)
+            {
+                if (*p != '\\')
+                {
+                    unescaped += *p;
+                }
+                else if (*++p == '/' || *p == '"' || *p == '\\')
+                {
+                    unescaped += *p;
+                }
+                else if (*p == 'u' && id_end - p > 4)
+                {
+                    unsigned c = 0;
+
+                    for (auto i = 1; i <= 4; ++i)
+                    {
+                        auto h = p[i];
+                        auto digit = h >= '0' && h <= '9' ? h - '0'
+                                     : h >= 'a' && h <= 'f' ? h - 'a' + 10
+                                     : h >= 'A' && h <= 'F' ? h - 'A' + 10
+                                     : -1;
+
+                        if (digit < 0)
+                        {
+                            return error::invalid_json;
+                        }
+
+                        c = c << 4 | static_cast<unsigned>(digit);
+                    }
+
+                    if (c >= 0x80)
+                    {
+                        return error::invalid_character;
+                    }
+
+                    unescaped += static_cast<char>(c);
+                    p += 4;
+                }
+                else
+                {
+                    return error::invalid_character;
+                }
+            }
+
+            return encoder_.try_decode(unescaped.data(), unescaped.size(), n);
+        }
+    };
+}
+
+#endif // SCHROTT_ID_JSON_HPP
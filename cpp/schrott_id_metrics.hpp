@@ -0,0 +1,410 @@
+/**
+ * Optional instrumentation of SchrottID encoders
+ *
+ * Define SCHROTT_ID_METRICS before including schrott_id.hpp to count calls, ID lengths, errors and cache hits
+ * and to record latency histograms. Without it the hooks in the encoders expand to nothing.
+ *
+ * https://github.com/lorisleitner/schrott-id
+ */
+
+#ifndef SCHROTT_ID_METRICS_HPP
+#define SCHROTT_ID_METRICS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+
+namespace schrott_id
+{
+    namespace metrics
+    {
+        /**
+         * Instrumented entry points. Calls made from within another instrumented call,
+         * like the single-ID encodes of a batch, count towards the outer call only.
+         */
+        enum class operation : std::uint8_t
+        {
+            encode = 0,
+            decode,
+            encode_batch,
+            decode_batch
+        };
+
+        const std::size_t kOperations = 4;
+
+        // IDs of this length and longer share the last bucket of the length distribution
+        const std::size_t kLengths = 64;
+
+        // Slots for error codes, indexed by the value of schrott_id::error
+        const std::size_t kErrors = 16;
+
+        // Latency buckets: 4 linear steps per power of two of nanoseconds
+        const unsigned kSubBucketBits = 2;
+        const std::size_t kSubBuckets = std::size_t{1} << kSubBucketBits;
+        const std::size_t kBuckets = (64 - kSubBucketBits + 1) * kSubBuckets;
+
+        /**
+         * Returns the histogram bucket of a latency.
+         */
+        inline std::size_t bucket(std::uint64_t ns)
+        {
+            if (ns < kSubBuckets)
+            {
+                return static_cast<std::size_t>(ns);
+            }
+
+            unsigned exponent = 63;
+            while (!(ns >> exponent))
+            {
+                --exponent;
+            }
+
+            return (exponent - kSubBucketBits + 1) * kSubBuckets
+                   + static_cast<std::size_t>((ns >> (exponent - kSubBucketBits)) & (kSubBuckets - 1));
+        }
+
+        /**
+         * Returns the smallest latency in nanoseconds that falls into a bucket.
+         */
+        inline std::uint64_t bucket_lower_bound(std::size_t index)
+        {
+            if (index < kSubBuckets)
+            {
+                return index;
+            }
+
+            auto exponent = index / kSubBuckets + kSubBucketBits - 1;
+            return (kSubBuckets + index % kSubBuckets) << (exponent - kSubBucketBits);
+        }
+
+        /**
+         * Latency histogram of one operation, with about 25% relative precision.
+         */
+        struct histogram
+        {
+            std::uint64_t buckets[kBuckets];
+
+            std::uint64_t count() const
+            {
+                std::uint64_t total = 0;
+
+                for (auto n: buckets)
+                {
+                    total += n;
+                }
+
+                return total;
+            }
+
+            /**
+             * Returns the lower bound of the bucket that holds the q-quantile, 0 if the histogram is empty.
+             * @param q Quantile between 0 and 1, like 0.99
+             */
+            std::uint64_t percentile(double q) const
+            {
+                auto total = count();
+                auto rank = static_cast<std::uint64_t>(q * static_cast<double>(total));
+                std::uint64_t seen = 0;
+
+                if (rank >= total)
+                {
+                    rank = total - 1;
+                }
+
+                for (std::size_t i = 0; i < kBuckets; ++i)
+                {
+                    seen += buckets[i];
+
+                    if (seen > rank)
+                    {
+                        return bucket_lower_bound(i);
+                    }
+                }
+
+                return 0;
+            }
+        };
+
+        /**
+         * Counters of all threads merged by @see metrics::snapshot, cumulative since the process started.
+         */
+        struct snapshot_data
+        {
+            std::uint64_t calls[kOperations];
+
+            // IDs encoded or decoded, a batch call counts every ID
+            std::uint64_t ids[kOperations];
+
+            // Number of encoded and decoded IDs per length in characters
+            std::uint64_t encoded_lengths[kLengths];
+            std::uint64_t decoded_lengths[kLengths];
+
+            // Failures per schrott_id::error value
+            std::uint64_t errors[kErrors];
+
+            std::uint64_t cache_hits;
+            std::uint64_t cache_misses;
+
+            // Time per call in nanoseconds
+            histogram latency[kOperations];
+        };
+
+        namespace detail
+        {
+            // Counters of one thread. Only the owning thread writes them, with plain loads and
+            // stores instead of read-modify-write, and snapshots read them at any time.
+            struct shard
+            {
+                std::atomic<std::uint64_t> calls[kOperations];
+                std::atomic<std::uint64_t> ids[kOperations];
+                std::atomic<std::uint64_t> encoded_lengths[kLengths];
+                std::atomic<std::uint64_t> decoded_lengths[kLengths];
+                std::atomic<std::uint64_t> errors[kErrors];
+                std::atomic<std::uint64_t> cache_hits;
+                std::atomic<std::uint64_t> cache_misses;
+                std::atomic<std::uint64_t> latency[kOperations][kBuckets];
+
+                // Shards are never freed, a shard whose thread exited is taken over by the next new thread
+                std::atomic<bool> owned;
+                shard* next;
+
+                shard()
+                        : cache_hits(0),
+                          cache_misses(0),
+                          owned(true),
+                          next(nullptr)
+                {
+                    clear(calls);
+                    clear(ids);
+                    clear(encoded_lengths);
+                    clear(decoded_lengths);
+                    clear(errors);
+
+                    for (auto& op: latency)
+                    {
+                        clear(op);
+                    }
+                }
+
+                template<std::size_t N>
+                static void clear(std::atomic<std::uint64_t> (& counters)[N])
+                {
+                    for (auto& counter: counters)
+                    {
+                        counter.store(0, std::memory_order_relaxed);
+                    }
+                }
+            };
+
+            struct registry
+            {
+                std::mutex mutex;
+                std::atomic<shard*> head{nullptr};
+
+                static registry& instance()
+                {
+                    static registry r;
+                    return r;
+                }
+
+                shard* acquire()
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+
+                    for (auto s = head.load(std::memory_order_relaxed); s; s = s->next)
+                    {
+                        if (!s->owned.load(std::memory_order_relaxed))
+                        {
+                            s->owned.store(true, std::memory_order_relaxed);
+                            return s;
+                        }
+                    }
+
+                    auto s = new shard();
+                    s->next = head.load(std::memory_order_relaxed);
+                    head.store(s, std::memory_order_release);
+
+                    return s;
+                }
+
+                void release(shard* s)
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    s->owned.store(false, std::memory_order_relaxed);
+                }
+            };
+
+            struct thread_state
+            {
+                shard* counters;
+                unsigned depth = 0;
+                operation current = operation::encode;
+
+                thread_state()
+                        : counters(registry::instance().acquire())
+                {
+                }
+
+                ~thread_state()
+                {
+                    registry::instance().release(counters);
+                }
+            };
+
+            inline thread_state& state()
+            {
+                thread_local thread_state s;
+                return s;
+            }
+
+            inline void add(std::atomic<std::uint64_t>& counter, std::uint64_t n)
+            {
+                counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+            }
+
+            inline bool encodes(operation op)
+            {
+                return op == operation::encode || op == operation::encode_batch;
+            }
+        }
+
+        /**
+         * Counts one call and its latency when it is the outermost instrumented call of its thread.
+         */
+        class scope
+        {
+        private:
+            detail::thread_state& state_;
+            std::chrono::steady_clock::time_point start_;
+            bool outermost_;
+
+        public:
+            explicit scope(operation op)
+                    : state_(detail::state()),
+                      outermost_(state_.depth++ == 0)
+            {
+                if (outermost_)
+                {
+                    state_.current = op;
+                    start_ = std::chrono::steady_clock::now();
+                }
+            }
+
+            scope(const scope&) = delete;
+            scope& operator=(const scope&) = delete;
+
+            ~scope()
+            {
+                --state_.depth;
+
+                if (outermost_)
+                {
+                    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::steady_clock::now() - start_).count();
+                    auto op = static_cast<std::size_t>(state_.current);
+
+                    detail::add(state_.counters->calls[op], 1);
+                    detail::add(state_.counters->latency[op][bucket(static_cast<std::uint64_t>(ns))], 1);
+                }
+            }
+        };
+
+        /**
+         * Counts count IDs of a length for the outermost call of this thread.
+         */
+        inline void count_ids(std::size_t length, std::uint64_t count)
+        {
+            auto& s = detail::state();
+
+            if (s.depth != 1)
+            {
+                return;
+            }
+
+            auto bucket = length < kLengths ? length : kLengths - 1;
+            auto& lengths = detail::encodes(s.current) ? s.counters->encoded_lengths : s.counters->decoded_lengths;
+
+            detail::add(lengths[bucket], count);
+            detail::add(s.counters->ids[static_cast<std::size_t>(s.current)], count);
+        }
+
+        /**
+         * Counts a failure of the outermost call of this thread, e is a schrott_id::error.
+         */
+        template<class Error>
+        void count_error(Error e)
+        {
+            auto& s = detail::state();
+            auto index = static_cast<std::size_t>(e);
+
+            if (s.depth == 1 && index != 0 && index < kErrors)
+            {
+                detail::add(s.counters->errors[index], 1);
+            }
+        }
+
+        /**
+         * Counts a hit or miss of a schrott_id_cache.
+         */
+        inline void count_cache(bool hit)
+        {
+            auto& s = detail::state();
+            detail::add(hit ? s.counters->cache_hits : s.counters->cache_misses, 1);
+        }
+
+        /**
+         * Merges the counters of all threads, including exited ones.
+         *
+         * Reads the counters while other threads keep writing them, without locking, so
+         * counts of calls in flight may or may not be included.
+         */
+        inline snapshot_data snapshot()
+        {
+            snapshot_data data = {};
+
+            auto head = detail::registry::instance().head.load(std::memory_order_acquire);
+
+            for (auto s = head; s; s = s->next)
+            {
+                for (std::size_t op = 0; op < kOperations; ++op)
+                {
+                    data.calls[op] += s->calls[op].load(std::memory_order_relaxed);
+                    data.ids[op] += s->ids[op].load(std::memory_order_relaxed);
+
+                    for (std::size_t i = 0; i < kBuckets; ++i)
+                    {
+                        data.latency[op].buckets[i] += s->latency[op][i].load(std::memory_order_relaxed);
+                    }
+                }
+
+                for (std::size_t i = 0; i < kLengths; ++i)
+                {
+                    data.encoded_lengths[i] += s->encoded_lengths[i].load(std::memory_order_relaxed);
+                    data.decoded_lengths[i] += s->decoded_lengths[i].load(std::memory_order_relaxed);
+                }
+
+                for (std::size_t i = 0; i < kErrors; ++i)
+                {
+                    data.errors[i] += s->errors[i].load(std::memory_order_relaxed);
+                }
+
+                data.cache_hits += s->cache_hits.load(std::memory_order_relaxed);
+                data.cache_misses += s->cache_misses.load(std::memory_order_relaxed);
+            }
+
+            return data;
+        }
+    }
+}
+
+// Hooks of schrott_id.hpp, the histogram and snapshot types above can also be used on their own
+#ifdef SCHROTT_ID_METRICS
+#define SCHROTT_ID_METRICS_MEASURE(op) \
+    ::schrott_id::metrics::scope schrott_id_metrics_scope_(::schrott_id::metrics::operation::op)
+#define SCHROTT_ID_METRICS_COUNT_IDS(length, count) ::schrott_id::metrics::count_ids(length, count)
+#define SCHROTT_ID_METRICS_COUNT_ERROR(e) ::schrott_id::metrics::count_error(e)
+#define SCHROTT_ID_METRICS_COUNT_CACHE(hit) ::schrott_id::metrics::count_cache(hit)
+#endif
+
+#endif // SCHROTT_ID_METRICS_HPP
@@ -0,0 +1,255 @@
+/**
+ * Optional USDT probes in SchrottID encoders
+ *
+ * Define SCHROTT_ID_USDT before including schrott_id.hpp to place static tracepoints of the provider schrott_id
+ * into the encoders, for perf, bpftrace and SystemTap. A probe that no tracer is attached to is a single nop.
+ *
+ *   encode__entry(value), decode__entry(length), encode_batch__entry(count), decode_batch__entry(count)
+ *   encode__return(code, length, count), decode__return(...), encode_batch__return(...), decode_batch__return(...)
+ *                          When the call returns: code is the first schrott_id::error of the call or 0 if it
+ *                          succeeded, length the characters of all its IDs and count the number of its IDs
+ *   ids(length, count)     IDs of a length encoded or decoded by the current call
+ *   error(code)            The current call fails for an ID, code is a schrott_id::error
+ *
+ * Probes also fire for calls made within another call, like the single-ID encodes of some batches. IDs and
+ * errors count towards the innermost call, the same ones that the ids and error probes report for it.
+ *
+ * Every probe has a USDT semaphore, which tracers increment while they are attached to it. Probes and their
+ * arguments are skipped while it is 0, and calls only keep the record of their IDs and errors that the return
+ * probes report while a tracer is attached to one of those. Without a tracer a probe costs a load and a branch.
+ * Uses sys/sdt.h if it is installed and writes the same ELF notes itself otherwise.
+ *
+ * Example: bpftrace -e 'usdt:./app:schrott_id:decode__entry { @start[tid] = nsecs; }
+ *                       usdt:./app:schrott_id:decode__return { @ns[arg0] = hist(nsecs - @start[tid]); }'
+ *
+ * https://github.com/lorisleitner/schrott-id
+ */
+
+#ifndef SCHROTT_ID_PROBES_HPP
+#define SCHROTT_ID_PROBES_HPP
+
+#include <cstdint>
+
+#if defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#define SCHROTT_ID_SYS_SDT 1
+#endif
+#endif
+
+// Semaphore of a probe, the name sys/sdt.h expects
+#define SCHROTT_ID_SEMAPHORE(name) schrott_id_##name##_semaphore
+
+// Tracers find semaphores through the probe notes and increment them. Every binary has its own copies.
+#define SCHROTT_ID_DEFINE_SEMAPHORE(name) \
+    __attribute__((weak, visibility("hidden"), section(".probes"))) \
+    volatile unsigned short SCHROTT_ID_SEMAPHORE(name) = 0
+
+SCHROTT_ID_DEFINE_SEMAPHORE(encode__entry);
+SCHROTT_ID_DEFINE_SEMAPHORE(encode__return);
+SCHROTT_ID_DEFINE_SEMAPHORE(decode__entry);
+SCHROTT_ID_DEFINE_SEMAPHORE(decode__return);
+SCHROTT_ID_DEFINE_SEMAPHORE(encode_batch__entry);
+SCHROTT_ID_DEFINE_SEMAPHORE(encode_batch__return);
+SCHROTT_ID_DEFINE_SEMAPHORE(decode_batch__entry);
+SCHROTT_ID_DEFINE_SEMAPHORE(decode_batch__return);
+SCHROTT_ID_DEFINE_SEMAPHORE(ids);
+SCHROTT_ID_DEFINE_SEMAPHORE(error);
+
+#define SCHROTT_ID_PROBE_ENABLED(name) __builtin_expect(SCHROTT_ID_SEMAPHORE(name) != 0, 0)
+
+#if defined(SCHROTT_ID_SYS_SDT)
+
+#define _SDT_HAS_SEMAPHORES 1
+#include <sys/sdt.h>
+
+#define SCHROTT_ID_PROBE1(name, a) DTRACE_PROBE1(schrott_id, name, a)
+#define SCHROTT_ID_PROBE2(name, a, b) DTRACE_PROBE2(schrott_id, name, a, b)
+#define SCHROTT_ID_PROBE3(name, a, b, c) DTRACE_PROBE3(schrott_id, name, a, b, c)
+
+#elif defined(__ELF__) && (defined(__x86_64__) || defined(__aarch64__)) && (defined(__GNUC__) || defined(__clang__))
+
+// A probe is a nop whose address, together with the probe's name, argument locations and semaphore, is recorded
+// in a .note.stapsdt ELF note, in the format of SystemTap's sys/sdt.h version 3.
+// Arguments are 8-byte unsigned values, tracers read them from the registers or memory named in the note.
+#define SCHROTT_ID_SDT_STR(x) #x
+#define SCHROTT_ID_SDT_XSTR(x) SCHROTT_ID_SDT_STR(x)
+
+#define SCHROTT_ID_SDT_NOTE(name, args) \
+    "990: nop\n" \
+    ".pushsection .note.stapsdt,\"?\",\"note\"\n" \
+    ".balign 4\n" \
+    ".4byte 992f-991f, 994f-993f, 3\n" \
+    "991: .asciz \"stapsdt\"\n" \
+    "992: .balign 4\n" \
+    "993: .8byte 990b\n" \
+    ".8byte _.stapsdt.base\n" \
+    ".8byte " SCHROTT_ID_SDT_XSTR(SCHROTT_ID_SEMAPHORE(name)) "\n" \
+    ".asciz \"schrott_id\"\n" \
+    ".asciz \"" SCHROTT_ID_SDT_STR(name) "\"\n" \
+    ".asciz \"" args "\"\n" \
+    "994: .balign 4\n" \
+    ".popsection\n" \
+    ".ifndef _.stapsdt.base\n" \
+    ".pushsection .stapsdt.base,\"aG\",\"progbits\",.stapsdt.base,comdat\n" \
+    ".weak _.stapsdt.base\n" \
+    ".hidden _.stapsdt.base\n" \
+    "_.stapsdt.base: .space 1\n" \
+    ".size _.stapsdt.base, 1\n" \
+    ".popsection\n" \
+    ".endif\n"
+
+#define SCHROTT_ID_PROBE1(name, a) \
+    __asm__ __volatile__(SCHROTT_ID_SDT_NOTE(name, "8@%0") \
+                         :: "nor"(static_cast<std::uint64_t>(a)))
+#define SCHROTT_ID_PROBE2(name, a, b) \
+    __asm__ __volatile__(SCHROTT_ID_SDT_NOTE(name, "8@%0 8@%1") \
+                         :: "nor"(static_cast<std::uint64_t>(a)), "nor"(static_cast<std::uint64_t>(b)))
+#define SCHROTT_ID_PROBE3(name, a, b, c) \
+    __asm__ __volatile__(SCHROTT_ID_SDT_NOTE(name, "8@%0 8@%1 8@%2") \
+                         :: "nor"(static_cast<std::uint64_t>(a)), "nor"(static_cast<std::uint64_t>(b)), \
+                            "nor"(static_cast<std::uint64_t>(c)))
+
+#else
+#error "SCHROTT_ID_USDT needs sys/sdt.h on this platform"
+#endif
+
+namespace schrott_id
+{
+    namespace probes
+    {
+        class call;
+
+        /**
+         * Returns the innermost traced call of the thread, null outside of calls.
+         */
+        inline call*& current()
+        {
+            thread_local call* c = nullptr;
+            return c;
+        }
+
+        /**
+         * Returns true while a tracer is attached to a return probe, only then calls keep their record.
+         */
+        inline bool returns_traced()
+        {
+            return SCHROTT_ID_PROBE_ENABLED(encode__return) || SCHROTT_ID_PROBE_ENABLED(decode__return)
+                   || SCHROTT_ID_PROBE_ENABLED(encode_batch__return) || SCHROTT_ID_PROBE_ENABLED(decode_batch__return);
+        }
+
+        /**
+         * What a traced call has done so far, reported by its return probe.
+         * Calls of all operations keep one while any return probe is traced, so IDs and errors always
+         * count towards the innermost call.
+         */
+        class call
+        {
+        private:
+            call* parent_;
+            bool active_;
+
+        public:
+            std::uint64_t code = 0;
+            std::uint64_t length = 0;
+            std::uint64_t count = 0;
+
+            call()
+                    : parent_(nullptr),
+                      active_(returns_traced())
+            {
+                if (active_)
+                {
+                    parent_ = current();
+                    current() = this;
+                }
+            }
+
+            call(const call&) = delete;
+            call& operator=(const call&) = delete;
+
+            ~call()
+            {
+                if (active_)
+                {
+                    current() = parent_;
+                }
+            }
+
+            bool active() const
+            {
+                return active_;
+            }
+        };
+
+        inline void count_ids(std::uint64_t length, std::uint64_t count)
+        {
+            if (!returns_traced())
+            {
+                return;
+            }
+
+            if (auto c = current())
+            {
+                c->length += length * count;
+                c->count += count;
+            }
+        }
+
+        inline void count_error(int e)
+        {
+            if (!returns_traced())
+            {
+                return;
+            }
+
+            auto c = current();
+
+            if (c && c->code == 0)
+            {
+                c->code = static_cast<std::uint64_t>(e);
+            }
+        }
+    }
+}
+
+// Fires op__entry now and op__return when the enclosing block is left, on every return path
+#define SCHROTT_ID_PROBE_MEASURE(op, arg) \
+    if (SCHROTT_ID_PROBE_ENABLED(op##__entry)) \
+    { \
+        SCHROTT_ID_PROBE1(op##__entry, arg); \
+    } \
+    struct schrott_id_probe_return_ : ::schrott_id::probes::call \
+    { \
+        ~schrott_id_probe_return_() \
+        { \
+            if (active() && SCHROTT_ID_PROBE_ENABLED(op##__return)) \
+            { \
+                SCHROTT_ID_PROBE3(op##__return, code, length, count); \
+            } \
+        } \
+    } schrott_id_probe_return_scope_
+
+#define SCHROTT_ID_PROBE_IDS(length, count) \
+    do \
+    { \
+        ::schrott_id::probes::count_ids(length, count); \
+        if (SCHROTT_ID_PROBE_ENABLED(ids)) \
+        { \
+            SCHROTT_ID_PROBE2(ids, length, count); \
+        } \
+    } while (0)
+
+#define SCHROTT_ID_PROBE_ERROR(e) \
+    do \
+    { \
+        if (static_cast<int>(e) != 0) \
+        { \
+            ::schrott_id::probes::count_error(static_cast<int>(e)); \
+            if (SCHROTT_ID_PROBE_ENABLED(error)) \
+            { \
+                SCHROTT_ID_PROBE1(error, static_cast<int>(e)); \
+            } \
+        } \
+    } while (0)
+
+#endif // SCHROTT_ID_PROBES_HPP
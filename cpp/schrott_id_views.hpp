@@ -0,0 +1,421 @@
+/**
+ * Lazy C++20 range adaptors for encoding and decoding SchrottIDs
+ *
+ * https://github.com/lorisleitner/schrott-id
+ */
+
+#ifndef SCHROTT_ID_VIEWS_HPP
+#define SCHROTT_ID_VIEWS_HPP
+
+#include "schrott_id.hpp"
+
+#if __cplusplus >= 202002L && __has_include(<ranges>)
+
+#include <concepts>
+#include <ranges>
+#include <string_view>
+
+namespace schrott_id
+{
+    namespace detail
+    {
+        // Number of elements a view encodes or decodes at once when its base range is contiguous and sized
+        constexpr std::size_t kViewChunk = 64;
+
+        template<class R>
+        concept chunkable_range = std::ranges::contiguous_range<R> && std::ranges::sized_range<R>;
+    }
+
+    /**
+     * View that lazily encodes a range of integers to SchrottIDs.
+     *
+     * Elements are std::string_view into a buffer owned by the view and stay valid until the iterator
+     * is incremented. Contiguous, sized ranges are encoded in chunks with @see schrott_id_encoder::encode_batch,
+     * other ranges element by element. No memory is allocated per element.
+     * @tparam V Underlying view of unsigned integers
+     */
+    template<std::ranges::input_range V>
+    requires std::ranges::view<V> && std::unsigned_integral<std::ranges::range_value_t<V>>
+    class encode_view : public std::ranges::view_interface<encode_view<V>>
+    {
+    private:
+        static constexpr bool kChunked = detail::chunkable_range<V>;
+
+        V base_;
+        const schrott_id_encoder* encoder_;
+
+        std::ranges::iterator_t<V> current_;
+        std::vector<char> chars_;
+        std::vector<std::size_t> offsets_;
+        std::size_t index_ = 0;
+        std::size_t count_ = 0;
+
+        class iterator
+        {
+        private:
+            encode_view* parent_ = nullptr;
+
+        public:
+            using value_type = std::string_view;
+            using difference_type = std::ptrdiff_t;
+            using iterator_concept = std::input_iterator_tag;
+
+            iterator() = default;
+
+            explicit iterator(encode_view* parent)
+                    : parent_(parent)
+            {
+            }
+
+            std::string_view operator*() const
+            {
+                auto& p = *parent_;
+                return std::string_view(p.chars_.data() + p.offsets_[p.index_],
+                                        p.offsets_[p.index_ + 1] - p.offsets_[p.index_]);
+            }
+
+            iterator& operator++()
+            {
+                parent_->advance();
+                return *this;
+            }
+
+            void operator++(int)
+            {
+                ++*this;
+            }
+
+            friend bool operator==(const iterator& it, std::default_sentinel_t)
+            {
+                return it.at_end();
+            }
+
+        private:
+            bool at_end() const
+            {
+                return parent_->index_ == parent_->count_;
+            }
+        };
+
+        void fill()
+        {
+            index_ = 0;
+            count_ = 0;
+
+            if constexpr (kChunked)
+            {
+                auto end = std::ranges::end(base_);
+                count_ = std::min<std::size_t>(detail::kViewChunk, end - current_);
+
+                if (count_ > 0)
+                {
+                    if constexpr (std::same_as<std::ranges::range_value_t<V>, std::uint64_t>)
+                    {
+                        encoder_->encode_batch(std::to_address(current_), count_,
+                                               chars_.data(), chars_.size(), offsets_.data());
+                    }
+                    else
+                    {
+                        std::uint64_t values[detail::kViewChunk];
+                        std::copy(current_, current_ + count_, values);
+
+                        encoder_->encode_batch(values, count_, chars_.data(), chars_.size(), offsets_.data());
+                    }
+
+                    current_ += count_;
+                }
+            }
+            else
+            {
+                if (current_ != std::ranges::end(base_))
+                {
+                    offsets_[1] = encoder_->encode_to(*current_, chars_.data(), chars_.size());
+                    count_ = 1;
+                }
+            }
+        }
+
+        void advance()
+        {
+            if constexpr (!kChunked)
+            {
+                ++current_;
+            }
+
+            if (++index_ == count_)
+            {
+                fill();
+            }
+        }
+
+    public:
+        encode_view() = default;
+
+        encode_view(V base, const schrott_id_encoder& encoder)
+                : base_(std::move(base)),
+                  encoder_(&encoder)
+        {
+        }
+
+        V base() const& requires std::copy_constructible<V>
+        {
+            return base_;
+        }
+
+        iterator begin()
+        {
+            auto chunk = kChunked ? detail::kViewChunk : 1;
+
+            chars_.resize(chunk * encoder_->max_encoded_length());
+            offsets_.assign(chunk + 1, 0);
+            current_ = std::ranges::begin(base_);
+            fill();
+
+            return iterator(this);
+        }
+
+        std::default_sentinel_t end() const
+        {
+            return std::default_sentinel;
+        }
+
+        auto size() const requires std::ranges::sized_range<const V>
+        {
+            return std::ranges::size(base_);
+        }
+    };
+
+    template<class R>
+    encode_view(R&&, const schrott_id_encoder&) -> encode_view<std::views::all_t<R>>;
+
+    /**
+     * View that lazily decodes a range of SchrottIDs to integers.
+     *
+     * Elements must be convertible to std::string_view. Dereferencing an element that is not a valid
+     * SchrottID throws std::out_of_range, like @see schrott_id_encoder::decode.
+     * Contiguous, sized ranges are decoded in chunks with @see schrott_id_encoder::decode_batch,
+     * other ranges element by element.
+     * @tparam V Underlying view of strings
+     */
+    template<std::ranges::input_range V>
+    requires std::ranges::view<V> && std::convertible_to<std::ranges::range_reference_t<V>, std::string_view>
+    class decode_view : public std::ranges::view_interface<decode_view<V>>
+    {
+    private:
+        static constexpr bool kChunked = detail::chunkable_range<V>;
+
+        V base_;
+        const schrott_id_encoder* encoder_;
+
+        std::ranges::iterator_t<V> current_;
+        std::vector<char> chars_;
+        std::size_t offsets_[detail::kViewChunk + 1] = {};
+        std::uint64_t values_[detail::kViewChunk] = {};
+        error errors_[detail::kViewChunk] = {};
+        std::size_t index_ = 0;
+        std::size_t count_ = 0;
+
+        class iterator
+        {
+        private:
+            decode_view* parent_ = nullptr;
+
+        public:
+            using value_type = std::uint64_t;
+            using difference_type = std::ptrdiff_t;
+            using iterator_concept = std::input_iterator_tag;
+
+            iterator() = default;
+
+            explicit iterator(decode_view* parent)
+                    : parent_(parent)
+            {
+            }
+
+            std::uint64_t operator*() const
+            {
+                auto& p = *parent_;
+
+                if (p.errors_[p.index_] != error::none)
+                {
+                    SCHROTT_ID_THROW(std::out_of_range, error_message(p.errors_[p.index_]));
+                }
+
+                return p.values_[p.index_];
+            }
+
+            iterator& operator++()
+            {
+                parent_->advance();
+                return *this;
+            }
+
+            void operator++(int)
+            {
+                ++*this;
+            }
+
+            friend bool operator==(const iterator& it, std::default_sentinel_t)
+            {
+                return it.at_end();
+            }
+
+        private:
+            bool at_end() const
+            {
+                return parent_->index_ == parent_->count_;
+            }
+        };
+
+        void fill()
+        {
+            index_ = 0;
+            count_ = 0;
+
+            if constexpr (kChunked)
+            {
+                auto end = std::ranges::end(base_);
+
+                // Gather IDs into one buffer, growing it only when a chunk needs more room than before
+                std::size_t size = 0;
+
+                while (count_ < detail::kViewChunk && current_ != end)
+                {
+                    std::string_view id = *current_;
+
+                    if (chars_.size() < size + id.size())
+                    {
+                        chars_.resize(std::max(2 * chars_.size(), size + id.size()));
+                    }
+
+                    std::copy(id.begin(), id.end(), chars_.data() + size);
+                    size += id.size();
+                    offsets_[++count_] = size;
+                    ++current_;
+                }
+
+                encoder_->decode_batch(chars_.data(), offsets_, count_, values_, errors_);
+            }
+            else
+            {
+                if (current_ != std::ranges::end(base_))
+                {
+                    std::string_view id = *current_;
+                    errors_[0] = encoder_->try_decode(id.data(), id.size(), values_[0]);
+                    count_ = 1;
+                }
+            }
+        }
+
+        void advance()
+        {
+            if constexpr (!kChunked)
+            {
+                ++current_;
+            }
+
+            if (++index_ == count_)
+            {
+                fill();
+            }
+        }
+
+    public:
+        decode_view() = default;
+
+        decode_view(V base, const schrott_id_encoder& encoder)
+                : base_(std::move(base)),
+                  encoder_(&encoder)
+        {
+        }
+
+        V base() const& requires std::copy_constructible<V>
+        {
+            return base_;
+        }
+
+        iterator begin()
+        {
+            if constexpr (kChunked)
+            {
+                chars_.resize(detail::kViewChunk * encoder_->max_encoded_length());
+            }
+
+            current_ = std::ranges::begin(base_);
+            fill();
+
+            return iterator(this);
+        }
+
+        std::default_sentinel_t end() const
+        {
+            return std::default_sentinel;
+        }
+
+        auto size() const requires std::ranges::sized_range<const V>
+        {
+            return std::ranges::size(base_);
+        }
+    };
+
+    template<class R>
+    decode_view(R&&, const schrott_id_encoder&) -> decode_view<std::views::all_t<R>>;
+
+    namespace views
+    {
+        namespace detail
+        {
+            template<template<class> class View>
+            struct adaptor_closure
+            {
+                const schrott_id_encoder* encoder;
+
+                template<std::ranges::viewable_range R>
+                auto operator()(R&& r) const
+                {
+                    return View<std::views::all_t<R>>(std::views::all(std::forward<R>(r)), *encoder);
+                }
+
+                template<std::ranges::viewable_range R>
+                friend auto operator|(R&& r, const adaptor_closure& closure)
+                {
+                    return closure(std::forward<R>(r));
+                }
+            };
+        }
+
+        /**
+         * Range adaptor that encodes a range of integers: values | views::encode(encoder)
+         * @see encode_view
+         */
+        inline detail::adaptor_closure<encode_view> encode(const schrott_id_encoder& encoder)
+        {
+            return {&encoder};
+        }
+
+        template<std::ranges::viewable_range R>
+        auto encode(R&& r, const schrott_id_encoder& encoder)
+        {
+            return encode(encoder)(std::forward<R>(r));
+        }
+
+        /**
+         * Range adaptor that decodes a range of SchrottIDs: ids | views::decode(encoder)
+         * @see decode_view
+         */
+        inline detail::adaptor_closure<decode_view> decode(const schrott_id_encoder& encoder)
+        {
+            return {&encoder};
+        }
+
+        template<std::ranges::viewable_range R>
+        auto decode(R&& r, const schrott_id_encoder& encoder)
+        {
+            return decode(encoder)(std::forward<R>(r));
+        }
+    }
+}
+
+#endif
+
+#endif // SCHROTT_ID_VIEWS_HPP